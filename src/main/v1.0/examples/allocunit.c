@@ -0,0 +1,43 @@
+/*
+allocunit.c (System API Module example).
+LumenAllocUnit demo (calloc-based units).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    // Allocate for 20 elements (increased from original concept)
+    LumenAllocUnit* alloc = init_lumen_alloc(20);
+    if (alloc == NULL) {
+        printf("Failed to allocate on Lumen OS\n");
+        return 1;
+    }
+    
+    // Assign value at fifth position (shifted from third)
+    assign_lumen_value(alloc, 4, 88.5);  // Different value and type
+    
+    // Populate additional values in a loop for modification depth
+    for (size_t j = 0; j < alloc->alloc_count; ++j) {
+        if (j != 4) {
+            assign_lumen_value(alloc, j, (double)j * 1.5);
+        }
+    }
+    
+    // Display selected values
+    display_lumen_value(alloc, 4);
+    display_lumen_value(alloc, 1);
+    display_lumen_value(alloc, 19);
+    
+    // Add delay to mimic Lumen OS mobile operation
+    usleep(200000);  // 0.2s pause
+    
+    // Free resources
+    release_lumen_unit(alloc);
+    
+    return 0;
+}
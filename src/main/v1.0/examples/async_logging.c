@@ -0,0 +1,63 @@
+/*
+async_logging.c (System API Module example).
+Async logging demo: producer threads against the MPSC ring.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "systemapimod.h"
+
+#define LUMEN_ASYNC_DEMO_THREADS 4
+#define LUMEN_ASYNC_DEMO_LINES 20000
+
+static void* lumen_async_demo_producer(void* arg) {
+    LumenLogHandler* logger = create_lumen_logger(1);
+    long long* cost_ns = (long long*)arg;
+    struct timespec start, end;
+    
+    if (logger == NULL) {
+        return NULL;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < LUMEN_ASYNC_DEMO_LINES; i++) {
+        record_lumen_log(logger, "Sensor poll completed", 2);
+        output_lumen_log(logger);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    *cost_ns = (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+    release_lumen_logger(logger);
+    return NULL;
+}
+
+int main() {
+    pthread_t producers[LUMEN_ASYNC_DEMO_THREADS];
+    long long cost_ns[LUMEN_ASYNC_DEMO_THREADS] = {0};
+    FILE* sink = fopen("/dev/null", "w");
+    
+    if (lumen_async_log_start(8192, LUMEN_LOG_OVERFLOW_DROP, sink) != 0) {
+        printf("Async logger start failed on Lumen OS\n");
+        return 1;
+    }
+    
+    for (int i = 0; i < LUMEN_ASYNC_DEMO_THREADS; i++) {
+        pthread_create(&producers[i], NULL, lumen_async_demo_producer, &cost_ns[i]);
+    }
+    for (int i = 0; i < LUMEN_ASYNC_DEMO_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        printf("Producer %d: %.1f ns/record\n", i, (double)cost_ns[i] / LUMEN_ASYNC_DEMO_LINES);
+    }
+    
+    lumen_async_log_stop();
+    print_lumen_async_stats();
+    
+    if (sink) {
+        fclose(sink);
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+/*
+auth.c (System API Module example).
+Authenticated collection (Basic or Bearer).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    struct os api_data, backup_data;
+    struct recovery_ctx ctx;
+    struct auth_config auth;
+    struct curl_handle_pool pool;
+    
+    // BACKUP DATA
+    backup_data.apimodel = 1;
+    backup_data.system = 1;
+    strcpy(backup_data.osname, "Lumen");
+    
+    // AUTH SETUP - CHOOSE ONE:
+    init_auth_config(&auth, "apiuser", "apipass");           // Basic Auth
+    // set_bearer_token(&auth, "eyJ0eXAiOiJKV1QiLCJhbGciOiJIUzI1NiJ9...");  // Bearer Token
+    
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    
+    init_recovery_ctx(&ctx, &backup_data);
+    init_api_struct(&api_data, &backup_data);
+    if (init_handle_pool(&pool) == API_SUCCESS) {
+        ctx.pool = &pool;
+    }
+    
+    printf("🚀 Starting authenticated API collection...\n");
+    int status = collect_api_data_with_recovery(&api_data, "http://localhost:8080/api/system-info", 
+                                               &ctx, &auth);
+    
+    print_recovery_status(&api_data, status, &ctx);
+    print_pool_stats(ctx.pool);
+    destroy_handle_pool(ctx.pool);
+    curl_global_cleanup();
+    return (status == API_SUCCESS) ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+/*
+bench.h (System API Module examples).
+Timing helper shared by the bench_* programs.
+*/
+
+#ifndef SYSTEMAPIMOD_BENCH_H
+#define SYSTEMAPIMOD_BENCH_H
+
+#include <time.h>
+
+static inline double bench_elapsed_ns(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e9 + (now.tv_nsec - start->tv_nsec);
+}
+
+#endif  // SYSTEMAPIMOD_BENCH_H
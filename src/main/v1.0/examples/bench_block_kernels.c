@@ -0,0 +1,100 @@
+/*
+bench_block_kernels.c (System API Module example).
+Benchmark: LumenMemBlock range kernels per SIMD path.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "bench.h"
+
+// Benchmark: per-element accessors vs the range kernels on each available path
+int main() {
+    const size_t elements = 1 << 20;
+    const int iterations = 50;
+    struct timespec start;
+    size_t diff = 0;
+    LumenMemBlock* a = lumen_alloc_init(elements);
+    LumenMemBlock* b = lumen_alloc_init(elements);
+    
+    if (a == NULL || b == NULL) {
+        printf("Allocation failed on Lumen OS\n");
+        return 1;
+    }
+    
+    double mb = elements * sizeof(int) / 1e6;
+    printf("%zu elements (%.1f MB), %d iterations\n", elements, mb, iterations);
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < a->block_size; ++i) {
+            lumen_set_value(a, i, it);
+        }
+    }
+    double fill_loop_ns = bench_elapsed_ns(&start) / iterations;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < a->block_size; ++i) {
+            lumen_set_value(a, i, a->data_ptr[i] * 3 + 1);
+        }
+    }
+    double scale_loop_ns = bench_elapsed_ns(&start) / iterations;
+    
+    printf("per-element fill:         %8.0f us  %6.2f GB/s\n", fill_loop_ns / 1e3, mb / fill_loop_ns * 1e6);
+    printf("per-element scale/offset: %8.0f us  %6.2f GB/s\n", scale_loop_ns / 1e3, mb / scale_loop_ns * 1e6);
+    
+    const unsigned int masks[] = { 0, LUMEN_CPU_SSE2, LUMEN_CPU_SSE2 | LUMEN_CPU_AVX2, LUMEN_CPU_NEON };
+    unsigned int detected = lumen_cpu_features();
+    
+    for (int k = 0; k < 4; k++) {
+        if (masks[k] && (detected & masks[k]) != masks[k]) continue;  // Not on this CPU
+        lumen_cpu_restrict(masks[k]);
+        const char* name = lumen_block_kernel_name();
+        
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int it = 0; it < iterations; it++) {
+            lumen_fill_range(a, 0, elements, it);
+        }
+        double fill_ns = bench_elapsed_ns(&start) / iterations;
+        
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int it = 0; it < iterations; it++) {
+            lumen_scale_offset_range(a, 0, elements, 3, 1);
+        }
+        double scale_ns = bench_elapsed_ns(&start) / iterations;
+        
+        lumen_copy_range(b, 0, a, 0, elements);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int it = 0; it < iterations; it++) {
+            lumen_compare_range(a, 0, b, 0, elements, &diff);
+        }
+        double compare_ns = bench_elapsed_ns(&start) / iterations;
+        
+        printf("%-7s fill %6.2f GB/s (%.1fx) | scale/offset %6.2f GB/s (%.1fx) | compare %6.2f GB/s\n",
+               name, mb / fill_ns * 1e6, fill_loop_ns / fill_ns, mb / scale_ns * 1e6,
+               scale_loop_ns / scale_ns, 2 * mb / compare_ns * 1e6);
+    }
+    lumen_cpu_restrict(~0u);
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int it = 0; it < iterations; it++) {
+        lumen_copy_range(b, 0, a, 0, elements);
+    }
+    printf("copy    %6.2f GB/s\n", mb / bench_elapsed_ns(&start) * iterations * 1e6);
+    
+    // Cross-check the kernels against the scalar path
+    lumen_fill_range(a, 0, elements, 7);
+    lumen_scale_offset_range(a, 0, elements, -3, 5);
+    lumen_set_value(b, elements - 3, 0);
+    lumen_copy_range(b, 0, a, 0, elements - 5);
+    int status = lumen_compare_range(a, 0, b, 0, elements, &diff);
+    printf("compare: %d (first difference at %zu), a[0]=%d\n", status, diff, a->data_ptr[0]);
+    
+    lumen_free_block(a);
+    lumen_free_block(b);
+    return 0;
+}
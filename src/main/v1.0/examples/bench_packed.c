@@ -0,0 +1,74 @@
+/*
+bench_packed.c (System API Module example).
+Benchmark: packed vs two-allocation blocks.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "bench.h"
+
+// Benchmark: alloc/free churn of small blocks, two-calloc layout vs packed
+int main() {
+    const int rounds = 2000000;
+    const size_t elements = 8;
+    struct timespec start;
+    volatile int sink = 0;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++) {
+        LumenMemBlock* block = lumen_alloc_init(elements);
+        lumen_set_value(block, i % elements, i);
+        sink += block->data_ptr[i % elements];
+        lumen_free_block(block);
+    }
+    double block_ns = bench_elapsed_ns(&start) / rounds;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++) {
+        LumenPackedBlock* block = lumen_packed_alloc(elements);
+        lumen_packed_set_value(block, i % elements, i);
+        sink += block->data_ptr[i % elements];
+        lumen_packed_free(block);
+    }
+    double packed_ns = bench_elapsed_ns(&start) / rounds;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++) {
+        LumenAllocUnit* unit = init_lumen_alloc(elements);
+        assign_lumen_value(unit, i % elements, i);
+        sink += (int)unit->values[i % elements];
+        release_lumen_unit(unit);
+    }
+    double unit_ns = bench_elapsed_ns(&start) / rounds;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++) {
+        LumenPackedUnit* unit = init_lumen_packed_unit(elements);
+        assign_lumen_packed_value(unit, i % elements, i);
+        sink += (int)unit->values[i % elements];
+        release_lumen_packed_unit(unit);
+    }
+    double packed_unit_ns = bench_elapsed_ns(&start) / rounds;
+    
+    printf("%d x %zu elements\n", rounds, elements);
+    printf("LumenMemBlock     %6.1f ns/op (%zu+%zu bytes)\n", block_ns,
+           sizeof(LumenMemBlock), elements * sizeof(int));
+    printf("LumenPackedBlock  %6.1f ns/op (%zu+%zu bytes)  %.2fx\n", packed_ns,
+           sizeof(LumenPackedBlock), elements * sizeof(int), block_ns / packed_ns);
+    printf("LumenAllocUnit    %6.1f ns/op (%zu+%zu bytes)\n", unit_ns,
+           sizeof(LumenAllocUnit), elements * sizeof(double));
+    printf("LumenPackedUnit   %6.1f ns/op (%zu+%zu bytes)  %.2fx\n", packed_unit_ns,
+           sizeof(LumenPackedUnit), elements * sizeof(double), unit_ns / packed_unit_ns);
+    
+    LumenPackedBlock* block = lumen_packed_alloc(15);
+    lumen_packed_set_value(block, 3, 75);
+    lumen_packed_print_value(block, 3);
+    lumen_packed_free(block);
+    
+    lumen_telemetry_dump(stdout, LUMEN_TELEMETRY_TEXT);
+    return (sink == 42) ? 1 : 0;
+}
@@ -0,0 +1,78 @@
+/*
+bench_reduce.c (System API Module example).
+Benchmark: LumenAllocUnit reductions per SIMD path.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "bench.h"
+
+// Benchmark: naive loop vs the reduction kernels, plus an accuracy check
+int main() {
+    const size_t elements = 1 << 22;
+    const int iterations = 20;
+    struct timespec start;
+    LumenUnitStats stats;
+    LumenAllocUnit* unit = init_lumen_alloc(elements);
+    
+    if (unit == NULL) {
+        printf("Failed to allocate on Lumen OS\n");
+        return 1;
+    }
+    
+    // Large offset with small variation: hard for naive summation
+    for (size_t j = 0; j < unit->alloc_count; ++j) {
+        assign_lumen_value(unit, j, 1e9 + (double)(j % 1000) * 0.001);
+    }
+    
+    long double exact = 0.0L;
+    for (size_t j = 0; j < elements; j++) exact += (long double)unit->values[j];
+    
+    double naive_sum = 0.0, naive_var = 0.0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int it = 0; it < iterations; it++) {
+        double sum = 0.0, sq = 0.0;
+        for (size_t j = 0; j < elements; j++) {
+            sum += unit->values[j];
+            sq += unit->values[j] * unit->values[j];
+        }
+        naive_sum = sum;
+        naive_var = sq / elements - (sum / elements) * (sum / elements);
+    }
+    double naive_ns = bench_elapsed_ns(&start) / iterations;
+    double mb = elements * sizeof(double) / 1e6;
+    
+    printf("%zu doubles, %d iterations\n", elements, iterations);
+    printf("naive           %7.0f us  %6.2f GB/s  sum err %.3g  variance %.6g\n",
+           naive_ns / 1e3, mb / naive_ns * 1e6, (double)((long double)naive_sum - exact), naive_var);
+    
+    const unsigned int masks[] = { 0, LUMEN_CPU_SSE2, LUMEN_CPU_SSE2 | LUMEN_CPU_AVX2, LUMEN_CPU_NEON };
+    unsigned int detected = lumen_cpu_features();
+    
+    for (int k = 0; k < 4; k++) {
+        if (masks[k] && (detected & masks[k]) != masks[k]) continue;  // Not on this CPU
+        lumen_cpu_restrict(masks[k]);
+        
+        for (int threads = 1; threads <= 4; threads *= 4) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int it = 0; it < iterations; it++) {
+                lumen_unit_stats_range(unit, 0, elements, threads, &stats);
+            }
+            double ns = bench_elapsed_ns(&start) / iterations;
+            printf("%-7s x%d      %7.0f us  %6.2f GB/s  sum err %.3g  variance %.6g\n",
+                   lumen_reduce_kernel_name(), threads, ns / 1e3, mb / ns * 1e6,
+                   (double)((long double)stats.sum - exact), stats.variance);
+        }
+    }
+    lumen_cpu_restrict(~0u);
+    
+    lumen_unit_stats(unit, &stats);
+    printf("min %.3f max %.3f mean %.6f\n", stats.min, stats.max, stats.mean);
+    
+    release_lumen_unit(unit);
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+bench_scanner.c (System API Module example).
+Benchmark: SIMD key scanner vs cJSON.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <cjson/cJSON.h>
+
+#include "systemapimod.h"
+#include "bench.h"
+
+// Benchmark: scanner vs the cJSON_Parse + cJSON_GetObjectItem path on a large payload
+
+int main() {
+    const size_t target = 300 * 1024;
+    const int iterations = 200;
+    char *doc = malloc(target + 256);
+    size_t len = 0;
+    struct timespec start;
+    struct os fields;
+    unsigned int found = 0;
+    
+    if (!doc) return 1;
+    
+    // Bulky document with the wanted keys at the end (worst case for early exit)
+    len += sprintf(doc + len, "{\"modules\":[");
+    while (len < target) {
+        len += sprintf(doc + len, "{\"name\":\"lumen-core, rev [7]\",\"flags\":{\"a\":1,\"b\":[2,3]},\"build\":1234},");
+    }
+    len += sprintf(doc + len, "0],\"apimodel\":2,\"system\":42,\"osname\":\"Lumen\"}");
+    
+    printf("Payload: %zu bytes, %d iterations\n", len, iterations);
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        cJSON *json = cJSON_Parse(doc);
+        cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
+        cJSON *system_json = cJSON_GetObjectItem(json, "system");
+        cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
+        if (cJSON_IsNumber(apimodel_json)) fields.apimodel = apimodel_json->valueint;
+        if (cJSON_IsNumber(system_json)) fields.system = system_json->valueint;
+        if (cJSON_IsString(osname_json)) strncpy(fields.osname, osname_json->valuestring, sizeof(fields.osname) - 1);
+        cJSON_Delete(json);
+    }
+    double cjson_ns = bench_elapsed_ns(&start) / iterations;
+    printf("cJSON_Parse + GetObjectItem: %10.0f ns/op  %6.2f MB/s\n", cjson_ns, len * 1e3 / cjson_ns);
+    
+    const char *names[] = { "generic", "sse2", "avx2", "neon" };
+    const unsigned int masks[] = { 0, LUMEN_CPU_SSE2, LUMEN_CPU_SSE2 | LUMEN_CPU_AVX2, LUMEN_CPU_NEON };
+    unsigned int detected = lumen_cpu_features();
+    
+    for (int k = 0; k < 4; k++) {
+        if (masks[k] && (detected & masks[k]) != masks[k]) continue;  // Not on this CPU
+        lumen_cpu_restrict(masks[k]);
+        
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < iterations; i++) {
+            sysinfo_scan_buffer(doc, len, &fields, &found);
+        }
+        double scan_ns = bench_elapsed_ns(&start) / iterations;
+        printf("sysinfo_scan_buffer (%-7s): %10.0f ns/op  %6.2f MB/s  %.1fx\n",
+               names[k], scan_ns, len * 1e3 / scan_ns, cjson_ns / scan_ns);
+    }
+    lumen_cpu_restrict(~0u);
+    
+    printf("Fields: apimodel=%d system=%d osname=%s (found=0x%x)\n",
+           fields.apimodel, fields.system, fields.osname, found);
+    free(doc);
+    return 0;
+}
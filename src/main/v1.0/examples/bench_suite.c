@@ -0,0 +1,672 @@
+/*
+bench_suite.c (System API Module example).
+Microbenchmarks for every subsystem: allocation, logging, JSON field
+extraction, response buffers and the full collect cycle.
+
+  bench_suite [--json FILE] [--label TEXT] [--filter TEXT] [--samples N] [--url URL]
+
+Each case is timed in samples of `batch` operations, with the batch sized so
+one sample takes about BENCH_SAMPLE_NS. Percentiles are over the per-sample
+ns/op, so for slow cases (batch of 1) they are true per-operation
+percentiles. --json writes one result per line, which keeps diffs between
+runs on different commits readable. Without --url the collect cases run
+against an in-process mock server on a free loopback port.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cjson/cJSON.h>
+
+#include "systemapimod.h"
+#include "bench.h"
+
+#define BENCH_SAMPLE_NS 200000.0    // Target time per sample
+#define BENCH_MAX_BATCH (1 << 20)
+#define BENCH_DEFAULT_SAMPLES 30
+#define BENCH_MAX_SAMPLES 1000
+
+// ---- Allocation counting ----
+// On glibc every malloc-family call in the process (libcurl and cJSON
+// included) goes through these wrappers; the counters are per thread, so a
+// background writer does not show up in the benchmarking thread's numbers.
+// Elsewhere allocs/op falls back to the Lumen telemetry count.
+#if defined(__GLIBC__) && !defined(LUMEN_BENCH_NO_MALLOC_HOOK)
+#define BENCH_COUNTS_MALLOC 1
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void* ptr);
+
+static __thread unsigned long bench_alloc_calls;
+static __thread unsigned long bench_alloc_bytes;
+
+void* malloc(size_t size) {
+    bench_alloc_calls++;
+    bench_alloc_bytes += size;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    bench_alloc_calls++;
+    bench_alloc_bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    bench_alloc_calls++;
+    bench_alloc_bytes += size;
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    bench_alloc_calls++;
+    bench_alloc_bytes += size;
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    void* ptr;
+
+    bench_alloc_calls++;
+    bench_alloc_bytes += size;
+    ptr = __libc_memalign(alignment, size);
+    if (ptr == NULL) {
+        return 12;  // ENOMEM
+    }
+    *out = ptr;
+    return 0;
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+static void bench_alloc_counts(unsigned long* calls, unsigned long* bytes) {
+    *calls = bench_alloc_calls;
+    *bytes = bench_alloc_bytes;
+}
+#endif
+
+// Lumen allocations (all sites), whether or not they reached malloc
+static void bench_lumen_counts(unsigned long* calls, unsigned long* bytes) {
+    LumenTelemetrySnapshot snap;
+
+    *calls = 0;
+    *bytes = 0;
+    if (lumen_telemetry_snapshot(&snap) != 0) {
+        return;
+    }
+    for (int s = 0; s < LUMEN_SITE_COUNT; s++) {
+        *calls += snap.sites[s].allocs;
+        *bytes += snap.sites[s].bytes_allocated;
+    }
+}
+
+#ifndef BENCH_COUNTS_MALLOC
+static void bench_alloc_counts(unsigned long* calls, unsigned long* bytes) {
+    bench_lumen_counts(calls, bytes);
+}
+#endif
+
+// ---- Cases ----
+
+typedef struct {
+    const char* name;
+    int (*setup)(void);       // 0 = run, -1 = skip
+    void (*op)(void);
+    void (*teardown)(void);
+} BenchCase;
+
+typedef struct {
+    const char* name;
+    int skipped;
+    long batch;
+    int samples;
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double min_ns;
+    double max_ns;
+    double allocs_per_op;        // malloc family (process scope on glibc)
+    double bytes_per_op;
+    double lumen_allocs_per_op;  // Lumen telemetry sites
+} BenchResult;
+
+static const char* bench_url;  // NULL until --url or the mock server sets it
+static volatile int bench_sink;
+static int bench_counter;
+
+static const char bench_small_doc[] =
+    "{\"apimodel\":2,\"system\":42,\"osname\":\"Lumen\",\"uptime\":1234,\"flags\":[1,2,3]}";
+static char* bench_large_doc;
+static size_t bench_large_len;
+
+// Allocation paths
+
+static void op_lumen_alloc_init(void) {
+    LumenMemBlock* block = lumen_alloc_init(8);
+    lumen_set_value(block, 3, bench_counter++);
+    bench_sink += block->data_ptr[3];
+    lumen_free_block(block);
+}
+
+static void op_init_lumen_alloc(void) {
+    LumenAllocUnit* unit = init_lumen_alloc(8);
+    assign_lumen_value(unit, 3, 1.5);
+    bench_sink += (int)unit->values[3];
+    release_lumen_unit(unit);
+}
+
+static void op_setup_lumen_manager(void) {
+    LumenFreeManager* manager = setup_lumen_manager(256);
+    execute_lumen_free(manager);
+    bench_sink += manager->status_code;
+    destroy_lumen_manager(manager);
+}
+
+static void op_lumen_packed_alloc(void) {
+    LumenPackedBlock* block = lumen_packed_alloc(8);
+    lumen_packed_set_value(block, 3, bench_counter++);
+    bench_sink += block->data_ptr[3];
+    lumen_packed_free(block);
+}
+
+static void op_lumen_packed_unit(void) {
+    LumenPackedUnit* unit = init_lumen_packed_unit(8);
+    assign_lumen_packed_value(unit, 3, 1.5);
+    bench_sink += (int)unit->values[3];
+    release_lumen_packed_unit(unit);
+}
+
+static void op_slab_64(void) {
+    void* ptr = lumen_slab_alloc(64);
+    bench_sink += (ptr != NULL);
+    lumen_slab_free(ptr);
+}
+
+static void op_malloc_64(void) {
+    void* volatile ptr = malloc(64);
+    free(ptr);
+}
+
+// Response buffer fill, 16 x 1KB writes like WriteResponseCallback sees them
+
+static void op_response_buffer_16k(void) {
+    static char piece[1024];
+    struct response_buffer* buf = acquire_response_buffer();
+
+    for (int i = 0; i < 16; i++) {
+        if (response_buffer_reserve(buf, buf->size + sizeof(piece)) != 0) {
+            break;
+        }
+        memcpy(buf->data + buf->size, piece, sizeof(piece));
+        buf->size += sizeof(piece);
+        buf->data[buf->size] = '\0';
+    }
+    bench_sink += (int)buf->size;
+    release_response_buffer(buf);
+}
+
+// Logging
+
+static LumenLogHandler* bench_logger;
+static LumenBinLogger* bench_binlog;
+static int bench_binlog_format;
+static FILE* bench_devnull;
+static int bench_saved_stdout = -1;
+
+// output_lumen_log writes to stdout; point it at /dev/null while timing
+static int bench_mute_stdout(void) {
+    int fd = open("/dev/null", O_WRONLY);
+
+    if (fd < 0) {
+        return -1;
+    }
+    fflush(stdout);
+    bench_saved_stdout = dup(STDOUT_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+    return 0;
+}
+
+static void bench_restore_stdout(void) {
+    if (bench_saved_stdout >= 0) {
+        fflush(stdout);
+        dup2(bench_saved_stdout, STDOUT_FILENO);
+        close(bench_saved_stdout);
+        bench_saved_stdout = -1;
+    }
+}
+
+static int setup_logger(void) {
+    bench_logger = create_lumen_logger(2);
+    return (bench_logger != NULL) ? 0 : -1;
+}
+
+static void teardown_logger(void) {
+    release_lumen_logger(bench_logger);
+    bench_logger = NULL;
+}
+
+static int setup_logger_muted(void) {
+    if (setup_logger() != 0) {
+        return -1;
+    }
+    return bench_mute_stdout();
+}
+
+static void teardown_logger_muted(void) {
+    bench_restore_stdout();
+    teardown_logger();
+}
+
+static int setup_logger_micros(void) {
+    if (setup_logger() != 0) {
+        return -1;
+    }
+    bench_logger->time_precision = LUMEN_TS_MICROS;
+    return 0;
+}
+
+static void op_log_record(void) {
+    record_lumen_log(bench_logger, "Sensor poll completed", 2);
+    bench_sink += bench_logger->status_flag;
+}
+
+static void op_log_filtered(void) {
+    record_lumen_log(bench_logger, "Debug info: Memory check passed", 1);
+    bench_sink += bench_logger->status_flag;
+}
+
+static void op_log_record_output(void) {
+    record_lumen_log(bench_logger, "Sensor poll completed", 2);
+    output_lumen_log(bench_logger);
+}
+
+static int setup_async_log(void) {
+    bench_devnull = fopen("/dev/null", "w");
+    if (bench_devnull == NULL || setup_logger() != 0) {
+        return -1;
+    }
+    // Block on a full ring so the writer's cost is part of the steady state
+    return lumen_async_log_start(8192, LUMEN_LOG_OVERFLOW_BLOCK, bench_devnull);
+}
+
+static void teardown_async_log(void) {
+    lumen_async_log_stop();
+    teardown_logger();
+    fclose(bench_devnull);
+    bench_devnull = NULL;
+}
+
+static int setup_binlog(void) {
+    bench_binlog = create_lumen_binlog("/dev/null", 1);
+    if (bench_binlog == NULL) {
+        return -1;
+    }
+    bench_binlog_format = lumen_binlog_register(bench_binlog, "Boot stage %d finished in %.2f ms");
+    return (bench_binlog_format >= 0) ? 0 : -1;
+}
+
+static void teardown_binlog(void) {
+    release_lumen_binlog(bench_binlog);
+    bench_binlog = NULL;
+}
+
+static void op_binlog_write(void) {
+    lumen_binlog_write(bench_binlog, bench_binlog_format, 2, bench_counter++, 12.5);
+}
+
+// JSON field extraction
+
+static int setup_large_doc(void) {
+    const size_t target = 300 * 1024;
+
+    if (bench_large_doc != NULL) {
+        return 0;
+    }
+    bench_large_doc = malloc(target + 256);
+    if (bench_large_doc == NULL) {
+        return -1;
+    }
+    bench_large_len = sprintf(bench_large_doc, "{\"modules\":[");
+    while (bench_large_len < target) {
+        bench_large_len += sprintf(bench_large_doc + bench_large_len,
+                                   "{\"name\":\"lumen-core, rev [7]\",\"flags\":{\"a\":1,\"b\":[2,3]},\"build\":1234},");
+    }
+    bench_large_len += sprintf(bench_large_doc + bench_large_len,
+                               "0],\"apimodel\":2,\"system\":42,\"osname\":\"Lumen\"}");
+    return 0;
+}
+
+static void bench_cjson_fields(const char* doc) {
+    struct os fields = { 0, 0, "" };
+    cJSON* json = cJSON_Parse(doc);
+    cJSON* apimodel_json = cJSON_GetObjectItem(json, "apimodel");
+    cJSON* system_json = cJSON_GetObjectItem(json, "system");
+    cJSON* osname_json = cJSON_GetObjectItem(json, "osname");
+
+    if (cJSON_IsNumber(apimodel_json)) fields.apimodel = apimodel_json->valueint;
+    if (cJSON_IsNumber(system_json)) fields.system = system_json->valueint;
+    if (cJSON_IsString(osname_json)) bench_sink += osname_json->valuestring[0];
+    bench_sink += fields.apimodel + fields.system;
+    cJSON_Delete(json);
+}
+
+static void op_cjson_small(void) {
+    bench_cjson_fields(bench_small_doc);
+}
+
+static void op_cjson_large(void) {
+    bench_cjson_fields(bench_large_doc);
+}
+
+static void op_stream_small(void) {
+    struct sysinfo_extractor ex;
+    struct os fields;
+
+    sysinfo_extractor_init(&ex, &fields, SYSINFO_FIELD_ALL);
+    sysinfo_extractor_feed(&ex, bench_small_doc, sizeof(bench_small_doc) - 1);
+    bench_sink += sysinfo_extractor_finish(&ex) + (int)ex.found;
+}
+
+static void op_scan_large(void) {
+    struct os fields;
+    unsigned int found = 0;
+
+    bench_sink += sysinfo_scan_buffer(bench_large_doc, bench_large_len, &fields, &found) + (int)found;
+}
+
+// Full collect cycle against bench_url
+
+static struct curl_handle_pool bench_pool;
+static struct recovery_ctx bench_ctx;
+static struct response_cache bench_cache;
+static struct os bench_api_data;
+static int bench_server_state;  // 0 unknown, 1 up, -1 down
+
+static int setup_server(void) {
+    if (bench_server_state == 0) {
+        init_api_struct(&bench_api_data, NULL);
+        bench_server_state = (collect_api_data(&bench_api_data, bench_url) == API_SUCCESS) ? 1 : -1;
+        if (bench_server_state < 0) {
+            fprintf(stderr, "bench: no server at %s (pass --url), skipping collect cases\n", bench_url);
+        }
+    }
+    return (bench_server_state > 0) ? 0 : -1;
+}
+
+static int setup_recovery(void) {
+    struct os backup = { 1, 1, "Lumen" };
+
+    if (setup_server() != 0 || init_handle_pool(&bench_pool) != API_SUCCESS) {
+        return -1;
+    }
+    init_recovery_ctx(&bench_ctx, &backup);
+    bench_ctx.pool = &bench_pool;
+    // A collector that only succeeds via retries would time backoff sleeps, not the request
+    if (collect_api_data_with_recovery(&bench_api_data, bench_url, &bench_ctx, NULL) != API_SUCCESS) {
+        fprintf(stderr, "bench: recovery collect against %s failed, skipping\n", bench_url);
+        destroy_handle_pool(&bench_pool);
+        return -1;
+    }
+    return 0;
+}
+
+static void teardown_pool(void) {
+    destroy_handle_pool(&bench_pool);
+}
+
+static int setup_cache(void) {
+    if (setup_server() != 0 || init_handle_pool(&bench_pool) != API_SUCCESS) {
+        return -1;
+    }
+    init_response_cache(&bench_cache, 60000);
+    bench_cache.pool = &bench_pool;
+    if (collect_api_data_cached(&bench_cache, &bench_api_data, bench_url, NULL) != API_SUCCESS) {
+        fprintf(stderr, "bench: cached collect against %s failed, skipping\n", bench_url);
+        destroy_handle_pool(&bench_pool);
+        return -1;
+    }
+    return 0;
+}
+
+static void op_collect(void) {
+    bench_sink += collect_api_data(&bench_api_data, bench_url);
+}
+
+static void op_collect_recovery(void) {
+    bench_sink += collect_api_data_with_recovery(&bench_api_data, bench_url, &bench_ctx, NULL);
+}
+
+static void op_collect_cached(void) {
+    bench_sink += collect_api_data_cached(&bench_cache, &bench_api_data, bench_url, NULL);
+}
+
+static const BenchCase bench_cases[] = {
+    { "alloc/lumen_alloc_init",        NULL, op_lumen_alloc_init, NULL },
+    { "alloc/init_lumen_alloc",        NULL, op_init_lumen_alloc, NULL },
+    { "alloc/setup_lumen_manager",     NULL, op_setup_lumen_manager, NULL },
+    { "alloc/lumen_packed_alloc",      NULL, op_lumen_packed_alloc, NULL },
+    { "alloc/init_lumen_packed_unit",  NULL, op_lumen_packed_unit, NULL },
+    { "alloc/lumen_slab_64",           NULL, op_slab_64, NULL },
+    { "alloc/malloc_64",               NULL, op_malloc_64, NULL },
+    { "buffer/response_16k",           NULL, op_response_buffer_16k, NULL },
+    { "log/record",                    setup_logger, op_log_record, teardown_logger },
+    { "log/record_micros",             setup_logger_micros, op_log_record, teardown_logger },
+    { "log/record_filtered",           setup_logger, op_log_filtered, teardown_logger },
+    { "log/record_output",             setup_logger_muted, op_log_record_output, teardown_logger_muted },
+    { "log/record_async",              setup_async_log, op_log_record, teardown_async_log },
+    { "log/binlog_write",              setup_binlog, op_binlog_write, teardown_binlog },
+    { "json/cjson_small",              NULL, op_cjson_small, NULL },
+    { "json/stream_small",             NULL, op_stream_small, NULL },
+    { "json/cjson_300k",               setup_large_doc, op_cjson_large, NULL },
+    { "json/scan_300k",                setup_large_doc, op_scan_large, NULL },
+    { "collect/collect_api_data",      setup_server, op_collect, NULL },
+    { "collect/with_recovery_pooled",  setup_recovery, op_collect_recovery, teardown_pool },
+    { "collect/cached_hit",            setup_cache, op_collect_cached, teardown_pool },
+};
+
+#define BENCH_CASE_COUNT ((int)(sizeof(bench_cases) / sizeof(bench_cases[0])))
+
+// ---- Runner ----
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+static double percentile(const double* sorted, int count, double q) {
+    int rank = (int)(q * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static double time_batch(void (*op)(void), long batch) {
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < batch; i++) {
+        op();
+    }
+    return bench_elapsed_ns(&start);
+}
+
+static void run_case(const BenchCase* bc, int samples, BenchResult* out) {
+    double per_op[BENCH_MAX_SAMPLES];
+    unsigned long calls0, bytes0, calls1, bytes1;
+    unsigned long lumen0, lumen1, lumen_bytes;
+    double total = 0.0;
+    long batch = 1;
+
+    memset(out, 0, sizeof(BenchResult));
+    out->name = bc->name;
+    if (bc->setup && bc->setup() != 0) {
+        out->skipped = 1;
+        return;
+    }
+
+    // Warm up, then grow the batch until one sample is long enough to time
+    time_batch(bc->op, 1);
+    while (batch < BENCH_MAX_BATCH && time_batch(bc->op, batch) < BENCH_SAMPLE_NS) {
+        batch *= 2;
+    }
+
+    bench_lumen_counts(&lumen0, &lumen_bytes);
+    bench_alloc_counts(&calls0, &bytes0);
+    for (int s = 0; s < samples; s++) {
+        per_op[s] = time_batch(bc->op, batch) / batch;
+        total += per_op[s];
+    }
+    bench_alloc_counts(&calls1, &bytes1);
+    bench_lumen_counts(&lumen1, &lumen_bytes);
+
+    if (bc->teardown) {
+        bc->teardown();
+    }
+
+    qsort(per_op, samples, sizeof(double), compare_double);
+    out->batch = batch;
+    out->samples = samples;
+    out->mean_ns = total / samples;
+    out->p50_ns = percentile(per_op, samples, 0.50);
+    out->p90_ns = percentile(per_op, samples, 0.90);
+    out->p99_ns = percentile(per_op, samples, 0.99);
+    out->min_ns = per_op[0];
+    out->max_ns = per_op[samples - 1];
+    out->allocs_per_op = (double)(calls1 - calls0) / ((double)batch * samples);
+    out->bytes_per_op = (double)(bytes1 - bytes0) / ((double)batch * samples);
+    out->lumen_allocs_per_op = (double)(lumen1 - lumen0) / ((double)batch * samples);
+}
+
+static void cpu_feature_names(char* out, size_t out_size) {
+    unsigned int features = lumen_cpu_features();
+
+    snprintf(out, out_size, "%s%s%s%s",
+             (features & LUMEN_CPU_SSE2) ? "sse2 " : "",
+             (features & LUMEN_CPU_AVX2) ? "avx2 " : "",
+             (features & LUMEN_CPU_NEON) ? "neon " : "",
+             features ? "" : "none");
+    size_t len = strlen(out);
+    if (len > 0 && out[len - 1] == ' ') {
+        out[len - 1] = '\0';
+    }
+}
+
+static int write_json(const char* path, const char* label, const BenchResult* results, int count) {
+    char features[64];
+    FILE* out = fopen(path, "w");
+    int first = 1;
+
+    if (out == NULL) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        return -1;
+    }
+
+    cpu_feature_names(features, sizeof(features));
+    fprintf(out, "{\"label\":\"%s\",\"profile\":\"%s\",\"cpu\":\"%s\",\"alloc_scope\":\"%s\",\"results\":[\n",
+            label, LUMEN_PROFILE_NAME, features,
+#ifdef BENCH_COUNTS_MALLOC
+            "process"
+#else
+            "lumen"
+#endif
+            );
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        if (r->skipped) {
+            continue;
+        }
+        fprintf(out, "%s{\"name\":\"%s\",\"batch\":%ld,\"samples\":%d,\"ns_op\":%.2f,"
+                "\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"min\":%.2f,\"max\":%.2f,"
+                "\"allocs_op\":%.3f,\"bytes_op\":%.1f,\"lumen_allocs_op\":%.3f}",
+                first ? "" : ",\n", r->name, r->batch, r->samples, r->mean_ns,
+                r->p50_ns, r->p90_ns, r->p99_ns, r->min_ns, r->max_ns,
+                r->allocs_per_op, r->bytes_per_op, r->lumen_allocs_per_op);
+        first = 0;
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [--json FILE] [--label TEXT] [--filter TEXT] [--samples N] [--url URL]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    BenchResult results[BENCH_CASE_COUNT];
+    const char* json_path = NULL;
+    const char* label = "";
+    const char* filter = NULL;
+    int samples = BENCH_DEFAULT_SAMPLES;
+    int count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            json_path = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--label") == 0) {
+            label = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--samples") == 0) {
+            samples = atoi(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--url") == 0) {
+            bench_url = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (samples < 1 || samples > BENCH_MAX_SAMPLES) {
+        fprintf(stderr, "bench: --samples must be 1..%d\n", BENCH_MAX_SAMPLES);
+        return 2;
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    struct mock_server* mock = NULL;
+    if (!bench_url) {
+        struct mock_server_config mock_cfg;
+        init_mock_server_config(&mock_cfg);
+        mock_cfg.port = 0;
+        mock = start_mock_server(&mock_cfg);
+        bench_url = mock ? mock_server_url(mock) : "http://127.0.0.1:8080/api/system-info";
+    }
+
+    printf("profile %s, %d samples per case\n", LUMEN_PROFILE_NAME, samples);
+    printf("%-30s %10s %10s %10s %10s %10s %10s %10s\n",
+           "benchmark", "ns/op", "p50", "p90", "p99", "allocs/op", "bytes/op", "lumen/op");
+    for (int i = 0; i < BENCH_CASE_COUNT; i++) {
+        if (filter && strstr(bench_cases[i].name, filter) == NULL) {
+            continue;
+        }
+        BenchResult* r = &results[count++];
+        run_case(&bench_cases[i], samples, r);
+        if (r->skipped) {
+            printf("%-30s %10s\n", r->name, "skipped");
+        } else {
+            printf("%-30s %10.1f %10.1f %10.1f %10.1f %10.2f %10.0f %10.2f\n", r->name, r->mean_ns,
+                   r->p50_ns, r->p90_ns, r->p99_ns, r->allocs_per_op, r->bytes_per_op,
+                   r->lumen_allocs_per_op);
+        }
+        fflush(stdout);
+    }
+
+    free(bench_large_doc);
+    stop_mock_server(mock);
+    curl_global_cleanup();
+
+    if (json_path && write_json(json_path, label, results, count) != 0) {
+        return 1;
+    }
+    return 0;
+}
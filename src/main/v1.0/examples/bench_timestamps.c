@@ -0,0 +1,56 @@
+/*
+bench_timestamps.c (System API Module example).
+Benchmark: log timestamp formatting.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "bench.h"
+
+// Benchmark: per-record cost of the old localtime + strftime path vs the cache
+int main() {
+    const int records = 1000000;
+    const char* marker = "[Lumen OS - " LUMEN_DEVICE_NAME "]";
+    char line[512];
+    char time_str[64];
+    struct timespec start;
+    time_t base = time(NULL);
+    
+    // Callers bump the timestamp now and then, roughly one new second per 1000 lines
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < records; i++) {
+        time_t stamp = base + i / 1000;
+        struct tm* time_info = localtime(&stamp);
+        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", time_info);
+        snprintf(line, sizeof(line), "%s %s [Level %d]: %s\n", marker, time_str, 2, "Sensor poll completed");
+    }
+    double before_ns = bench_elapsed_ns(&start) / records;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < records; i++) {
+        lumen_format_timestamp(base + i / 1000, 0, LUMEN_TS_SECONDS, time_str, sizeof(time_str));
+        snprintf(line, sizeof(line), "%s %s [Level %d]: %s\n", marker, time_str, 2, "Sensor poll completed");
+    }
+    double after_ns = bench_elapsed_ns(&start) / records;
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < records; i++) {
+        time_t sec;
+        long nsec;
+        lumen_clock_now(&sec, &nsec);
+        lumen_format_timestamp(sec, nsec, LUMEN_TS_MICROS, time_str, sizeof(time_str));
+        snprintf(line, sizeof(line), "%s %s [Level %d]: %s\n", marker, time_str, 2, "Sensor poll completed");
+    }
+    double micros_ns = bench_elapsed_ns(&start) / records;
+    
+    printf("localtime + strftime:       %7.1f ns/record\n", before_ns);
+    printf("cached (seconds):           %7.1f ns/record  %.1fx\n", after_ns, before_ns / after_ns);
+    printf("cached + monotonic (usec):  %7.1f ns/record\n", micros_ns);
+    printf("Calendar conversions: %lu for %d records\n", lumen_timestamp_conversions(), 2 * records);
+    printf("Sample: %s\n", time_str);
+    return 0;
+}
@@ -0,0 +1,53 @@
+/*
+binlog_decode.c (System API Module example).
+Binary log writer / decoder tool.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+// Decoder tool: "binlog_decode lumen.blog" prints the text log; without
+// arguments it writes and decodes a small sample
+int main(int argc, char* argv[]) {
+    const char* path = (argc > 1) ? argv[1] : "lumen.blog";
+    
+    if (argc == 1) {
+        LumenBinLogger* log = create_lumen_binlog(path, 1);
+        if (log == NULL) {
+            printf("Binary log creation failed on Lumen OS\n");
+            return 1;
+        }
+        
+        int boot = lumen_binlog_register(log, "Boot stage %d finished in %.2f ms");
+        int battery = lumen_binlog_register(log, "Battery at %d%% (%s)");
+        
+        for (int i = 0; i < 3; i++) {
+            lumen_binlog_write(log, boot, 2, i, 12.5 * (i + 1));
+        }
+        lumen_binlog_write(log, battery, 3, 14, "discharging");
+        
+        // Existing handler API, routed through the binary backend
+        LumenLogHandler* logger = create_lumen_logger(2);
+        lumen_binlog_attach(log);
+        record_lumen_log(logger, "Error: Connection timeout", 4);
+        output_lumen_log(logger);
+        release_lumen_logger(logger);
+        
+        print_lumen_binlog_stats(log);
+        release_lumen_binlog(log);
+    }
+    
+    FILE* in = fopen(path, "rb");
+    if (in == NULL) {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    int decoded = lumen_binlog_decode(in, stdout);
+    fclose(in);
+    
+    return (decoded < 0) ? 1 : 0;
+}
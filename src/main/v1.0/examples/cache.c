@@ -0,0 +1,44 @@
+/*
+cache.c (System API Module example).
+Cached collection with conditional revalidation.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    struct os api_data;
+    struct auth_config auth;
+    struct response_cache cache;
+    struct curl_handle_pool pool;
+    const char *internal_api = "http://localhost:8080/api/system-info";
+    int status = API_SUCCESS;
+    
+    memset(&api_data, 0, sizeof(api_data));
+    init_auth_config(&auth, "apiuser", "apipass");
+    
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    init_response_cache(&cache, 500);
+    if (init_handle_pool(&pool) == API_SUCCESS) {
+        cache.pool = &pool;
+    }
+    
+    // Burst of callers within the TTL: one fetch, the rest are hits
+    for (int i = 0; i < 100; i++) {
+        status = collect_api_data_cached(&cache, &api_data, internal_api, &auth);
+    }
+    
+    // After expiry the entry is revalidated instead of refetched
+    usleep(600000);
+    status = collect_api_data_cached(&cache, &api_data, internal_api, &auth);
+    
+    print_api_data(&api_data, status);
+    print_cache_stats(&cache);
+    destroy_handle_pool(cache.pool);
+    curl_global_cleanup();
+    return (status == API_SUCCESS) ? 0 : 1;
+}
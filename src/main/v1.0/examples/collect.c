@@ -0,0 +1,46 @@
+/*
+collect.c (System API Module example).
+Single collection with full error handling.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    struct os api_data;
+    int status;
+    const char *internal_api = "http://localhost:8080/api/system-info";
+    
+    // Initialize curl globally
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    
+    // Initialize struct
+    status = init_api_struct(&api_data, NULL);
+    if (status != API_SUCCESS) {
+        fprintf(stderr, "Failed to initialize API struct\n");
+        curl_global_cleanup();
+        return 1;
+    }
+    
+    // Try to collect data
+    printf("Attempting to collect data from: %s\n", internal_api);
+    status = collect_api_data(&api_data, internal_api);
+    
+    // Always print results (even on error)
+    print_api_data(&api_data, status);
+    
+    // Apply fallback values only if critical fields are invalid
+    if (status != API_SUCCESS || api_data.apimodel == -1 || api_data.system == -1) {
+        printf("Applying fallback values...\n");
+        api_data.apimodel = 1;
+        api_data.system = 1;
+        strcpy(api_data.osname, "Lumen");
+    }
+    
+    curl_global_cleanup();
+    return (status == API_SUCCESS) ? 0 : 1;
+}
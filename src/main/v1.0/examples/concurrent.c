@@ -0,0 +1,41 @@
+/*
+concurrent.c (System API Module example).
+Race every endpoint from one multi handle.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    struct os api_data, backup_data;
+    struct recovery_ctx ctx;
+    struct auth_config auth;
+    struct curl_handle_pool pool;
+    
+    backup_data.apimodel = 1;
+    backup_data.system = 1;
+    strcpy(backup_data.osname, "Lumen");
+    
+    init_auth_config(&auth, "apiuser", "apipass");
+    
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    
+    init_recovery_ctx(&ctx, &backup_data);
+    init_api_struct(&api_data, &backup_data);
+    if (init_handle_pool(&pool) == API_SUCCESS) {
+        ctx.pool = &pool;
+    }
+    
+    printf("🚀 Racing all endpoints...\n");
+    int status = collect_api_data_concurrent(&api_data, &ctx, &auth);
+    
+    print_recovery_status(&api_data, status, &ctx);
+    print_pool_stats(ctx.pool);
+    destroy_handle_pool(ctx.pool);
+    curl_global_cleanup();
+    return (status == API_SUCCESS) ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+/*
+engine.c (System API Module example).
+Many collections in parallel on the worker-pool engine.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+#define JOBS 64
+
+int main() {
+    static struct collect_task tasks[JOBS];
+    struct collect_engine engine;
+    struct os backup_data;
+    struct auth_config auth;
+    long long slowest_us = 0;
+    int ok = 0;
+    
+    backup_data.apimodel = 1;
+    backup_data.system = 1;
+    strcpy(backup_data.osname, "Lumen");
+    
+    init_auth_config(&auth, "apiuser", "apipass");
+    
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    
+    if (start_collect_engine(&engine, 0, &backup_data) != API_SUCCESS) {
+        curl_global_cleanup();
+        return 1;
+    }
+    printf("⚙️ Collection engine: %d workers\n", engine.worker_count);
+    
+    for (int i = 0; i < JOBS; i++) {
+        tasks[i].url = "http://localhost:8080/api/system-info";
+        tasks[i].auth = &auth;
+    }
+    
+    printf("🚀 Submitting %d collection jobs...\n", JOBS);
+    collect_engine_submit_batch(&engine, tasks, JOBS);
+    collect_engine_wait(&engine);
+    
+    for (int i = 0; i < JOBS; i++) {
+        if (tasks[i].status == API_SUCCESS) ok++;
+        if (tasks[i].latency_us > slowest_us) slowest_us = tasks[i].latency_us;
+    }
+    printf("%d/%d jobs succeeded, slowest %.1fms\n", ok, JOBS, slowest_us / 1000.0);
+    printf("API Model: %d | System: %d | OS: %s\n",
+           tasks[0].data.apimodel, tasks[0].data.system, tasks[0].data.osname);
+    
+    print_engine_stats(&engine);
+    for (int i = 0; i < engine.worker_count; i++) {
+        print_pool_stats(&engine.workers[i].pool);
+    }
+    stop_collect_engine(&engine);
+    curl_global_cleanup();
+    return (ok == JOBS) ? 0 : 1;
+}
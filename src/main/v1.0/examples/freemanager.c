@@ -0,0 +1,41 @@
+/*
+freemanager.c (System API Module example).
+LumenFreeManager demo (checked free).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    // Allocate 256 bytes (arbitrary size for example)
+    LumenFreeManager* mgr = setup_lumen_manager(256);
+    if (mgr == NULL) {
+        printf("Setup failed on Lumen OS\n");
+        return 1;
+    }
+    
+    // Simulate usage: memset to fill memory
+    memset(mgr->mem_ptr, 0xAA, 256);
+    
+    // Now free it
+    execute_lumen_free(mgr);
+    
+    // Log the result
+    log_lumen_status(mgr);
+    
+    // Additional checks: try to free again (should fail)
+    execute_lumen_free(mgr);
+    log_lumen_status(mgr);
+    
+    // Delay for Lumen mobile simulation
+    usleep(150000);  // 0.15s
+    
+    // Cleanup manager
+    destroy_lumen_manager(mgr);
+    
+    return 0;
+}
@@ -0,0 +1,425 @@
+/*
+loadgen.c (System API Module example).
+Load generator for the collectors: N client threads against one endpoint,
+closed-loop (each client sends as soon as its last call returns) or at a
+fixed total request rate.
+
+  loadgen [--url URL] [--clients N] [--duration SEC] [--rate RPS]
+          [--collector plain|recovery] [--basic USER:PASS] [--bearer TOKEN]
+          [--timeouts adaptive|fixed] [--report FILE] [--mock-latency MS]
+          [--mock-jitter MS] [--mock-errors PCT] [--mock-drop PCT] [--verbose]
+
+Without --url an in-process mock server is started and the --mock-* faults
+apply to it; it serves one connection per worker, so it takes at most
+MOCK_MAX_WORKERS clients. At a fixed rate, latency is measured from the
+time a request was due rather than when it went out, so a stalled endpoint
+shows up in the percentiles instead of silently lowering the send rate.
+
+The recovery clients share one endpoint registry, so the adaptive timeouts
+(the default) learn from every client; --timeouts fixed turns them off.
+
+Latencies go into one HDR-style histogram per client, merged at the end.
+The report (JSON, default loadgen-report.json) holds throughput, latency
+percentiles, retry counts and the API_ERROR breakdown.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "systemapimod.h"
+
+#define LOAD_MAX_CLIENTS 256
+#define LOAD_RETRY_BUCKETS 4    // 0, 1, 2, 3+ retries
+
+// Outcomes reported separately, anything else counts as "other"
+static const struct {
+    int code;
+    const char* name;
+} load_outcomes[] = {
+    { API_SUCCESS, "SUCCESS" },
+    { API_RECOVERY_SUCCESS, "RECOVERY_SUCCESS" },
+    { API_MEM_ERROR, "MEM_ERROR" },
+    { API_CURL_INIT_ERROR, "CURL_INIT_ERROR" },
+    { API_NETWORK_ERROR, "NETWORK_ERROR" },
+    { API_JSON_PARSE_ERROR, "JSON_PARSE_ERROR" },
+    { API_STRUCT_INIT_ERROR, "STRUCT_INIT_ERROR" },
+    { API_AUTH_ERROR, "AUTH_ERROR" },
+    { API_MAX_RETRIES, "MAX_RETRIES" },
+};
+#define LOAD_OUTCOME_COUNT ((int)(sizeof(load_outcomes) / sizeof(load_outcomes[0])))
+
+static const double load_percentiles[] = { 50.0, 75.0, 90.0, 95.0, 99.0, 99.9, 99.99 };
+#define LOAD_PERCENTILE_COUNT ((int)(sizeof(load_percentiles) / sizeof(load_percentiles[0])))
+
+struct load_config {
+    const char* url;
+    int clients;
+    double duration_s;
+    double rate;            // Total requests per second, 0 = closed loop
+    int use_recovery;
+    struct auth_config auth;
+    int has_auth;
+    int fixed_timeouts;
+    struct endpoint_registry* endpoints;   // Recovery collector only
+};
+
+struct load_client {
+    pthread_t thread;
+    const struct load_config* cfg;
+    int id;
+    long long start_us;
+    long long end_us;
+    struct latency_histogram hist;
+    unsigned long requests;
+    unsigned long outcomes[LOAD_OUTCOME_COUNT + 1];   // Last slot: other
+    unsigned long retries[LOAD_RETRY_BUCKETS];
+    unsigned long retry_total;
+    unsigned long late;     // Fixed rate: requests sent after they were due
+};
+
+static long long load_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void sleep_until_us(long long when_us) {
+    long long now = load_now_us();
+    if (when_us > now) {
+        struct timespec ts = { (time_t)((when_us - now) / 1000000LL), (long)((when_us - now) % 1000000LL) * 1000L };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static int outcome_slot(int status) {
+    for (int i = 0; i < LOAD_OUTCOME_COUNT; i++) {
+        if (load_outcomes[i].code == status) return i;
+    }
+    return LOAD_OUTCOME_COUNT;
+}
+
+static void* load_client_run(void* arg) {
+    struct load_client* c = (struct load_client*)arg;
+    const struct load_config* cfg = c->cfg;
+    struct os api_data;
+    struct os backup = { 1, 1, "Lumen" };
+    struct recovery_ctx ctx;
+    struct curl_handle_pool pool;
+    int have_pool = 0;
+
+    init_latency_histogram(&c->hist);
+    init_api_struct(&api_data, NULL);
+    if (cfg->use_recovery) {
+        init_recovery_ctx(&ctx, &backup);
+        ctx.endpoints = cfg->endpoints;
+        ctx.timeouts.adaptive = !cfg->fixed_timeouts;
+        if (init_handle_pool(&pool) == API_SUCCESS) {
+            ctx.pool = &pool;
+            have_pool = 1;
+        }
+    }
+
+    // Fixed rate: clients take every clients-th slot of one global schedule
+    long long interval_us = (cfg->rate > 0) ? (long long)(1000000.0 * cfg->clients / cfg->rate) : 0;
+    long long due_us = c->start_us + (interval_us * c->id) / cfg->clients;
+
+    while (1) {
+        long long sent_us;
+        if (interval_us > 0) {
+            if (due_us >= c->end_us) break;
+            sleep_until_us(due_us);
+            sent_us = due_us;
+            if (load_now_us() - due_us > 1000) c->late++;
+            due_us += interval_us;
+        } else {
+            sent_us = load_now_us();
+            if (sent_us >= c->end_us) break;
+        }
+
+        int status;
+        int retries = 0;
+        if (cfg->use_recovery) {
+            status = collect_api_data_with_recovery(&api_data, cfg->url, &ctx, cfg->has_auth ? &cfg->auth : NULL);
+            retries = ctx.retry_count;
+        } else {
+            status = collect_api_data(&api_data, cfg->url);
+        }
+
+        latency_histogram_record(&c->hist, load_now_us() - sent_us);
+        c->requests++;
+        c->outcomes[outcome_slot(status)]++;
+        c->retries[(retries < LOAD_RETRY_BUCKETS - 1) ? retries : LOAD_RETRY_BUCKETS - 1]++;
+        c->retry_total += (unsigned long)retries;
+    }
+
+    if (have_pool) destroy_handle_pool(&pool);
+    return NULL;
+}
+
+static int write_report(const char* path, const struct load_config* cfg, const struct load_client* total,
+                        double elapsed_s) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "loadgen: cannot write %s\n", path);
+        return -1;
+    }
+
+    fprintf(out, "{\n  \"url\": \"%s\",\n  \"profile\": \"%s\",\n", cfg->url, LUMEN_PROFILE_NAME);
+    fprintf(out, "  \"collector\": \"%s\",\n  \"mode\": \"%s\",\n", cfg->use_recovery ? "recovery" : "plain",
+            cfg->rate > 0 ? "fixed_rate" : "closed_loop");
+    fprintf(out, "  \"clients\": %d,\n  \"target_rate\": %.1f,\n  \"duration_s\": %.3f,\n",
+            cfg->clients, cfg->rate, elapsed_s);
+    fprintf(out, "  \"requests\": %lu,\n  \"throughput\": %.1f,\n  \"late\": %lu,\n", total->requests,
+            elapsed_s > 0 ? total->requests / elapsed_s : 0.0, total->late);
+
+    fprintf(out, "  \"latency_us\": {\"min\": %lld, \"mean\": %.1f, \"max\": %lld",
+            total->hist.total ? total->hist.min_us : 0, latency_histogram_mean(&total->hist), total->hist.max_us);
+    for (int i = 0; i < LOAD_PERCENTILE_COUNT; i++) {
+        fprintf(out, ", \"p%g\": %lld", load_percentiles[i], latency_histogram_percentile(&total->hist, load_percentiles[i]));
+    }
+    fprintf(out, "},\n");
+
+    fprintf(out, "  \"retries\": {\"total\": %lu, \"0\": %lu, \"1\": %lu, \"2\": %lu, \"3+\": %lu},\n",
+            total->retry_total, total->retries[0], total->retries[1], total->retries[2], total->retries[3]);
+
+    if (cfg->endpoints) {
+        struct latency_snapshot snap;
+        if (get_endpoint_latency_stats(cfg->endpoints, cfg->url, &snap) != API_SUCCESS) {
+            memset(&snap, 0, sizeof(snap));
+            snap.tail_us = -1;
+        }
+        fprintf(out, "  \"timeouts\": {\"policy\": \"%s\", \"timed_out\": %lu, \"p99_estimate_us\": %lld},\n",
+                cfg->fixed_timeouts ? "fixed" : "adaptive", snap.timeouts, snap.tail_us);
+    }
+
+    fprintf(out, "  \"outcomes\": {");
+    for (int i = 0; i <= LOAD_OUTCOME_COUNT; i++) {
+        fprintf(out, "%s\"%s\": %lu", i ? ", " : "", i < LOAD_OUTCOME_COUNT ? load_outcomes[i].name : "other",
+                total->outcomes[i]);
+    }
+    fprintf(out, "},\n");
+
+    // HdrHistogram-style percentile distribution: halve the remaining tail at every step
+    fprintf(out, "  \"distribution\": [\n");
+    double remaining = 100.0;
+    for (int step = 0; step < 20; step++) {
+        double pct = 100.0 - remaining;
+        fprintf(out, "    {\"percentile\": %.6f, \"value_us\": %lld},\n", pct, latency_histogram_percentile(&total->hist, pct));
+        remaining /= 2.0;
+    }
+    fprintf(out, "    {\"percentile\": 100.000000, \"value_us\": %lld}\n  ]\n}\n", total->hist.max_us);
+
+    fclose(out);
+    return 0;
+}
+
+static void print_summary(const struct load_config* cfg, const struct load_client* total, double elapsed_s) {
+    printf("=== LOAD TEST %s ===\n", cfg->url);
+    printf("Collector: %s | Clients: %d | Mode: ", cfg->use_recovery ? "recovery" : "plain", cfg->clients);
+    if (cfg->rate > 0) {
+        printf("fixed %.1f req/s (%lu late)\n", cfg->rate, total->late);
+    } else {
+        printf("closed loop\n");
+    }
+    printf("Requests: %lu in %.2fs | %.1f req/s\n", total->requests, elapsed_s,
+           elapsed_s > 0 ? total->requests / elapsed_s : 0.0);
+    printf("Latency: mean=%.0fus p50=%lldus p90=%lldus p99=%lldus p99.9=%lldus max=%lldus\n",
+           latency_histogram_mean(&total->hist), latency_histogram_percentile(&total->hist, 50.0),
+           latency_histogram_percentile(&total->hist, 90.0), latency_histogram_percentile(&total->hist, 99.0),
+           latency_histogram_percentile(&total->hist, 99.9), total->hist.max_us);
+    printf("Retries: %lu total | 0: %lu | 1: %lu | 2: %lu | 3+: %lu\n", total->retry_total,
+           total->retries[0], total->retries[1], total->retries[2], total->retries[3]);
+    if (cfg->endpoints) {
+        struct latency_snapshot snap;
+        if (get_endpoint_latency_stats(cfg->endpoints, cfg->url, &snap) == API_SUCCESS) {
+            printf("Timeouts: %s | timed out: %lu | p99 estimate: %lldus\n",
+                   cfg->fixed_timeouts ? "fixed" : "adaptive", snap.timeouts, snap.tail_us);
+        }
+    }
+    printf("Outcomes:");
+    for (int i = 0; i <= LOAD_OUTCOME_COUNT; i++) {
+        if (total->outcomes[i]) {
+            printf(" %s=%lu", i < LOAD_OUTCOME_COUNT ? load_outcomes[i].name : "other", total->outcomes[i]);
+        }
+    }
+    printf("\n======================\n");
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [--url URL] [--clients N] [--duration SEC] [--rate RPS]\n"
+            "       [--collector plain|recovery] [--basic USER:PASS] [--bearer TOKEN]\n"
+            "       [--timeouts adaptive|fixed] [--report FILE] [--mock-latency MS]\n"
+            "       [--mock-jitter MS] [--mock-errors PCT] [--mock-drop PCT] [--verbose]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char* argv[]) {
+    static struct load_client clients[LOAD_MAX_CLIENTS];
+    static struct load_client total;
+    static struct endpoint_registry registry;
+    struct load_config cfg;
+    struct mock_faults faults;
+    const char* report = "loadgen-report.json";
+    int verbose = 0;
+
+    memset(&cfg, 0, sizeof(cfg));
+    memset(&faults, 0, sizeof(faults));
+    cfg.clients = 4;
+    cfg.duration_s = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+            continue;
+        }
+        if (i + 1 >= argc) usage(argv[0]);
+        const char* val = argv[++i];
+
+        if (strcmp(argv[i - 1], "--url") == 0) {
+            cfg.url = val;
+        } else if (strcmp(argv[i - 1], "--clients") == 0) {
+            cfg.clients = atoi(val);
+        } else if (strcmp(argv[i - 1], "--duration") == 0) {
+            cfg.duration_s = atof(val);
+        } else if (strcmp(argv[i - 1], "--rate") == 0) {
+            cfg.rate = atof(val);
+        } else if (strcmp(argv[i - 1], "--collector") == 0) {
+            if (strcmp(val, "recovery") == 0) {
+                cfg.use_recovery = 1;
+            } else if (strcmp(val, "plain") != 0) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i - 1], "--basic") == 0) {
+            char user[64];
+            const char* colon = strchr(val, ':');
+            size_t len = colon ? (size_t)(colon - val) : strlen(val);
+            if (len >= sizeof(user)) len = sizeof(user) - 1;
+            memcpy(user, val, len);
+            user[len] = '\0';
+            init_auth_config(&cfg.auth, user, colon ? colon + 1 : "");
+            cfg.has_auth = 1;
+        } else if (strcmp(argv[i - 1], "--bearer") == 0) {
+            set_bearer_token(&cfg.auth, val);
+            cfg.has_auth = 1;
+        } else if (strcmp(argv[i - 1], "--timeouts") == 0) {
+            if (strcmp(val, "fixed") == 0) {
+                cfg.fixed_timeouts = 1;
+            } else if (strcmp(val, "adaptive") != 0) {
+                usage(argv[0]);
+            }
+        } else if (strcmp(argv[i - 1], "--report") == 0) {
+            report = val;
+        } else if (strcmp(argv[i - 1], "--mock-latency") == 0) {
+            faults.latency_ms = atoi(val);
+        } else if (strcmp(argv[i - 1], "--mock-jitter") == 0) {
+            faults.jitter_ms = atoi(val);
+        } else if (strcmp(argv[i - 1], "--mock-errors") == 0) {
+            faults.server_error_pct = atoi(val);
+        } else if (strcmp(argv[i - 1], "--mock-drop") == 0) {
+            faults.drop_pct = atoi(val);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (cfg.clients < 1 || cfg.clients > LOAD_MAX_CLIENTS || cfg.duration_s <= 0 || cfg.rate < 0) {
+        fprintf(stderr, "loadgen: need 1..%d clients, a positive duration and a rate >= 0\n", LOAD_MAX_CLIENTS);
+        return 2;
+    }
+    if (!cfg.url && cfg.clients > MOCK_MAX_WORKERS) {
+        fprintf(stderr, "loadgen: the built-in mock serves at most %d clients; use --url for more\n", MOCK_MAX_WORKERS);
+        return 2;
+    }
+    if (cfg.has_auth && !cfg.use_recovery) {
+        fprintf(stderr, "loadgen: credentials need --collector recovery (collect_api_data sends none)\n");
+        return 2;
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    struct mock_server* mock = NULL;
+    if (!cfg.url) {
+        struct mock_server_config mock_cfg;
+        init_mock_server_config(&mock_cfg);
+        mock_cfg.port = 0;
+        mock_cfg.workers = cfg.clients;
+        mock_cfg.faults = faults;
+        if (cfg.has_auth) mock_cfg.auth = cfg.auth;
+        mock = start_mock_server(&mock_cfg);
+        if (!mock) {
+            curl_global_cleanup();
+            return 1;
+        }
+        cfg.url = mock_server_url(mock);
+    }
+
+    // Only the target URL, so the collector never falls back to the built-in endpoints
+    if (cfg.use_recovery) {
+        init_endpoint_registry(&registry);
+        set_registry_endpoints(&registry, &cfg.url, 1);
+        cfg.endpoints = &registry;
+    }
+
+    // The collectors report every call on stdout/stderr; keep them out of the way
+    int saved_out = -1, saved_err = -1;
+    if (!verbose) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            fflush(stdout);
+            fflush(stderr);
+            saved_out = dup(STDOUT_FILENO);
+            saved_err = dup(STDERR_FILENO);
+            dup2(devnull, STDOUT_FILENO);
+            dup2(devnull, STDERR_FILENO);
+            close(devnull);
+        }
+    }
+
+    long long start_us = load_now_us() + 10000;   // Let every thread start before the first slot
+    long long end_us = start_us + (long long)(cfg.duration_s * 1000000.0);
+    int started = 0;
+    for (int i = 0; i < cfg.clients; i++) {
+        clients[i].cfg = &cfg;
+        clients[i].id = i;
+        clients[i].start_us = start_us;
+        clients[i].end_us = end_us;
+        if (pthread_create(&clients[i].thread, NULL, load_client_run, &clients[i]) != 0) break;
+        started++;
+    }
+
+    init_latency_histogram(&total.hist);
+    for (int i = 0; i < started; i++) {
+        pthread_join(clients[i].thread, NULL);
+        latency_histogram_merge(&total.hist, &clients[i].hist);
+        total.requests += clients[i].requests;
+        total.retry_total += clients[i].retry_total;
+        total.late += clients[i].late;
+        for (int k = 0; k <= LOAD_OUTCOME_COUNT; k++) total.outcomes[k] += clients[i].outcomes[k];
+        for (int k = 0; k < LOAD_RETRY_BUCKETS; k++) total.retries[k] += clients[i].retries[k];
+    }
+    double elapsed_s = (load_now_us() - start_us) / 1000000.0;
+
+    if (saved_out >= 0) {
+        fflush(stdout);
+        fflush(stderr);
+        dup2(saved_out, STDOUT_FILENO);
+        dup2(saved_err, STDERR_FILENO);
+        close(saved_out);
+        close(saved_err);
+    }
+
+    cfg.clients = started;
+    print_summary(&cfg, &total, elapsed_s);
+    if (mock) print_mock_stats(mock);
+    int rc = write_report(report, &cfg, &total, elapsed_s);
+    if (rc == 0) printf("Report: %s\n", report);
+
+    stop_mock_server(mock);
+    curl_global_cleanup();
+    return (rc == 0) ? 0 : 1;
+}
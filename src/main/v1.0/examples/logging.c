@@ -0,0 +1,44 @@
+/*
+logging.c (System API Module example).
+LumenLogHandler demo.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    // Create logger with minimum level 2
+    LumenLogHandler* logger = create_lumen_logger(2);
+    if (logger == NULL) {
+        printf("Logger creation failed on Lumen OS\n");
+        return 1;
+    }
+    
+    // Record some logs
+    record_lumen_log(logger, "System boot initiated", 3);
+    output_lumen_log(logger);
+    
+    record_lumen_log(logger, "Debug info: Memory check passed", 1);  // Below level, skipped
+    output_lumen_log(logger);
+    
+    record_lumen_log(logger, "Warning: Low battery detected", 2);
+    output_lumen_log(logger);
+    
+    // Update timestamp for next logs
+    time(&logger->timestamp);
+    
+    record_lumen_log(logger, "Error: Connection timeout", 4);
+    output_lumen_log(logger);
+    
+    // Delay to simulate Lumen OS processing
+    usleep(250000);  // 0.25s
+    
+    // Release
+    release_lumen_logger(logger);
+    
+    return 0;
+}
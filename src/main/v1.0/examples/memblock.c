@@ -0,0 +1,45 @@
+/*
+memblock.c (System API Module example).
+LumenMemBlock demo (malloc-based blocks).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    // Allocate for 15 elements (modified from original 10)
+    LumenMemBlock* block = lumen_alloc_init(15);
+    if (block == NULL) {
+        printf("Allocation failed on Lumen OS\n");
+        return 1;
+    }
+    
+    // Set value at fourth position (modified from third)
+    lumen_set_value(block, 3, 75);  // Modified value from 50
+    
+    // Add a loop to set more values for heavier modification
+    for (size_t i = 0; i < block->block_size; ++i) {
+        if (i != 3) {
+            lumen_set_value(block, i, (int)i * 2);
+        }
+    }
+    
+    // Print the specific value
+    lumen_print_value(block, 3);
+    
+    // Print another value to demonstrate
+    lumen_print_value(block, 0);
+    lumen_print_value(block, 14);
+    
+    // Simulate some Lumen OS delay (e.g., for mobile responsiveness)
+    usleep(100000);  // 0.1 second delay
+    
+    // Cleanup
+    lumen_free_block(block);
+    
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+mock_server.c (System API Module example).
+Local Lumen API with fault injection, for the other examples and load tests.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+static volatile sig_atomic_t stop_requested;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [--port N] [--workers N] [--basic USER:PASS] [--bearer TOKEN]\n"
+            "       [--latency MS] [--jitter MS] [--drop PCT] [--unauthorized PCT]\n"
+            "       [--server-error PCT] [--truncate PCT] [--body JSON]\n"
+            "Serves /api/system-info and /api/system on 127.0.0.1 until Ctrl-C.\n", prog);
+    exit(2);
+}
+
+int main(int argc, char* argv[]) {
+    struct mock_server_config cfg;
+    struct mock_server *srv;
+    
+    init_mock_server_config(&cfg);
+    
+    for (int i = 1; i < argc; i++) {
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!val) usage(argv[0]);
+        
+        if (strcmp(argv[i], "--port") == 0) {
+            cfg.port = (unsigned short)atoi(val);
+        } else if (strcmp(argv[i], "--workers") == 0) {
+            cfg.workers = atoi(val);
+        } else if (strcmp(argv[i], "--basic") == 0) {
+            char user[64];
+            const char *colon = strchr(val, ':');
+            size_t len = colon ? (size_t)(colon - val) : strlen(val);
+            if (len >= sizeof(user)) len = sizeof(user) - 1;
+            memcpy(user, val, len);
+            user[len] = '\0';
+            init_auth_config(&cfg.auth, user, colon ? colon + 1 : "");
+        } else if (strcmp(argv[i], "--bearer") == 0) {
+            set_bearer_token(&cfg.auth, val);
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            cfg.faults.latency_ms = atoi(val);
+        } else if (strcmp(argv[i], "--jitter") == 0) {
+            cfg.faults.jitter_ms = atoi(val);
+        } else if (strcmp(argv[i], "--drop") == 0) {
+            cfg.faults.drop_pct = atoi(val);
+        } else if (strcmp(argv[i], "--unauthorized") == 0) {
+            cfg.faults.unauthorized_pct = atoi(val);
+        } else if (strcmp(argv[i], "--server-error") == 0) {
+            cfg.faults.server_error_pct = atoi(val);
+        } else if (strcmp(argv[i], "--truncate") == 0) {
+            cfg.faults.truncate_pct = atoi(val);
+        } else if (strcmp(argv[i], "--body") == 0) {
+            cfg.body = val;
+        } else {
+            usage(argv[0]);
+        }
+        i++;
+    }
+    
+    srv = start_mock_server(&cfg);
+    if (!srv) return 1;
+    
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    printf("🧪 Mock Lumen API on %s (%d workers", mock_server_url(srv), cfg.workers);
+    if (cfg.auth.use_basic_auth) printf(", Basic auth");
+    if (cfg.auth.use_bearer_auth) printf(", Bearer auth");
+    printf(")\n");
+    printf("Faults: drop %d%% | 401 %d%% | 5xx %d%% | truncate %d%% | latency %d+%dms\n",
+           cfg.faults.drop_pct, cfg.faults.unauthorized_pct, cfg.faults.server_error_pct,
+           cfg.faults.truncate_pct, cfg.faults.latency_ms, cfg.faults.jitter_ms);
+    fflush(stdout);
+    
+    while (!stop_requested) {
+        pause();
+    }
+    
+    print_mock_stats(srv);
+    stop_mock_server(srv);
+    return 0;
+}
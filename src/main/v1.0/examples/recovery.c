@@ -0,0 +1,50 @@
+/*
+recovery.c (System API Module example).
+Collection with retries, backoff and backup data.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    struct os api_data, backup_data;
+    struct recovery_ctx ctx;
+    struct curl_handle_pool pool;
+    
+    // Setup fallback data
+    backup_data.apimodel = 1;
+    backup_data.system = 1;
+    strcpy(backup_data.osname, "Lumen");
+    
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    
+    // Initialize recovery system FIRST
+    if (init_recovery_ctx(&ctx, &backup_data) != API_SUCCESS) {
+        fprintf(stderr, "CRITICAL: Recovery init failed\n");
+        curl_global_cleanup();
+        return 1;
+    }
+    
+    // Keep handles warm across retries and endpoints
+    if (init_handle_pool(&pool) == API_SUCCESS) {
+        ctx.pool = &pool;
+    }
+    
+    // Initialize main data from backup
+    init_api_struct(&api_data, &backup_data);
+    
+    printf("🚀 Starting API collection with recovery...\n");
+    int status = collect_api_data_with_recovery(&api_data, "http://localhost:8080/api/system-info", &ctx, NULL);
+    
+    print_recovery_status(&api_data, status, &ctx);
+    print_pool_stats(ctx.pool);
+    print_retry_budget();
+    
+    destroy_handle_pool(ctx.pool);
+    curl_global_cleanup();
+    return (status == API_SUCCESS) ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/*
+scheduled.c (System API Module example).
+Non-blocking collection on the retry wheel.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+
+int main() {
+    struct os api_data, backup_data;
+    struct recovery_ctx ctx;
+    struct auth_config auth;
+    struct curl_handle_pool pool;
+    struct retry_wheel wheel;
+    struct collect_job job;
+    
+    backup_data.apimodel = 1;
+    backup_data.system = 1;
+    strcpy(backup_data.osname, "Lumen");
+    
+    init_auth_config(&auth, "apiuser", "apipass");
+    
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    
+    init_recovery_ctx(&ctx, &backup_data);
+    init_api_struct(&api_data, &backup_data);
+    if (init_handle_pool(&pool) == API_SUCCESS) {
+        ctx.pool = &pool;
+    }
+    init_retry_wheel(&wheel);
+    
+    submit_collect_job(&wheel, &job, &api_data, &ctx, &auth, NULL);
+    
+    // Event loop: the thread is free while attempts are in flight and between them
+    unsigned long idle_ticks = 0;
+    while (!job.done) {
+        if (retry_wheel_poll(&wheel, 50) == 0) {
+            idle_ticks++;  // Other work would run here
+        }
+    }
+    
+    printf("Loop stayed responsive for %lu idle ticks while retrying\n", idle_ticks);
+    print_recovery_status(&api_data, job.status, &ctx);
+    print_retry_budget();
+    print_pool_stats(ctx.pool);
+    destroy_retry_wheel(&wheel);
+    destroy_handle_pool(ctx.pool);
+    curl_global_cleanup();
+    return (job.status == API_SUCCESS) ? 0 : 1;
+}
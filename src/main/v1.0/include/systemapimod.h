@@ -0,0 +1,874 @@
+/*
+systemapimod.h (System API Module).
+Public types and functions of libsystemapimod.
+*/
+
+#ifndef SYSTEMAPIMOD_H
+#define SYSTEMAPIMOD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <curl/curl.h>
+
+// ---- Device profile ----
+// Build-time tuning target; SIMD paths are still picked at runtime.
+// Armv7-A builds default to the Moto Nexus 6 profile (Lumen OS), every
+// other target to the generic one. Force either with -DLUMEN_PROFILE_NEXUS6
+// or -DLUMEN_PROFILE_GENERIC.
+#if !defined(LUMEN_PROFILE_NEXUS6) && !defined(LUMEN_PROFILE_GENERIC)
+#if defined(__arm__) && defined(__ARM_ARCH_7A__)
+#define LUMEN_PROFILE_NEXUS6 1
+#else
+#define LUMEN_PROFILE_GENERIC 1
+#endif
+#endif
+
+#ifdef LUMEN_PROFILE_NEXUS6
+#define LUMEN_PROFILE_NAME "nexus6"
+#define LUMEN_DEVICE_NAME "Moto Nexus 6"
+#else
+#define LUMEN_PROFILE_NAME "generic"
+#define LUMEN_DEVICE_NAME "Generic Linux"
+#endif
+
+// ---- Module types ----
+// API Module struct
+struct os {
+    int apimodel;
+    int system;
+    char osname[100];
+};
+
+// Error codes shared by every collector
+enum API_ERROR {
+    API_SUCCESS = 0,
+    API_MEM_ERROR = -1,
+    API_CURL_INIT_ERROR = -2,
+    API_NETWORK_ERROR = -3,
+    API_JSON_PARSE_ERROR = -4,
+    API_STRUCT_INIT_ERROR = -5,
+    API_AUTH_ERROR = -6,        // Authentication failure
+    API_RECOVERY_SUCCESS = 10,  // Recovery completed
+    API_MAX_RETRIES = -99       // Max retries exceeded
+};
+
+// ---- CPU features ----
+#define LUMEN_CPU_SSE2 0x1
+#define LUMEN_CPU_AVX2 0x2
+#define LUMEN_CPU_NEON 0x4
+
+unsigned int lumen_cpu_features(void);
+void lumen_cpu_restrict(unsigned int mask);
+
+// ---- Slab allocator ----
+#ifdef LUMEN_USE_MALLOC
+#define lumen_slab_alloc(size) malloc(size)
+#define lumen_slab_calloc(count, size) calloc((count), (size))
+#define lumen_slab_free(ptr) free(ptr)
+#else
+void* lumen_slab_alloc(size_t size);
+void* lumen_slab_calloc(size_t count, size_t size);
+void lumen_slab_free(void* ptr);
+#endif
+void print_lumen_slab_stats(void);
+
+// ---- Allocation telemetry ----
+#define LUMEN_TELEMETRY_BUCKETS 32
+
+#define LUMEN_TELEMETRY_TEXT 0
+#define LUMEN_TELEMETRY_JSON 1
+
+enum lumen_alloc_site {
+    LUMEN_SITE_MEMBLOCK,
+    LUMEN_SITE_MEMBLOCK_DATA,
+    LUMEN_SITE_ALLOC_UNIT,
+    LUMEN_SITE_ALLOC_UNIT_VALUES,
+    LUMEN_SITE_FREE_MANAGER,
+    LUMEN_SITE_FREE_MANAGER_MEM,
+    LUMEN_SITE_PACKED_BLOCK,
+    LUMEN_SITE_PACKED_UNIT,
+    LUMEN_SITE_COUNT
+};
+
+typedef struct {
+    unsigned long allocs;
+    unsigned long frees;
+    unsigned long bytes_allocated;
+    unsigned long bytes_freed;
+} LumenSiteCounters;
+
+typedef struct {
+    LumenSiteCounters sites[LUMEN_SITE_COUNT];
+    unsigned long size_hist[LUMEN_TELEMETRY_BUCKETS];      // Bucket b: sizes in [2^(b-1), 2^b)
+    unsigned long lifetime_hist[LUMEN_TELEMETRY_BUCKETS];  // Same, in microseconds (sampled)
+    long long live_bytes;
+    long long peak_bytes;
+    int threads;    // Counter slots: the most threads registered at once
+} LumenTelemetrySnapshot;
+
+#ifdef LUMEN_NO_TELEMETRY
+#define lumen_mem_alloc(site, size) lumen_slab_alloc(size)
+#define lumen_mem_calloc(site, count, size) lumen_slab_calloc((count), (size))
+#define lumen_mem_free(ptr) lumen_slab_free(ptr)
+#define lumen_telemetry_note_alloc(site, size) 0u
+#define lumen_telemetry_note_free(site, size, born_us) ((void)(born_us))
+#else
+uint32_t lumen_telemetry_note_alloc(int site, size_t size);
+void lumen_telemetry_note_free(int site, size_t size, uint32_t born_us);
+void* lumen_mem_alloc(int site, size_t size);
+void* lumen_mem_calloc(int site, size_t count, size_t size);
+void lumen_mem_free(void* ptr);
+#endif
+int lumen_telemetry_snapshot(LumenTelemetrySnapshot* out);
+int lumen_telemetry_dump(FILE* out, int format);
+
+// ---- Malloc! ----
+// Custom struct for memory management in Lumen environment
+typedef struct {
+    size_t block_size;
+    int *data_ptr;
+    char device_info[64];
+} LumenMemBlock;
+
+LumenMemBlock* lumen_alloc_init(size_t num_elements);
+void lumen_set_value(LumenMemBlock* mem, size_t offset, int value);
+void lumen_print_value(LumenMemBlock* mem, size_t offset);
+void lumen_free_block(LumenMemBlock* mem);
+
+// ---- Calloc ----
+// Enhanced struct for calloc-based allocation in Lumen context
+typedef struct {
+    size_t alloc_count;
+    double *values;  // Changed to double for variety
+    char platform_tag[128];
+} LumenAllocUnit;
+
+LumenAllocUnit* init_lumen_alloc(size_t elements);
+void assign_lumen_value(LumenAllocUnit* unit, size_t idx, double val);
+void display_lumen_value(LumenAllocUnit* unit, size_t idx);
+void release_lumen_unit(LumenAllocUnit* unit);
+
+// ---- Free ----
+// Struct for managing freed memory in Lumen context
+typedef struct {
+    size_t freed_size;
+    void *mem_ptr;
+    char hardware_label[96];
+    int status_code;
+} LumenFreeManager;
+
+LumenFreeManager* setup_lumen_manager(size_t alloc_bytes);
+void execute_lumen_free(LumenFreeManager* manager);
+void log_lumen_status(LumenFreeManager* manager);
+void destroy_lumen_manager(LumenFreeManager* manager);
+
+// ---- Timestamps ----
+#define LUMEN_TS_SECONDS 0
+#define LUMEN_TS_MILLIS 3
+#define LUMEN_TS_MICROS 6
+
+void lumen_clock_now(time_t* sec, long* nsec);
+size_t lumen_format_timestamp(time_t sec, long nsec, int precision, char* out, size_t out_size);
+unsigned long lumen_timestamp_conversions(void);
+
+// ---- Packed blocks ----
+#define LUMEN_CACHE_LINE 64
+
+typedef struct {
+    size_t block_size;
+    const char* device_info;  // Interned, never freed
+    uint32_t born_us;         // Telemetry birth stamp (header padding)
+    _Alignas(LUMEN_CACHE_LINE) int data_ptr[];
+} LumenPackedBlock;
+
+typedef struct {
+    size_t alloc_count;
+    const char* platform_tag;  // Interned, never freed
+    uint32_t born_us;          // Telemetry birth stamp (header padding)
+    _Alignas(LUMEN_CACHE_LINE) double values[];
+} LumenPackedUnit;
+
+const char* lumen_intern_tag(const char* tag);
+LumenPackedBlock* lumen_packed_alloc(size_t num_elements);
+void lumen_packed_set_value(LumenPackedBlock* mem, size_t offset, int value);
+void lumen_packed_print_value(LumenPackedBlock* mem, size_t offset);
+void lumen_packed_free(LumenPackedBlock* mem);
+LumenPackedUnit* init_lumen_packed_unit(size_t elements);
+void assign_lumen_packed_value(LumenPackedUnit* unit, size_t idx, double val);
+void release_lumen_packed_unit(LumenPackedUnit* unit);
+
+// ---- Block kernels ----
+const char* lumen_block_kernel_name(void);
+int lumen_fill_range(LumenMemBlock* mem, size_t offset, size_t count, int value);
+int lumen_copy_range(LumenMemBlock* dst, size_t dst_offset, const LumenMemBlock* src,
+                     size_t src_offset, size_t count);
+int lumen_scale_offset_range(LumenMemBlock* mem, size_t offset, size_t count, int scale, int bias);
+int lumen_compare_range(const LumenMemBlock* a, size_t a_offset, const LumenMemBlock* b,
+                        size_t b_offset, size_t count, size_t* first_diff);
+
+// ---- Unit reductions ----
+typedef struct {
+    size_t count;
+    double sum;
+    double min;
+    double max;
+    double mean;
+    double variance;  // Population variance
+} LumenUnitStats;
+
+const char* lumen_reduce_kernel_name(void);
+int lumen_unit_stats_range(const LumenAllocUnit* unit, size_t offset, size_t count,
+                           int threads, LumenUnitStats* out);
+int lumen_unit_stats(const LumenAllocUnit* unit, LumenUnitStats* out);
+
+// ---- Logging ----
+// Struct for logging operations in Lumen environment
+typedef struct {
+    char log_buffer[512];
+    char device_marker[128];
+    int log_level;
+    time_t timestamp;
+    int status_flag;
+    int time_precision;  // LUMEN_TS_*: 0 stamps with timestamp, >0 with the current time
+} LumenLogHandler;
+
+LumenLogHandler* create_lumen_logger(int level);
+void record_lumen_log(LumenLogHandler* handler, const char* message, int level);
+void output_lumen_log(LumenLogHandler* handler);
+void release_lumen_logger(LumenLogHandler* handler);
+
+// ---- Async logging ----
+// Queued messages are cut at LUMEN_ASYNC_MSG_MAX - 1 bytes, shorter than the
+// sync path's 512-byte line; print_lumen_async_stats counts the cut ones.
+#define LUMEN_ASYNC_MSG_MAX 192
+#define LUMEN_LOG_OVERFLOW_DROP 0   // Full ring: count and discard the record
+#define LUMEN_LOG_OVERFLOW_BLOCK 1  // Full ring: producer sleeps until the writer frees a cell
+
+int lumen_async_log_submit(time_t timestamp, long nsec, int precision, int level, const char* message);
+int lumen_async_log_start(size_t capacity, int overflow_policy, FILE* sink);
+void lumen_async_log_stop(void);
+void print_lumen_async_stats(void);
+
+// ---- Binary logging ----
+#define LUMEN_BINLOG_MAX_FORMATS 256
+#define LUMEN_BINLOG_MAX_ARGS 16
+
+typedef struct {
+    const char* format;
+    char signature[LUMEN_BINLOG_MAX_ARGS + 1];
+} LumenBinFormat;
+
+typedef struct {
+    FILE* file;
+    LumenBinFormat formats[LUMEN_BINLOG_MAX_FORMATS];
+    int format_count;
+    int log_level;
+    int time_precision;
+    atomic_ulong records;
+    atomic_ulong bytes;
+    atomic_ulong truncated;   // Records whose string arguments were cut to fit
+    atomic_ulong dropped;     // Records that could not be written
+} LumenBinLogger;
+
+int lumen_binlog_register(LumenBinLogger* log, const char* format);
+LumenBinLogger* create_lumen_binlog(const char* path, int level);
+int lumen_binlog_write(LumenBinLogger* log, int format_id, int level, ...);
+int lumen_binlog_submit(time_t timestamp, long nsec, int precision, int level, const char* message);
+void lumen_binlog_attach(LumenBinLogger* log);
+void release_lumen_binlog(LumenBinLogger* log);
+int lumen_binlog_decode(FILE* in, FILE* out);
+void print_lumen_binlog_stats(LumenBinLogger* log);
+
+// ---- Request arena ----
+#define API_ARENA_ALIGN 16
+
+struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;
+    size_t used;
+    _Alignas(API_ARENA_ALIGN) unsigned char data[];
+};
+
+struct request_arena {
+    struct arena_chunk *chunks;
+    struct arena_chunk *current;
+    int depth;                    // Nested enter() calls
+    size_t used;
+    size_t peak_used;
+    unsigned long chunk_allocs;
+    unsigned long resets;
+};
+
+void *arena_alloc(struct request_arena *arena, size_t size);
+int arena_extend(struct request_arena *arena, void *ptr, size_t old_size, size_t new_size);
+int arena_owns(const struct request_arena *arena, const void *ptr);
+void arena_reset(struct request_arena *arena);
+void arena_destroy(struct request_arena *arena);
+// Between enter and the outermost leave, cJSON nodes, response buffers and
+// arena_slist_append nodes of this thread come from its arena. None of them
+// may outlive the request or be freed on another thread.
+struct request_arena *request_arena_enter(void);
+void request_arena_leave(void);
+struct curl_slist *arena_slist_append(struct curl_slist *list, const char *line);
+void arena_slist_free(struct curl_slist *list);
+void print_arena_stats(void);
+
+// ---- Response buffers ----
+struct response_buffer {
+    char *data;
+    size_t size;
+    size_t capacity;
+    size_t expected_size;  // Content-Length when the server sent one, else 0
+    char etag[128];        // Validators for conditional requests ("" if absent)
+    char last_modified[64];
+    int arena_backed;      // Storage belongs to the request arena
+    struct response_buffer *next_free;
+};
+
+int response_buffer_reserve(struct response_buffer *buf, size_t needed);
+struct response_buffer *acquire_response_buffer(void);
+void release_response_buffer(struct response_buffer *buf);
+void drain_response_buffers(void);
+void attach_response_buffer(CURL *curl, struct response_buffer *buf);
+
+// ---- Streaming extraction ----
+#define SYSINFO_FIELD_APIMODEL 0x1
+#define SYSINFO_FIELD_SYSTEM   0x2
+#define SYSINFO_FIELD_OSNAME   0x4
+#define SYSINFO_FIELD_ALL      0x7
+#define SYSINFO_MAX_DEPTH 64
+#define SYSINFO_TOKEN_MAX 32
+
+enum sysinfo_scan_result {
+    SYSINFO_SCAN_MORE = 0,        // Need more input
+    SYSINFO_SCAN_COMPLETE = 1,    // Document ended; found says which fields it held
+    SYSINFO_SCAN_MALFORMED = -1   // Use the cJSON fallback
+};
+
+enum sysinfo_scan_state {
+    SX_VALUE,
+    SX_KEY,
+    SX_COLON,
+    SX_AFTER_VALUE,
+    SX_STRING,
+    SX_STRING_ESCAPE,
+    SX_NUMBER,
+    SX_LITERAL,
+    SX_END
+};
+
+struct sysinfo_extractor {
+    struct os *out;
+    unsigned long long array_bits;   // Bit d set: container at depth d+1 is an array
+    int depth;
+    int state;
+    int allow_close;                 // Right after '{' or '[' the closing bracket is legal
+    int string_is_key;
+    int field;                       // Field the current value feeds, 0 = ignored
+    char token[SYSINFO_TOKEN_MAX];   // Key, number or literal text
+    int token_len;                   // SYSINFO_TOKEN_MAX means "too long to matter"
+    size_t osname_len;
+    unsigned int seen;               // First occurrence of each key wins, like cJSON_GetObjectItem
+    unsigned int found;
+    unsigned int wanted;             // Fields to store; the others are only syntax-checked
+    int result;
+};
+
+// Write target that runs the extractor while keeping the raw body for the fallback
+struct streaming_sink {
+    struct response_buffer *buf;
+    struct sysinfo_extractor ex;
+    struct os fields;
+    int bulk_scan;  // Large body: buffer only, run the SIMD scanner once it is complete
+};
+
+void sysinfo_extractor_init(struct sysinfo_extractor *ex, struct os *out, unsigned int wanted);
+int sysinfo_extractor_feed(struct sysinfo_extractor *ex, const char *data, size_t len);
+int sysinfo_extractor_finish(struct sysinfo_extractor *ex);
+void attach_streaming_sink(CURL *curl, struct streaming_sink *sink, struct response_buffer *buf);
+
+// ---- SIMD key scanner ----
+int sysinfo_scan_buffer(const char *data, size_t len, struct os *out, unsigned int *found);
+
+// ---- Error handling ----
+int init_api_struct(struct os *api_data, const struct os *backup);
+int collect_api_data(struct os *api_data, const char *api_url);
+void print_api_data(const struct os *api_data, int status);
+
+// ---- Connection pool ----
+#define API_POOL_MAX_ENDPOINTS 8
+#define API_POOL_HANDLES_PER_ENDPOINT 4
+#define API_POOL_URL_MAX 256
+
+// Idle handles parked for one endpoint
+struct pool_endpoint {
+    char url[API_POOL_URL_MAX];
+    CURL *idle[API_POOL_HANDLES_PER_ENDPOINT];
+    int idle_count;
+    unsigned long transfers;
+    unsigned long reused_connections;
+};
+
+// Pool of warm curl easy handles, keyed by endpoint URL.
+// A handle handed back to the pool keeps its connection cache, so the next
+// attempt against the same endpoint skips DNS, TCP and TLS setup.
+// Safe to share between threads; connections stay with their handle, only
+// the DNS and TLS session caches are shared.
+struct curl_handle_pool {
+    struct pool_endpoint endpoints[API_POOL_MAX_ENDPOINTS];
+    int endpoint_count;
+    CURLSH *share;                    // DNS + TLS session cache shared by all handles
+    pthread_mutex_t lock;             // Idle lists and counters
+    pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];  // Lock callbacks for share
+    unsigned long handles_created;
+    unsigned long handles_reused;
+    unsigned long handles_discarded;
+    unsigned long connections_opened;
+    unsigned long connections_reused;
+};
+
+int init_handle_pool(struct curl_handle_pool *pool);
+CURL *pool_acquire_handle(struct curl_handle_pool *pool, const char *url);
+void pool_record_transfer(struct curl_handle_pool *pool, const char *url, CURL *curl);
+void pool_release_handle(struct curl_handle_pool *pool, const char *url, CURL *curl);
+void destroy_handle_pool(struct curl_handle_pool *pool);
+void print_pool_stats(struct curl_handle_pool *pool);
+
+// ---- Retry scheduler ----
+#define RETRY_WHEEL_SLOTS 256
+#define RETRY_WHEEL_TICK_MS 10
+
+typedef void (*retry_fn)(void *arg);
+
+// Intrusive timer; the owner embeds it, so scheduling never allocates
+struct retry_timer {
+    struct retry_timer *next;
+    unsigned long long expires_tick;
+    retry_fn fn;
+    void *arg;
+    int armed;
+};
+
+struct retry_wheel {
+    struct retry_timer *slots[RETRY_WHEEL_SLOTS];
+    unsigned long long current_tick;
+    long long origin_us;
+    int pending;
+    CURLM *multi;                   // Transfers of scheduled collections, created on first use
+    int transfers;                  // In flight on multi
+};
+
+#define API_RETRY_BASE_MS 100
+#define API_RETRY_CAP_MS 4000
+
+// Decorrelated jitter: next = min(cap, random(base, prev * 3)).
+// Spreads retries from many clients instead of lining them up on 1s/2s/4s.
+struct retry_backoff {
+    long base_ms;
+    long cap_ms;
+    long prev_ms;
+    unsigned int seed;
+};
+
+int init_retry_wheel(struct retry_wheel *wheel);
+void destroy_retry_wheel(struct retry_wheel *wheel);
+int retry_wheel_schedule(struct retry_wheel *wheel, struct retry_timer *timer,
+                         long delay_ms, retry_fn fn, void *arg);
+int retry_wheel_advance(struct retry_wheel *wheel);
+long retry_wheel_next_delay_ms(const struct retry_wheel *wheel);
+int retry_wheel_poll(struct retry_wheel *wheel, long max_wait_ms);
+int retry_wheel_perform(struct retry_wheel *wheel);
+void init_retry_backoff(struct retry_backoff *backoff, long base_ms, long cap_ms);
+long retry_backoff_next(struct retry_backoff *backoff);
+void configure_retry_budget(double ratio, double min_per_sec, double max_tokens);
+void retry_budget_on_request(void);
+int retry_budget_try_spend(void);
+void print_retry_budget(void);
+
+// ---- Adaptive timeouts ----
+// Per-attempt timeout = multiplier x the endpoint's streaming p99 estimate,
+// clamped to [floor_ms, ceiling_ms], then grown by retry_multiplier for each
+// retry (still capped at ceiling_ms). Endpoints with fewer than
+// API_LATENCY_MIN_SAMPLES samples, or adaptive = 0, get the fixed timeout
+// fixed_ms on every try. No attempt ever waits longer than ceiling_ms.
+#define API_TIMEOUT_QUANTILE 0.99
+#define API_TIMEOUT_MULTIPLIER 4.0
+#define API_TIMEOUT_RETRY_MULTIPLIER 2.0
+#define API_TIMEOUT_CEILING_MS 10000
+#define API_TIMEOUT_FIXED_MS 10000
+#define API_CONNECT_TIMEOUT_MS 5000
+#ifndef API_TIMEOUT_FLOOR_MS
+#ifdef LUMEN_PROFILE_NEXUS6
+#define API_TIMEOUT_FLOOR_MS 250    // Radio wake-up and a slower scheduler
+#else
+#define API_TIMEOUT_FLOOR_MS 50
+#endif
+#endif
+
+struct timeout_policy {
+    int adaptive;                 // 0 = fixed timeouts
+    double multiplier;            // Headroom over the p99 estimate
+    double retry_multiplier;      // Growth per retry
+    long floor_ms;
+    long ceiling_ms;              // Hard cap, adaptive or not
+    long fixed_ms;                // Every attempt when not adapting
+    long connect_ms;              // Connect phase cap, never above the total
+};
+
+void init_timeout_policy(struct timeout_policy *policy);
+
+// ---- Recovery ----
+// Recovery context: per-call state, one per thread (or per engine task)
+struct recovery_ctx {
+    int retry_count;
+    int max_retries;
+    struct os backup_data;
+    int recovery_active;              // Set while a transfer runs, guards re-entry
+    struct curl_handle_pool *pool;  // Optional warm handles, NULL = fresh handle per attempt
+    struct endpoint_registry *endpoints;  // Optional per-endpoint latency stats
+    struct timeout_policy timeouts;   // Needs endpoints to adapt
+};
+
+// Auth credentials structure
+struct auth_config {
+    char username[64];
+    char password[64];
+    char bearer_token[256];
+    int use_basic_auth;
+    int use_bearer_auth;
+};
+
+int init_recovery_ctx(struct recovery_ctx *ctx, struct os *backup);
+// Blocking: the calling thread sleeps through the backoff between retries.
+// submit_collect_job runs the same policy on a retry_wheel without sleeping.
+int collect_api_data_with_recovery(struct os *api_data, const char *api_url,
+                                  struct recovery_ctx *ctx, const struct auth_config *auth);
+void print_recovery_status(const struct os *data, int status, const struct recovery_ctx *ctx);
+int init_auth_config(struct auth_config *auth, const char *username, const char *password);
+int set_bearer_token(struct auth_config *auth, const char *token);
+
+// ---- Circuit breaker ----
+// Per endpoint: closed (normal), open (requests skipped until the cool-down
+// ends) and half-open (one trial request decides between the two).
+#define API_BREAKER_CLOSED 0
+#define API_BREAKER_OPEN 1
+#define API_BREAKER_HALF_OPEN 2
+#define API_BREAKER_FAILURE_THRESHOLD 5   // Consecutive failures that open it
+#define API_BREAKER_OPEN_MS 5000          // Cool-down before the trial request
+
+struct endpoint_breaker {
+    int state;
+    int consecutive_failures;
+    long long opened_us;                  // Last transition to open
+    long long probe_started_us;           // Half-open trial in flight since, 0 = none
+    unsigned long opens;                  // Transition counts
+    unsigned long half_opens;
+    unsigned long closes;
+    unsigned long rejected;               // Requests skipped while open
+};
+
+const char *endpoint_breaker_state_name(int state);
+
+// ---- Endpoint latency stats ----
+#define API_LATENCY_WINDOW 128
+#define API_LATENCY_MIN_SAMPLES 8
+
+struct endpoint_stats {
+    char url[API_POOL_URL_MAX];
+    struct endpoint_breaker breaker;
+    long long samples_us[API_LATENCY_WINDOW];
+    int sample_count;
+    int sample_next;
+    long long p95_us;        // Cached, refreshed lazily when new samples arrive
+    int p95_dirty;
+    long long last_us;
+    unsigned long successes;
+    unsigned long failures;
+    double ewma_latency_us;       // Valid once sample_count > 0
+    double ewma_error_rate;       // 0..1, valid once an outcome was recorded
+    double tail_us;               // Streaming API_TIMEOUT_QUANTILE estimate
+    double tail_step_us;          // Its step size, an EWMA of the deviation
+    unsigned long tail_samples;   // Includes timed-out attempts
+    unsigned long timeouts;
+};
+
+// Shared table of per-endpoint stats, fed by the collectors. Thread-safe.
+struct endpoint_registry {
+    struct endpoint_stats endpoints[API_POOL_MAX_ENDPOINTS];
+    int endpoint_count;
+    int breaker_threshold;            // API_BREAKER_FAILURE_THRESHOLD by default
+    long breaker_open_ms;             // API_BREAKER_OPEN_MS by default
+    char endpoint_urls[API_POOL_MAX_ENDPOINTS][API_POOL_URL_MAX];  // Runtime list, empty = defaults
+    int endpoint_url_count;
+    int selection;                    // API_SELECT_*
+    unsigned int seed;                // Power-of-two-choices picks
+    pthread_mutex_t lock;
+};
+
+// Read-only view returned to callers
+struct latency_snapshot {
+    int samples;
+    long long p50_us;
+    long long p95_us;
+    long long p99_us;
+    long long max_us;
+    long long last_us;
+    unsigned long successes;
+    unsigned long failures;
+    double ewma_latency_us;
+    double ewma_error_rate;
+    double score;                 // Lower is better, see endpoint_score()
+    long long tail_us;            // Streaming p99 estimate, -1 until warmed up
+    unsigned long timeouts;
+};
+
+int init_endpoint_registry(struct endpoint_registry *reg);
+void record_endpoint_latency(struct endpoint_registry *reg, const char *url, long long latency_us);
+void record_endpoint_outcome(struct endpoint_registry *reg, const char *url, int success);
+void record_endpoint_result(struct endpoint_registry *reg, const char *url, int status);
+void record_endpoint_timeout(struct endpoint_registry *reg, const char *url, long long elapsed_us);
+void record_endpoint_cancelled(struct endpoint_registry *reg, const char *url, long long elapsed_us);
+long long endpoint_p95_us(struct endpoint_registry *reg, const char *url);
+long endpoint_timeout_ms(struct endpoint_registry *reg, const char *url,
+                         const struct timeout_policy *policy, int retry);
+int get_endpoint_latency_stats(struct endpoint_registry *reg, const char *url, struct latency_snapshot *out);
+void print_endpoint_stats(struct endpoint_registry *reg);
+void configure_endpoint_breaker(struct endpoint_registry *reg, int failure_threshold, long open_ms);
+int endpoint_allow_request(struct endpoint_registry *reg, const char *url);
+void endpoint_cancel_request(struct endpoint_registry *reg, const char *url, long long started_us);
+int get_endpoint_breaker(struct endpoint_registry *reg, const char *url, struct endpoint_breaker *out);
+
+// ---- Endpoint selection ----
+// Collectors try endpoints in the order of an endpoint_plan: the caller's
+// primary URL plus the registry's list (or the built-in defaults), ranked
+// by an EWMA of latency inflated by the EWMA error rate.
+#define API_SELECT_ORDERED 0          // List order, primary first
+#define API_SELECT_SCORE 1            // Lowest score first (default)
+#define API_SELECT_P2C 2              // Better of two random picks first, rest by score
+#define API_EWMA_ALPHA 0.2
+#define API_EWMA_ERROR_PENALTY 10.0   // 10% errors doubles the score
+#define API_EWMA_UNKNOWN_US 100000.0  // Assumed latency of an endpoint that has only failed
+
+struct endpoint_plan {
+    int count;
+    char urls[API_POOL_MAX_ENDPOINTS][API_POOL_URL_MAX];
+};
+
+int set_registry_endpoints(struct endpoint_registry *reg, const char *const *urls, int count);
+void configure_endpoint_selection(struct endpoint_registry *reg, int mode);
+double endpoint_score(struct endpoint_registry *reg, const char *url);
+int plan_endpoints(struct endpoint_registry *reg, const char *primary, struct endpoint_plan *plan);
+
+// ---- Latency histogram ----
+// HDR-style log-linear histogram of microsecond values: exact below 256us,
+// within 1/128 (0.8%) above that, clamped at API_HIST_MAX_US. Fixed size,
+// so per-thread copies can be recorded without locks and merged at the end.
+#define API_HIST_SUB_BITS 8
+#define API_HIST_MAX_US ((1LL << 32) - 1)   // About 71 minutes
+#define API_HIST_BUCKETS ((1 << API_HIST_SUB_BITS) + (32 - API_HIST_SUB_BITS) * (1 << (API_HIST_SUB_BITS - 1)))
+
+struct latency_histogram {
+    unsigned long long counts[API_HIST_BUCKETS];
+    unsigned long long total;
+    long long min_us;
+    long long max_us;
+    double sum_us;
+};
+
+void init_latency_histogram(struct latency_histogram *hist);
+void latency_histogram_record(struct latency_histogram *hist, long long value_us);
+void latency_histogram_merge(struct latency_histogram *dst, const struct latency_histogram *src);
+long long latency_histogram_percentile(const struct latency_histogram *hist, double percentile);
+double latency_histogram_mean(const struct latency_histogram *hist);
+
+// ---- Concurrent collection ----
+int collect_api_data_concurrent(struct os *api_data, struct recovery_ctx *ctx,
+                                const struct auth_config *auth);
+
+// ---- Hedged collection ----
+int collect_api_data_hedged(struct os *api_data, struct recovery_ctx *ctx,
+                            const struct auth_config *auth);
+
+// ---- Scheduled collection ----
+// Non-blocking collection job. Attempts are transfers on the wheel's multi
+// handle and the backoff between them is parked in the wheel instead of
+// sleep(), so the calling thread keeps serving other work while a collection
+// is in flight or retrying.
+struct collect_job {
+    struct os *api_data;
+    struct recovery_ctx *ctx;
+    const struct auth_config *auth;
+    struct retry_wheel *wheel;
+    struct retry_timer timer;
+    struct retry_backoff backoff;
+    struct endpoint_plan plan;      // Fixed at submit time
+    int url_idx;
+    int retry_count;
+    CURL *curl;                     // Current attempt, NULL between attempts
+    struct response_buffer *chunk;
+    struct curl_slist *headers;
+    long long started_us;
+    int status;
+    int done;
+    void (*on_done)(struct collect_job *job);
+    void *user_data;
+};
+
+int submit_collect_job(struct retry_wheel *wheel, struct collect_job *job,
+                       struct os *api_data, struct recovery_ctx *ctx,
+                       const struct auth_config *auth, void (*on_done)(struct collect_job *job));
+
+// ---- Response cache ----
+#define API_CACHE_SLOTS 32
+#define API_CACHE_DEFAULT_TTL_MS 1000
+
+struct cache_entry {
+    char url[API_POOL_URL_MAX];
+    unsigned long long auth_id;   // Hash of the credentials, the secrets themselves are not kept
+    struct os data;
+    char etag[128];
+    char last_modified[64];
+    long long expires_us;
+    long long last_used_us;
+    int valid;
+};
+
+struct response_cache {
+    struct cache_entry entries[API_CACHE_SLOTS];
+    pthread_mutex_t lock;           // Entries and counters, not held during transfers
+    long ttl_ms;
+    struct curl_handle_pool *pool;  // Optional warm handles for misses
+    struct endpoint_registry *endpoints;  // Optional, feeds adaptive timeouts
+    struct timeout_policy timeouts;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long revalidations;    // Conditional requests sent
+    unsigned long not_modified;     // ...answered with 304
+    unsigned long refreshes;        // Full 200 bodies fetched and parsed
+};
+
+int init_response_cache(struct response_cache *cache, long ttl_ms);
+unsigned long long auth_identity_hash(const struct auth_config *auth);
+int collect_api_data_cached(struct response_cache *cache, struct os *api_data,
+                            const char *api_url, const struct auth_config *auth);
+void invalidate_response_cache(struct response_cache *cache);
+void print_cache_stats(const struct response_cache *cache);
+
+// ---- Collection engine ----
+// Worker threads running collection jobs in parallel. Each task gets its own
+// recovery state and each worker its own handle pool; the endpoint registry
+// and retry budget are shared between the workers. Tasks run the blocking
+// recovery collector, so a worker sleeps through each retry backoff and
+// takes no other task meanwhile.
+#ifndef API_ENGINE_MAX_WORKERS
+#ifdef LUMEN_PROFILE_NEXUS6
+#define API_ENGINE_MAX_WORKERS 8    // Four cores, room for workers blocked on I/O
+#else
+#define API_ENGINE_MAX_WORKERS 64
+#endif
+#endif
+
+// Owned by the caller until on_done has run (or collect_engine_wait returns)
+struct collect_task {
+    const char *url;                    // Primary endpoint, NULL = default list only
+    const struct auth_config *auth;     // Optional
+    struct os data;                     // Result, backup data if every endpoint failed
+    int status;                         // API_* once done
+    int retries;                        // Retries spent on the last endpoint tried
+    long long queued_us;                // Time spent waiting for a worker
+    long long latency_us;               // Submit to completion
+    void (*on_done)(struct collect_task *task);  // Runs on the worker thread
+    void *user_data;
+    struct collect_task *next;          // Queue link, engine-owned
+    long long submitted_us;
+};
+
+// One worker thread and the warm handles only it uses
+struct collect_engine_worker {
+    pthread_t thread;
+    struct collect_engine *engine;
+    struct curl_handle_pool pool;
+};
+
+struct collect_engine {
+    struct collect_engine_worker workers[API_ENGINE_MAX_WORKERS];
+    int worker_count;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t all_done;
+    struct collect_task *head;
+    struct collect_task *tail;
+    int queued;
+    int running;
+    int stopping;
+    struct os backup_data;
+    int max_retries;
+    struct timeout_policy timeouts;     // Copied into every task's recovery state
+    struct endpoint_registry endpoints;
+    unsigned long submitted;
+    unsigned long completed;
+    unsigned long succeeded;
+    unsigned long recovered;            // Served from backup data
+    unsigned long failed;
+};
+
+int start_collect_engine(struct collect_engine *engine, int workers, const struct os *backup);
+int collect_engine_submit(struct collect_engine *engine, struct collect_task *task);
+int collect_engine_submit_batch(struct collect_engine *engine, struct collect_task *tasks, int count);
+void collect_engine_wait(struct collect_engine *engine);
+void stop_collect_engine(struct collect_engine *engine);
+void print_engine_stats(struct collect_engine *engine);
+
+// ---- Mock server ----
+// Local stand-in for the Lumen API on 127.0.0.1, for load and fault testing
+// without a network. Serves /api/system-info and /api/system.
+#define MOCK_MAX_WORKERS 32
+#define MOCK_BODY_MAX 4096
+
+// Per-request fault rates in percent, rolled in this order
+struct mock_faults {
+    int drop_pct;          // Close the connection without answering
+    int unauthorized_pct;  // 401 even with valid credentials
+    int server_error_pct;  // 500, 502 or 503
+    int truncate_pct;      // Full Content-Length, half the body, then close
+    int latency_ms;        // Delay before every answer
+    int jitter_ms;         // Plus a uniform 0..jitter_ms
+};
+
+struct mock_server_config {
+    unsigned short port;      // 0 = any free port, see mock_server_url()
+    int workers;              // Connections served at once, 1..MOCK_MAX_WORKERS
+    struct os info;           // Served as {"apimodel":..,"system":..,"osname":..}
+    const char *body;         // Raw body served instead of info (NULL = use info)
+    struct auth_config auth;  // Credentials required, neither flag set = open
+    struct mock_faults faults;
+};
+
+struct mock_stats {
+    unsigned long connections;
+    unsigned long requests;
+    unsigned long ok;
+    unsigned long not_modified;   // 304 for a matching If-None-Match
+    unsigned long unauthorized;   // Injected or bad/missing credentials
+    unsigned long server_errors;
+    unsigned long truncated;
+    unsigned long dropped;
+    unsigned long not_found;
+};
+
+struct mock_server;
+
+void init_mock_server_config(struct mock_server_config *cfg);
+struct mock_server *start_mock_server(const struct mock_server_config *cfg);
+const char *mock_server_url(const struct mock_server *srv);
+unsigned short mock_server_port(const struct mock_server *srv);
+void set_mock_faults(struct mock_server *srv, const struct mock_faults *faults);
+void get_mock_stats(struct mock_server *srv, struct mock_stats *out);
+void print_mock_stats(struct mock_server *srv);
+void stop_mock_server(struct mock_server *srv);
+
+#endif  // SYSTEMAPIMOD_H
@@ -11,67 +11,661 @@ Inspiration by Sololearn!
 #include <curl/curl.h>  // libcurl for HTTP API calls
 #include <cjson/cJSON.h> // cJSON for JSON parsing (needs to be installed)
 #include <errno.h>
-#include <setjmp.h>  // For recovery points
+#include <stddef.h>  // max_align_t for the allocator headers
+#include <stdint.h>
+#include <stdarg.h>
+#include <math.h>    // fmin/fmax in the reduction kernels
+#include <strings.h> // strncasecmp for header and key matching
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h> // Lock-free log queue
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>  // Mock server
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // SSE2/AVX2 kernels, picked at runtime
+#elif defined(__arm__) || defined(__aarch64__)
+#include <sys/auxv.h>   // AT_HWCAP for NEON detection
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#endif
+
+#include "systemapimod.h"  // Public types and prototypes
+
+// ---------------------------------------------------
+/* Memory Management:
+With Calloc, Malloc, and Free.
+Also, logging.
+*/
+
+// ---- CPU features ----
+
+// Runtime CPU feature detection shared by the vectorized kernels
+
+#ifndef HWCAP_NEON
+#define HWCAP_NEON (1 << 12)  // Linux ARM hwcap bit
+#endif
+
+// Probed features plus LUMEN_CPU_PROBED in one word, so dispatch on any
+// thread sees either "not probed yet" or a complete mask
+#define LUMEN_CPU_PROBED 0x80000000u
+
+static atomic_uint lumen_cpu_mask;
+
+static unsigned int lumen_cpu_detect(void) {
+    unsigned int features = 0;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) features |= LUMEN_CPU_SSE2;
+    if (__builtin_cpu_supports("avx2")) features |= LUMEN_CPU_AVX2;
+#elif defined(__aarch64__)
+    features |= LUMEN_CPU_NEON;  // Mandatory on ARMv8-A
+#elif defined(__arm__)
+    if (getauxval(AT_HWCAP) & HWCAP_NEON) features |= LUMEN_CPU_NEON;
+#endif
+    return features;
+}
+
+unsigned int lumen_cpu_features(void) {
+    unsigned int mask = atomic_load_explicit(&lumen_cpu_mask, memory_order_acquire);
+    if (mask & LUMEN_CPU_PROBED) return mask & ~LUMEN_CPU_PROBED;
+    
+    // Racing first callers detect the same features; a restrict wins over them
+    unsigned int features = lumen_cpu_detect();
+    unsigned int expected = 0;
+    if (!atomic_compare_exchange_strong_explicit(&lumen_cpu_mask, &expected, features | LUMEN_CPU_PROBED,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        return expected & ~LUMEN_CPU_PROBED;
+    }
+    return features;
+}
+
+// Restrict dispatch to a subset of the detected features (0 = generic code only).
+// Used by benchmarks to compare paths on one machine.
+void lumen_cpu_restrict(unsigned int mask) {
+    unsigned int detected = lumen_cpu_detect();
+    
+    atomic_store_explicit(&lumen_cpu_mask, (detected & mask) | LUMEN_CPU_PROBED, memory_order_release);
+}
+
+// ---- Slab allocator ----
+// Fixed size classes carved from 64KB slabs. Each thread keeps an intrusive
+// free list per class (its magazine) and only takes the class lock to trade
+// a batch of LUMEN_MAGAZINE_SIZE objects with the shared list. Slabs are
+// never returned to the system. Build with -DLUMEN_USE_MALLOC to bypass it.
+#define LUMEN_SLAB_CLASSES 8
+#define LUMEN_SLAB_MIN_SHIFT 5          // 32-byte smallest slot, 4KB largest
+#define LUMEN_SLAB_CHUNK (64 * 1024)
+#define LUMEN_MAGAZINE_SIZE 32
+#define LUMEN_SLAB_LARGE 0xffffffffu    // Sent straight to malloc
+
+#ifdef LUMEN_USE_MALLOC
+
+void print_lumen_slab_stats(void) {
+    printf("Slab allocator disabled (LUMEN_USE_MALLOC)\n");
+}
+
+#else
+
+// Precedes every object. Aligned like max_align_t so user memory keeps
+// malloc's alignment; the fields alone are 12 bytes on ILP32.
+typedef struct {
+    _Alignas(max_align_t) uint32_t size_class;
+    uint32_t reserved;
+    size_t requested;
+} LumenSlabHeader;
+
+_Static_assert(sizeof(LumenSlabHeader) % _Alignof(max_align_t) == 0,
+               "slab header must keep user memory max_align_t aligned");
+
+typedef struct LumenSlabFree {
+    struct LumenSlabFree* next;
+} LumenSlabFree;
+
+typedef struct {
+    pthread_mutex_t lock;
+    LumenSlabFree* free_list;
+    size_t free_count;
+    size_t slabs;
+    atomic_ulong refills;
+    atomic_ulong flushes;
+} LumenSlabClass;
+
+typedef struct {
+    LumenSlabFree* head[LUMEN_SLAB_CLASSES];
+    unsigned int count[LUMEN_SLAB_CLASSES];
+    int registered;
+} LumenMagazine;
+
+static LumenSlabClass lumen_slab_classes[LUMEN_SLAB_CLASSES];
+static pthread_once_t lumen_slab_once = PTHREAD_ONCE_INIT;
+static pthread_key_t lumen_magazine_key;
+static _Thread_local LumenMagazine lumen_magazine;
+static atomic_ulong lumen_slab_large_allocs;
+
+static size_t lumen_slot_size(unsigned int size_class) {
+    return (size_t)1 << (size_class + LUMEN_SLAB_MIN_SHIFT);
+}
+
+// Hand a batch of up to count objects back to the shared list
+static void lumen_magazine_flush(LumenMagazine* mag, unsigned int size_class, unsigned int count) {
+    LumenSlabClass* cls = &lumen_slab_classes[size_class];
+    LumenSlabFree* first = mag->head[size_class];
+    LumenSlabFree* last = first;
+    unsigned int moved = 1;
+    
+    if (first == NULL || count == 0) {
+        return;
+    }
+    while (moved < count && last->next != NULL) {
+        last = last->next;
+        moved++;
+    }
+    mag->head[size_class] = last->next;
+    mag->count[size_class] -= moved;
+    
+    pthread_mutex_lock(&cls->lock);
+    last->next = cls->free_list;
+    cls->free_list = first;
+    cls->free_count += moved;
+    pthread_mutex_unlock(&cls->lock);
+    atomic_fetch_add_explicit(&cls->flushes, 1, memory_order_relaxed);
+}
+
+// Thread exit: return everything the magazine still holds
+static void lumen_magazine_release(void* arg) {
+    LumenMagazine* mag = (LumenMagazine*)arg;
+    
+    for (unsigned int c = 0; c < LUMEN_SLAB_CLASSES; c++) {
+        lumen_magazine_flush(mag, c, mag->count[c]);
+    }
+    mag->registered = 0;
+}
+
+static void lumen_slab_init(void) {
+    for (int c = 0; c < LUMEN_SLAB_CLASSES; c++) {
+        pthread_mutex_init(&lumen_slab_classes[c].lock, NULL);
+    }
+    pthread_key_create(&lumen_magazine_key, lumen_magazine_release);
+}
+
+// Move a batch from the shared list (carving a new slab if needed) into mag
+static int lumen_magazine_refill(LumenMagazine* mag, unsigned int size_class) {
+    LumenSlabClass* cls = &lumen_slab_classes[size_class];
+    size_t slot = lumen_slot_size(size_class);
+    unsigned int moved = 0;
+    
+    pthread_mutex_lock(&cls->lock);
+    if (cls->free_list == NULL) {
+        char* chunk = (char*)malloc(LUMEN_SLAB_CHUNK);
+        if (chunk == NULL) {
+            pthread_mutex_unlock(&cls->lock);
+            return -1;
+        }
+        for (size_t off = 0; off + slot <= LUMEN_SLAB_CHUNK; off += slot) {
+            LumenSlabFree* obj = (LumenSlabFree*)(chunk + off);
+            obj->next = cls->free_list;
+            cls->free_list = obj;
+            cls->free_count++;
+        }
+        cls->slabs++;
+    }
+    while (moved < LUMEN_MAGAZINE_SIZE && cls->free_list != NULL) {
+        LumenSlabFree* obj = cls->free_list;
+        cls->free_list = obj->next;
+        obj->next = mag->head[size_class];
+        mag->head[size_class] = obj;
+        moved++;
+    }
+    cls->free_count -= moved;
+    pthread_mutex_unlock(&cls->lock);
+    
+    mag->count[size_class] += moved;
+    atomic_fetch_add_explicit(&cls->refills, 1, memory_order_relaxed);
+    return 0;
+}
+
+void* lumen_slab_alloc(size_t size) {
+    LumenMagazine* mag = &lumen_magazine;
+    LumenSlabHeader* header;
+    unsigned int size_class = 0;
+    
+    if (size > SIZE_MAX - sizeof(LumenSlabHeader)) {
+        return NULL;
+    }
+    while (size_class < LUMEN_SLAB_CLASSES &&
+           lumen_slot_size(size_class) < size + sizeof(LumenSlabHeader)) {
+        size_class++;
+    }
+    
+    if (size_class == LUMEN_SLAB_CLASSES) {
+        header = (LumenSlabHeader*)malloc(sizeof(LumenSlabHeader) + size);
+        if (header == NULL) {
+            return NULL;
+        }
+        header->size_class = LUMEN_SLAB_LARGE;
+        header->requested = size;
+        atomic_fetch_add_explicit(&lumen_slab_large_allocs, 1, memory_order_relaxed);
+        return header + 1;
+    }
+    
+    if (!mag->registered) {
+        pthread_once(&lumen_slab_once, lumen_slab_init);
+        pthread_setspecific(lumen_magazine_key, mag);
+        mag->registered = 1;
+    }
+    if (mag->head[size_class] == NULL && lumen_magazine_refill(mag, size_class) != 0) {
+        return NULL;
+    }
+    
+    LumenSlabFree* obj = mag->head[size_class];
+    mag->head[size_class] = obj->next;
+    mag->count[size_class]--;
+    
+    header = (LumenSlabHeader*)obj;
+    header->size_class = size_class;
+    header->requested = size;
+    return header + 1;
+}
+
+void* lumen_slab_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    
+    void* ptr = lumen_slab_alloc(count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void lumen_slab_free(void* ptr) {
+    LumenMagazine* mag = &lumen_magazine;
+    
+    if (ptr == NULL) {
+        return;
+    }
+    
+    LumenSlabHeader* header = (LumenSlabHeader*)ptr - 1;
+    unsigned int size_class = header->size_class;
+    if (size_class == LUMEN_SLAB_LARGE) {
+        free(header);
+        return;
+    }
+    
+    // Objects may be freed by a thread that never allocated
+    if (!mag->registered) {
+        pthread_once(&lumen_slab_once, lumen_slab_init);
+        pthread_setspecific(lumen_magazine_key, mag);
+        mag->registered = 1;
+    }
+    
+    LumenSlabFree* obj = (LumenSlabFree*)header;
+    obj->next = mag->head[size_class];
+    mag->head[size_class] = obj;
+    if (++mag->count[size_class] >= 2 * LUMEN_MAGAZINE_SIZE) {
+        lumen_magazine_flush(mag, size_class, LUMEN_MAGAZINE_SIZE);
+    }
+}
+
+void print_lumen_slab_stats(void) {
+    pthread_once(&lumen_slab_once, lumen_slab_init);  // Class locks exist before any allocation
+    
+    printf("=== LUMEN SLAB ===\n");
+    for (unsigned int c = 0; c < LUMEN_SLAB_CLASSES; c++) {
+        LumenSlabClass* cls = &lumen_slab_classes[c];
+        pthread_mutex_lock(&cls->lock);
+        size_t slabs = cls->slabs;
+        size_t free_count = cls->free_count;
+        pthread_mutex_unlock(&cls->lock);
+        
+        if (slabs == 0) {
+            continue;
+        }
+        printf("%5zu B: slabs=%zu shared_free=%zu refills=%lu flushes=%lu\n",
+               lumen_slot_size(c), slabs, free_count,
+               atomic_load(&cls->refills), atomic_load(&cls->flushes));
+    }
+    printf("Large (malloc): %lu\n", atomic_load(&lumen_slab_large_allocs));
+    printf("==================\n");
+}
+
+#endif  // LUMEN_USE_MALLOC
 
-// Module struct
-struct os {
-    int apimodel;
-    int system;
-    char osname[1];
+// ---- Allocation telemetry ----
+// Counters for every Lumen allocation: per call site, size and lifetime
+// histograms (log2 buckets), live and peak bytes. Each thread writes only
+// its own counters (relaxed load + store, no locked instructions);
+// snapshots sum them on demand. Live bytes are folded into the shared total
+// in batches of LUMEN_TELEMETRY_FLUSH_BYTES, so the peak is exact to within
+// that per thread. Lifetimes are sampled, since reading the clock costs more
+// than the allocation itself. Build with -DLUMEN_NO_TELEMETRY to compile it out.
+#define LUMEN_TELEMETRY_FLUSH_BYTES (64 * 1024)
+#define LUMEN_TELEMETRY_SAMPLE 64            // One lifetime per N allocations
+#define LUMEN_TELEMETRY_UNSAMPLED 0xffffffffu
+
+static const char* lumen_site_names[LUMEN_SITE_COUNT] = {
+    "lumen_alloc_init", "lumen_alloc_init.data", "init_lumen_alloc", "init_lumen_alloc.values",
+    "setup_lumen_manager", "setup_lumen_manager.mem", "lumen_packed_alloc", "init_lumen_packed_unit"
 };
 
-int main() {
-    // 2 vars
-    struct os h1;
-    struct api h1;
+#ifdef LUMEN_NO_TELEMETRY
+
+int lumen_telemetry_snapshot(LumenTelemetrySnapshot* out) {
+    memset(out, 0, sizeof(LumenTelemetrySnapshot));
+    return -1;
+}
+
+#else
+
+// Precedes each tracked object. Aligned like max_align_t, as the slab
+// header is, so user memory keeps its alignment on ILP32 too.
+typedef struct {
+    _Alignas(max_align_t) uint16_t site;
+    uint16_t reserved;
+    uint32_t born_us;  // Or LUMEN_TELEMETRY_UNSAMPLED. Wraps every ~71 minutes.
+    size_t size;
+} LumenTelemetryHeader;
+
+_Static_assert(sizeof(LumenTelemetryHeader) % _Alignof(max_align_t) == 0,
+               "telemetry header must keep user memory max_align_t aligned");
+
+typedef struct LumenThreadTelemetry {
+    struct LumenThreadTelemetry* next;
+    int in_use;                 // Owned by a live thread; guarded by lumen_telemetry_lock
+    atomic_ulong allocs[LUMEN_SITE_COUNT];
+    atomic_ulong frees[LUMEN_SITE_COUNT];
+    atomic_ulong bytes_allocated[LUMEN_SITE_COUNT];
+    atomic_ulong bytes_freed[LUMEN_SITE_COUNT];
+    atomic_ulong size_hist[LUMEN_TELEMETRY_BUCKETS];
+    atomic_ulong lifetime_hist[LUMEN_TELEMETRY_BUCKETS];
+    atomic_llong pending_live;  // Not yet folded into lumen_live_bytes
+    unsigned int sample_tick;
+} LumenThreadTelemetry;
+
+static LumenThreadTelemetry* lumen_telemetry_threads = NULL;
+static pthread_mutex_t lumen_telemetry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t lumen_telemetry_once = PTHREAD_ONCE_INIT;
+static pthread_key_t lumen_telemetry_key;
+static _Thread_local LumenThreadTelemetry* lumen_thread_telemetry = NULL;
+static atomic_llong lumen_live_bytes;
+static atomic_llong lumen_peak_bytes;
+
+static uint32_t lumen_telemetry_now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000);
+}
+
+// Single-writer increment: only the owning thread updates its counters
+static inline void lumen_counter_add(atomic_ulong* counter, unsigned long value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+static int lumen_telemetry_bucket(unsigned long long value) {
+    int bucket = value ? 64 - __builtin_clzll(value) : 0;
+    return (bucket < LUMEN_TELEMETRY_BUCKETS) ? bucket : LUMEN_TELEMETRY_BUCKETS - 1;
+}
+
+// Add a thread's pending live bytes to the shared total and raise the peak
+static void lumen_telemetry_fold(long long pending) {
+    long long live = atomic_fetch_add_explicit(&lumen_live_bytes, pending, memory_order_relaxed) + pending;
+    long long peak = atomic_load_explicit(&lumen_peak_bytes, memory_order_relaxed);
+    while (live > peak &&
+           !atomic_compare_exchange_weak_explicit(&lumen_peak_bytes, &peak, live,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// Thread exit: fold what is pending and free the node for the next new
+// thread. Its counters stay in the registry, so the history stays in the totals.
+static void lumen_telemetry_release(void* arg) {
+    LumenThreadTelemetry* local = (LumenThreadTelemetry*)arg;
+    
+    lumen_telemetry_fold(atomic_exchange_explicit(&local->pending_live, 0, memory_order_relaxed));
+    pthread_mutex_lock(&lumen_telemetry_lock);
+    local->in_use = 0;
+    pthread_mutex_unlock(&lumen_telemetry_lock);
+    lumen_thread_telemetry = NULL;
+}
+
+static void lumen_telemetry_init(void) {
+    pthread_key_create(&lumen_telemetry_key, lumen_telemetry_release);
+}
+
+// This thread's counters. Nodes of exited threads are reused, so the
+// registry grows with the most threads alive at once, not every thread ever.
+static LumenThreadTelemetry* lumen_telemetry_local(void) {
+    LumenThreadTelemetry* local = lumen_thread_telemetry;
+    
+    if (local == NULL) {
+        pthread_once(&lumen_telemetry_once, lumen_telemetry_init);
+        
+        pthread_mutex_lock(&lumen_telemetry_lock);
+        for (LumenThreadTelemetry* t = lumen_telemetry_threads; t != NULL; t = t->next) {
+            if (!t->in_use) {
+                local = t;
+                break;
+            }
+        }
+        if (local == NULL) {
+            local = (LumenThreadTelemetry*)calloc(1, sizeof(LumenThreadTelemetry));
+            if (local == NULL) {
+                pthread_mutex_unlock(&lumen_telemetry_lock);
+                return NULL;
+            }
+            local->next = lumen_telemetry_threads;
+            lumen_telemetry_threads = local;
+        }
+        local->in_use = 1;
+        pthread_mutex_unlock(&lumen_telemetry_lock);
+        
+        pthread_setspecific(lumen_telemetry_key, local);
+        lumen_thread_telemetry = local;
+    }
+    return local;
+}
+
+static void lumen_telemetry_live(LumenThreadTelemetry* local, long long delta) {
+    long long pending = atomic_load_explicit(&local->pending_live, memory_order_relaxed) + delta;
+    
+    if (pending < LUMEN_TELEMETRY_FLUSH_BYTES && pending > -LUMEN_TELEMETRY_FLUSH_BYTES) {
+        atomic_store_explicit(&local->pending_live, pending, memory_order_relaxed);
+        return;
+    }
+    
+    atomic_store_explicit(&local->pending_live, 0, memory_order_relaxed);
+    lumen_telemetry_fold(pending);
+}
+
+// Count an allocation made outside lumen_mem_alloc. Returns the birth stamp.
+uint32_t lumen_telemetry_note_alloc(int site, size_t size) {
+    LumenThreadTelemetry* local = lumen_telemetry_local();
+    
+    if (local == NULL) {
+        return 0;
+    }
+    lumen_counter_add(&local->allocs[site], 1);
+    lumen_counter_add(&local->bytes_allocated[site], size);
+    lumen_counter_add(&local->size_hist[lumen_telemetry_bucket(size)], 1);
+    lumen_telemetry_live(local, (long long)size);
+    
+    if (++local->sample_tick % LUMEN_TELEMETRY_SAMPLE != 0) {
+        return LUMEN_TELEMETRY_UNSAMPLED;
+    }
+    uint32_t now = lumen_telemetry_now_us();
+    return (now == LUMEN_TELEMETRY_UNSAMPLED) ? now - 1 : now;
+}
+
+void lumen_telemetry_note_free(int site, size_t size, uint32_t born_us) {
+    LumenThreadTelemetry* local = lumen_telemetry_local();
+    
+    if (local == NULL) {
+        return;
+    }
+    lumen_counter_add(&local->frees[site], 1);
+    lumen_counter_add(&local->bytes_freed[site], size);
+    if (born_us != LUMEN_TELEMETRY_UNSAMPLED) {
+        uint32_t lifetime = lumen_telemetry_now_us() - born_us;
+        lumen_counter_add(&local->lifetime_hist[lumen_telemetry_bucket(lifetime)], 1);
+    }
+    lumen_telemetry_live(local, -(long long)size);
+}
+
+void* lumen_mem_alloc(int site, size_t size) {
+    if (size > SIZE_MAX - sizeof(LumenTelemetryHeader)) {
+        return NULL;
+    }
+    
+    LumenTelemetryHeader* header = (LumenTelemetryHeader*)lumen_slab_alloc(sizeof(LumenTelemetryHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->site = (uint16_t)site;
+    header->size = size;
+    header->born_us = lumen_telemetry_note_alloc(site, size);
+    return header + 1;
+}
+
+void* lumen_mem_calloc(int site, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    
+    void* ptr = lumen_mem_alloc(site, count * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void lumen_mem_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
     
-    h1.os = 1;
-    h1.apimodel = 1;
-    sprintf(h1.os, "Lumen");
+    LumenTelemetryHeader* header = (LumenTelemetryHeader*)ptr - 1;
+    lumen_telemetry_note_free(header->site, header->size, header->born_us);
+    lumen_slab_free(header);
+}
+
+// Sum every thread's counters into out
+int lumen_telemetry_snapshot(LumenTelemetrySnapshot* out) {
+    long long pending = 0;
     
-    h2.osname = 1;
-    h2.hostnum = 5432;
-    sprintf(h2.osname, "Lumen");
+    memset(out, 0, sizeof(LumenTelemetrySnapshot));
     
-    printf("MainOSName: %s, %d\n", h2.osname, h2.hostnum);
-    printf("MainAPIModel: %s, %d\n", h2.apimodel, h2.os);
+    pthread_mutex_lock(&lumen_telemetry_lock);
+    for (LumenThreadTelemetry* t = lumen_telemetry_threads; t != NULL; t = t->next) {
+        for (int i = 0; i < LUMEN_SITE_COUNT; i++) {
+            out->sites[i].allocs += atomic_load_explicit(&t->allocs[i], memory_order_relaxed);
+            out->sites[i].frees += atomic_load_explicit(&t->frees[i], memory_order_relaxed);
+            out->sites[i].bytes_allocated += atomic_load_explicit(&t->bytes_allocated[i], memory_order_relaxed);
+            out->sites[i].bytes_freed += atomic_load_explicit(&t->bytes_freed[i], memory_order_relaxed);
+        }
+        for (int b = 0; b < LUMEN_TELEMETRY_BUCKETS; b++) {
+            out->size_hist[b] += atomic_load_explicit(&t->size_hist[b], memory_order_relaxed);
+            out->lifetime_hist[b] += atomic_load_explicit(&t->lifetime_hist[b], memory_order_relaxed);
+        }
+        pending += atomic_load_explicit(&t->pending_live, memory_order_relaxed);
+        out->threads++;
+    }
+    pthread_mutex_unlock(&lumen_telemetry_lock);
     
+    out->live_bytes = atomic_load(&lumen_live_bytes) + pending;
+    out->peak_bytes = atomic_load(&lumen_peak_bytes);
+    if (out->live_bytes > out->peak_bytes) {
+        out->peak_bytes = out->live_bytes;
+    }
     return 0;
 }
 
-// ---------------------------------------------------
-/* Memory Management:
-With Calloc, Malloc, and Free.
-Also, logging.
-*/
+#endif  // LUMEN_NO_TELEMETRY
+
+static void lumen_telemetry_print_hist(FILE* out, const unsigned long* hist, int json) {
+    int last = LUMEN_TELEMETRY_BUCKETS - 1;
+    
+    while (last > 0 && hist[last] == 0) {
+        last--;
+    }
+    for (int b = 0; b <= last; b++) {
+        if (json) {
+            fprintf(out, "%s%lu", b ? "," : "", hist[b]);
+        } else if (hist[b]) {
+            fprintf(out, "  <%llu: %lu\n", 1ULL << b, hist[b]);
+        }
+    }
+}
+
+// Write a snapshot as text or JSON
+int lumen_telemetry_dump(FILE* out, int format) {
+    LumenTelemetrySnapshot snap;
+    
+    if (lumen_telemetry_snapshot(&snap) != 0) {
+        fprintf(out, (format == LUMEN_TELEMETRY_JSON) ? "{\"enabled\":false}\n" : "Telemetry disabled\n");
+        return -1;
+    }
+    
+    if (format == LUMEN_TELEMETRY_JSON) {
+        fprintf(out, "{\"live_bytes\":%lld,\"peak_bytes\":%lld,\"threads\":%d,\"sites\":[",
+                snap.live_bytes, snap.peak_bytes, snap.threads);
+        for (int i = 0; i < LUMEN_SITE_COUNT; i++) {
+            fprintf(out, "%s{\"site\":\"%s\",\"allocs\":%lu,\"frees\":%lu,\"bytes\":%lu,\"live_bytes\":%ld}",
+                    i ? "," : "", lumen_site_names[i], snap.sites[i].allocs, snap.sites[i].frees,
+                    snap.sites[i].bytes_allocated,
+                    (long)(snap.sites[i].bytes_allocated - snap.sites[i].bytes_freed));
+        }
+        fprintf(out, "],\"size_log2_hist\":[");
+        lumen_telemetry_print_hist(out, snap.size_hist, 1);
+        fprintf(out, "],\"lifetime_sample\":%d,\"lifetime_us_log2_hist\":[", LUMEN_TELEMETRY_SAMPLE);
+        lumen_telemetry_print_hist(out, snap.lifetime_hist, 1);
+        fprintf(out, "]}\n");
+        return 0;
+    }
+    
+    fprintf(out, "=== LUMEN ALLOCATIONS ===\n");
+    fprintf(out, "Live: %lld bytes | Peak: %lld bytes | Threads: %d\n",
+            snap.live_bytes, snap.peak_bytes, snap.threads);
+    for (int i = 0; i < LUMEN_SITE_COUNT; i++) {
+        if (snap.sites[i].allocs == 0) {
+            continue;
+        }
+        fprintf(out, "%-26s allocs=%lu frees=%lu bytes=%lu live=%ld\n", lumen_site_names[i],
+                snap.sites[i].allocs, snap.sites[i].frees, snap.sites[i].bytes_allocated,
+                (long)(snap.sites[i].bytes_allocated - snap.sites[i].bytes_freed));
+    }
+    fprintf(out, "Sizes (bytes):\n");
+    lumen_telemetry_print_hist(out, snap.size_hist, 0);
+    fprintf(out, "Lifetimes (us, 1/%d sampled):\n", LUMEN_TELEMETRY_SAMPLE);
+    lumen_telemetry_print_hist(out, snap.lifetime_hist, 0);
+    fprintf(out, "=========================\n");
+    return 0;
+}
 
 // ---- Malloc! ----
-// Define platform-specific macros for Lumen OS on Moto Nexus 6 (Armv7-A)
-#if defined(__arm__) && defined(__ARM_ARCH_7A__)
+// Device macros come from the build profile (see systemapimod.h)
+#ifdef LUMEN_PROFILE_NEXUS6
 #define LUMEN_OS_TARGET 1
-#define DEVICE_MODEL "Moto Nexus 6"
-#else
-#error "This code is tailored for Lumen OS on Armv7-A architecture (Moto Nexus 6)"
 #endif
-
-// Custom struct for memory management in Lumen environment
-typedef struct {
-    size_t block_size;
-    int *data_ptr;
-    char device_info[64];
-} LumenMemBlock;
+#define DEVICE_MODEL LUMEN_DEVICE_NAME
 
 // Function to initialize and allocate memory with Lumen-specific checks
 LumenMemBlock* lumen_alloc_init(size_t num_elements) {
-    LumenMemBlock* mem = (LumenMemBlock*)calloc(1, sizeof(LumenMemBlock));
+    LumenMemBlock* mem = (LumenMemBlock*)lumen_mem_calloc(LUMEN_SITE_MEMBLOCK, 1, sizeof(LumenMemBlock));
     if (mem == NULL) {
         return NULL;
     }
     
     mem->block_size = num_elements;
-    mem->data_ptr = (int*)calloc(num_elements, sizeof(int));
+    mem->data_ptr = (int*)lumen_mem_calloc(LUMEN_SITE_MEMBLOCK_DATA, num_elements, sizeof(int));
     if (mem->data_ptr == NULL) {
-        free(mem);
+        lumen_mem_free(mem);
         return NULL;
     }
     
@@ -107,72 +701,29 @@ void lumen_print_value(LumenMemBlock* mem, size_t offset) {
 // Function to cleanup memory
 void lumen_free_block(LumenMemBlock* mem) {
     if (mem != NULL) {
-        free(mem->data_ptr);
-        free(mem);
-    }
-}
-
-int main() {
-    // Allocate for 15 elements (modified from original 10)
-    LumenMemBlock* block = lumen_alloc_init(15);
-    if (block == NULL) {
-        printf("Allocation failed on Lumen OS\n");
-        return 1;
-    }
-    
-    // Set value at fourth position (modified from third)
-    lumen_set_value(block, 3, 75);  // Modified value from 50
-    
-    // Add a loop to set more values for heavier modification
-    for (size_t i = 0; i < block->block_size; ++i) {
-        if (i != 3) {
-            lumen_set_value(block, i, (int)i * 2);
-        }
+        lumen_mem_free(mem->data_ptr);
+        lumen_mem_free(mem);
     }
-    
-    // Print the specific value
-    lumen_print_value(block, 3);
-    
-    // Print another value to demonstrate
-    lumen_print_value(block, 0);
-    lumen_print_value(block, 14);
-    
-    // Simulate some Lumen OS delay (e.g., for mobile responsiveness)
-    usleep(100000);  // 0.1 second delay
-    
-    // Cleanup
-    lumen_free_block(block);
-    
-    return 0;
 }
 
 // ---- Calloc ----
-// Platform-specific definitions for Lumen on Armv7-A Moto Nexus 6
-#if defined(__arm__) && defined(__ARM_ARCH_7A__)
+// Platform tag follows the selected profile
+#ifdef LUMEN_PROFILE_NEXUS6
 #define LUMEN_PLATFORM 1
-#define TARGET_DEVICE "Moto Nexus 6"
-#else
-#error "Code optimized for Lumen OS on Armv7-A (Moto Nexus 6 only)"
 #endif
-
-// Enhanced struct for calloc-based allocation in Lumen context
-typedef struct {
-    size_t alloc_count;
-    double *values;  // Changed to double for variety
-    char platform_tag[128];
-} LumenAllocUnit;
+#define TARGET_DEVICE LUMEN_DEVICE_NAME
 
 // Initialize allocation unit with calloc and embed platform details
 LumenAllocUnit* init_lumen_alloc(size_t elements) {
-    LumenAllocUnit* unit = (LumenAllocUnit*)calloc(1, sizeof(LumenAllocUnit));
+    LumenAllocUnit* unit = (LumenAllocUnit*)lumen_mem_calloc(LUMEN_SITE_ALLOC_UNIT, 1, sizeof(LumenAllocUnit));
     if (unit == NULL) {
         return NULL;
     }
     
     unit->alloc_count = elements;
-    unit->values = (double*)calloc(elements, sizeof(double));
+    unit->values = (double*)lumen_mem_calloc(LUMEN_SITE_ALLOC_UNIT_VALUES, elements, sizeof(double));
     if (unit->values == NULL) {
-        free(unit);
+        lumen_mem_free(unit);
         return NULL;
     }
     
@@ -206,70 +757,28 @@ void display_lumen_value(LumenAllocUnit* unit, size_t idx) {
 // Release the allocation unit
 void release_lumen_unit(LumenAllocUnit* unit) {
     if (unit != NULL) {
-        free(unit->values);
-        free(unit);
-    }
-}
-
-int main() {
-    // Allocate for 20 elements (increased from original concept)
-    LumenAllocUnit* alloc = init_lumen_alloc(20);
-    if (alloc == NULL) {
-        printf("Failed to allocate on Lumen OS\n");
-        return 1;
-    }
-    
-    // Assign value at fifth position (shifted from third)
-    assign_lumen_value(alloc, 4, 88.5);  // Different value and type
-    
-    // Populate additional values in a loop for modification depth
-    for (size_t j = 0; j < alloc->alloc_count; ++j) {
-        if (j != 4) {
-            assign_lumen_value(alloc, j, (double)j * 1.5);
-        }
+        lumen_mem_free(unit->values);
+        lumen_mem_free(unit);
     }
-    
-    // Display selected values
-    display_lumen_value(alloc, 4);
-    display_lumen_value(alloc, 1);
-    display_lumen_value(alloc, 19);
-    
-    // Add delay to mimic Lumen OS mobile operation
-    usleep(200000);  // 0.2s pause
-    
-    // Free resources
-    release_lumen_unit(alloc);
-    
-    return 0;
 }
 
 // ---- Free ----
-// Define macros specific to Lumen OS on Armv7-A Moto Nexus 6
-#if defined(__arm__) && defined(__ARM_ARCH_7A__)
+// Hardware label follows the selected profile
+#ifdef LUMEN_PROFILE_NEXUS6
 #define LUMEN_ENV 1
-#define HARDWARE_MODEL "Moto Nexus 6"
-#else
-#error "Optimized for Lumen OS running on Armv7-A (Moto Nexus 6)"
 #endif
-
-// Struct for managing freed memory in Lumen context
-typedef struct {
-    size_t freed_size;
-    void *mem_ptr;
-    char hardware_label[96];
-    int status_code;
-} LumenFreeManager;
+#define HARDWARE_MODEL LUMEN_DEVICE_NAME
 
 // Function to prepare a memory manager for allocation and later free
 LumenFreeManager* setup_lumen_manager(size_t alloc_bytes) {
-    LumenFreeManager* manager = (LumenFreeManager*)malloc(sizeof(LumenFreeManager));
+    LumenFreeManager* manager = (LumenFreeManager*)lumen_mem_alloc(LUMEN_SITE_FREE_MANAGER, sizeof(LumenFreeManager));
     if (manager == NULL) {
         return NULL;
     }
     
-    manager->mem_ptr = malloc(alloc_bytes);
+    manager->mem_ptr = lumen_mem_alloc(LUMEN_SITE_FREE_MANAGER_MEM, alloc_bytes);
     if (manager->mem_ptr == NULL) {
-        free(manager);
+        lumen_mem_free(manager);
         return NULL;
     }
     
@@ -285,7 +794,7 @@ LumenFreeManager* setup_lumen_manager(size_t alloc_bytes) {
 // Function to perform free operation with checks
 void execute_lumen_free(LumenFreeManager* manager) {
     if (manager != NULL && manager->mem_ptr != NULL && manager->freed_size == 0) {
-        free(manager->mem_ptr);
+        lumen_mem_free(manager->mem_ptr);
         manager->mem_ptr = NULL;
         manager->freed_size = 1;  // Mark as freed
         manager->status_code = 1; // Freed successfully
@@ -317,59 +826,784 @@ void log_lumen_status(LumenFreeManager* manager) {
 void destroy_lumen_manager(LumenFreeManager* manager) {
     if (manager != NULL) {
         if (manager->mem_ptr != NULL) {
-            free(manager->mem_ptr);  // Safety free if not already
+            lumen_mem_free(manager->mem_ptr);  // Safety free if not already
         }
-        free(manager);
+        lumen_mem_free(manager);
     }
 }
 
-int main() {
-    // Allocate 256 bytes (arbitrary size for example)
-    LumenFreeManager* mgr = setup_lumen_manager(256);
-    if (mgr == NULL) {
-        printf("Setup failed on Lumen OS\n");
-        return 1;
-    }
+// ---- Timestamps ----
+// Log timestamps: the calendar conversion (localtime_r + strftime) runs once
+// per wall-clock second per thread, sub-second digits come from a monotonic
+// clock anchored to the wall clock.
+#define LUMEN_TS_REANCHOR_SEC 60  // Re-read CLOCK_REALTIME to follow NTP adjustments
+
+typedef struct {
+    time_t second;           // Second currently held in text
+    char text[32];           // "YYYY-MM-DD HH:MM:SS"
+    size_t length;
+    int valid;
+    time_t anchor_sec;       // Wall clock at anchor_mono_ns
+    long anchor_nsec;
+    long long anchor_mono_ns;
+    int anchored;
+    unsigned long conversions;
+} LumenTimestampCache;
+
+static _Thread_local LumenTimestampCache lumen_ts_cache;
+
+static long long lumen_mono_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Current wall-clock time derived from the monotonic clock
+void lumen_clock_now(time_t* sec, long* nsec) {
+    LumenTimestampCache* cache = &lumen_ts_cache;
+    long long mono = lumen_mono_ns();
     
-    // Simulate usage: memset to fill memory
-    memset(mgr->mem_ptr, 0xAA, 256);
+    if (!cache->anchored || mono - cache->anchor_mono_ns >= LUMEN_TS_REANCHOR_SEC * 1000000000LL) {
+        struct timespec real;
+        clock_gettime(CLOCK_REALTIME, &real);
+        cache->anchor_sec = real.tv_sec;
+        cache->anchor_nsec = real.tv_nsec;
+        cache->anchor_mono_ns = mono;
+        cache->anchored = 1;
+    }
     
-    // Now free it
-    execute_lumen_free(mgr);
+    long long delta = (mono - cache->anchor_mono_ns) + cache->anchor_nsec;
+    *sec = cache->anchor_sec + (time_t)(delta / 1000000000LL);
+    *nsec = (long)(delta % 1000000000LL);
+}
+
+// Format sec (+ precision fractional digits of nsec) into out. Returns length, 0 on failure.
+size_t lumen_format_timestamp(time_t sec, long nsec, int precision, char* out, size_t out_size) {
+    LumenTimestampCache* cache = &lumen_ts_cache;
+    size_t len;
     
-    // Log the result
-    log_lumen_status(mgr);
+    if (out == NULL || out_size == 0) {
+        return 0;
+    }
+    
+    if (!cache->valid || cache->second != sec) {
+        struct tm time_info;
+        if (localtime_r(&sec, &time_info) == NULL) {
+            out[0] = '\0';
+            return 0;
+        }
+        cache->length = strftime(cache->text, sizeof(cache->text), "%Y-%m-%d %H:%M:%S", &time_info);
+        cache->second = sec;
+        cache->valid = 1;
+        cache->conversions++;
+    }
+    
+    if (cache->length >= out_size) {
+        out[0] = '\0';
+        return 0;
+    }
+    memcpy(out, cache->text, cache->length);
+    len = cache->length;
+    
+    if (precision > 9) {
+        precision = 9;
+    }
+    if (precision > 0 && len + 1 + precision < out_size) {
+        long frac = nsec;
+        for (int i = precision; i < 9; i++) {
+            frac /= 10;
+        }
+        out[len++] = '.';
+        for (int i = precision - 1; i >= 0; i--) {
+            out[len + i] = (char)('0' + frac % 10);
+            frac /= 10;
+        }
+        len += precision;
+    }
+    
+    out[len] = '\0';
+    return len;
+}
+
+// Calendar conversions done by this thread's cache (each one is a cache miss)
+unsigned long lumen_timestamp_conversions(void) {
+    return lumen_ts_cache.conversions;
+}
+
+// ---- Packed blocks ----
+// Single-allocation variants of LumenMemBlock / LumenAllocUnit: header and
+// data share one 64-byte aligned allocation, and the device tag points at a
+// shared interned string instead of being copied into every block.
+#define LUMEN_INTERN_MAX 16
+
+static const char* lumen_interned[LUMEN_INTERN_MAX];
+static const char* lumen_block_tag = NULL;
+static const char* lumen_unit_tag = NULL;
+static pthread_once_t lumen_tags_once = PTHREAD_ONCE_INIT;
+static int lumen_interned_count = 0;
+static pthread_mutex_t lumen_intern_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Return the shared copy of tag (NULL if the table is full or out of memory)
+const char* lumen_intern_tag(const char* tag) {
+    const char* found = NULL;
+    
+    if (tag == NULL) {
+        return NULL;
+    }
+    
+    pthread_mutex_lock(&lumen_intern_lock);
+    for (int i = 0; i < lumen_interned_count; i++) {
+        if (strcmp(lumen_interned[i], tag) == 0) {
+            found = lumen_interned[i];
+            break;
+        }
+    }
+    if (found == NULL && lumen_interned_count < LUMEN_INTERN_MAX) {
+        char* copy = strdup(tag);
+        if (copy != NULL) {
+            lumen_interned[lumen_interned_count++] = copy;
+            found = copy;
+        }
+    }
+    pthread_mutex_unlock(&lumen_intern_lock);
+    
+    return found;
+}
+
+static void lumen_intern_default_tags(void) {
+    char tag[128];
     
-    // Additional checks: try to free again (should fail)
-    execute_lumen_free(mgr);
-    log_lumen_status(mgr);
+    lumen_block_tag = lumen_intern_tag(DEVICE_MODEL);
+    snprintf(tag, sizeof(tag), "Lumen OS - %s", TARGET_DEVICE);
+    lumen_unit_tag = lumen_intern_tag(tag);
+}
+
+// Zeroed, cache-line aligned allocation of header + payload
+static void* lumen_packed_calloc(size_t header, size_t count, size_t elem) {
+    if (count > (SIZE_MAX - header - LUMEN_CACHE_LINE) / elem) {
+        return NULL;
+    }
+    
+    size_t bytes = header + count * elem;
+    bytes = (bytes + LUMEN_CACHE_LINE - 1) & ~(size_t)(LUMEN_CACHE_LINE - 1);
+    
+    void* mem = aligned_alloc(LUMEN_CACHE_LINE, bytes);
+    if (mem != NULL) {
+        memset(mem, 0, bytes);
+    }
+    return mem;
+}
+
+LumenPackedBlock* lumen_packed_alloc(size_t num_elements) {
+    pthread_once(&lumen_tags_once, lumen_intern_default_tags);
+    
+    LumenPackedBlock* mem = (LumenPackedBlock*)lumen_packed_calloc(sizeof(LumenPackedBlock),
+                                                                  num_elements, sizeof(int));
+    if (mem == NULL) {
+        return NULL;
+    }
     
-    // Delay for Lumen mobile simulation
-    usleep(150000);  // 0.15s
+    mem->block_size = num_elements;
+    mem->device_info = lumen_block_tag;
+    mem->born_us = lumen_telemetry_note_alloc(LUMEN_SITE_PACKED_BLOCK,
+                                              sizeof(LumenPackedBlock) + num_elements * sizeof(int));
+    return mem;
+}
+
+void lumen_packed_set_value(LumenPackedBlock* mem, size_t offset, int value) {
+    if (mem != NULL && offset < mem->block_size) {
+        mem->data_ptr[offset] = value;
+    }
+}
+
+void lumen_packed_print_value(LumenPackedBlock* mem, size_t offset) {
+    if (mem != NULL && offset < mem->block_size) {
+        printf("Lumen OS on %s: Element at offset %zu is %d\n",
+               mem->device_info, offset, mem->data_ptr[offset]);
+    } else {
+        printf("Error: Invalid memory block or offset\n");
+    }
+}
+
+void lumen_packed_free(LumenPackedBlock* mem) {
+    if (mem != NULL) {
+        lumen_telemetry_note_free(LUMEN_SITE_PACKED_BLOCK,
+                                  sizeof(LumenPackedBlock) + mem->block_size * sizeof(int), mem->born_us);
+        free(mem);
+    }
+}
+
+LumenPackedUnit* init_lumen_packed_unit(size_t elements) {
+    pthread_once(&lumen_tags_once, lumen_intern_default_tags);
     
-    // Cleanup manager
-    destroy_lumen_manager(mgr);
+    LumenPackedUnit* unit = (LumenPackedUnit*)lumen_packed_calloc(sizeof(LumenPackedUnit),
+                                                                 elements, sizeof(double));
+    if (unit == NULL) {
+        return NULL;
+    }
     
+    unit->alloc_count = elements;
+    unit->platform_tag = lumen_unit_tag;
+    unit->born_us = lumen_telemetry_note_alloc(LUMEN_SITE_PACKED_UNIT,
+                                               sizeof(LumenPackedUnit) + elements * sizeof(double));
+    return unit;
+}
+
+void assign_lumen_packed_value(LumenPackedUnit* unit, size_t idx, double val) {
+    if (unit != NULL && idx < unit->alloc_count) {
+        unit->values[idx] = val;
+    }
+}
+
+void release_lumen_packed_unit(LumenPackedUnit* unit) {
+    if (unit != NULL) {
+        lumen_telemetry_note_free(LUMEN_SITE_PACKED_UNIT,
+                                  sizeof(LumenPackedUnit) + unit->alloc_count * sizeof(double), unit->born_us);
+        free(unit);
+    }
+}
+
+// ---- Block kernels ----
+// Range operations on LumenMemBlock: bounds are checked once per call, then
+// a vector kernel runs over the span. Kernels are picked per call from
+// lumen_cpu_features(), like the key scanner. Copies use memmove, which libc
+// already vectorizes. Return 0 on success, -1 for a bad block or range.
+
+typedef struct {
+    void (*fill)(int* dst, size_t count, int value);
+    void (*scale_offset)(int* dst, size_t count, int scale, int bias);
+    size_t (*compare)(const int* a, const int* b, size_t count);  // First mismatch, or count
+    const char* name;
+} LumenBlockKernels;
+
+static void fill_generic(int* dst, size_t count, int value) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = value;
+    }
+}
+
+// Wrapping arithmetic, same on every path
+static void scale_offset_generic(int* dst, size_t count, int scale, int bias) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int)((uint32_t)dst[i] * (uint32_t)scale + (uint32_t)bias);
+    }
+}
+
+static size_t compare_generic(const int* a, const int* b, size_t count) {
+    size_t i = 0;
+    while (i < count && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static void fill_sse2(int* dst, size_t count, int value) {
+    __m128i v = _mm_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), v);
+    }
+    fill_generic(dst + i, count - i, value);
+}
+
+// SSE2 has no 32-bit mullo; build it from two 32x32->64 multiplies
+__attribute__((target("sse2")))
+static inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+__attribute__((target("sse2")))
+static void scale_offset_sse2(int* dst, size_t count, int scale, int bias) {
+    __m128i s = _mm_set1_epi32(scale);
+    __m128i b = _mm_set1_epi32(bias);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(mullo_epi32_sse2(v, s), b));
+    }
+    scale_offset_generic(dst + i, count - i, scale, bias);
+}
+
+__attribute__((target("sse2")))
+static size_t compare_sse2(const int* a, const int* b, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(a + i)),
+                                     _mm_loadu_si128((const __m128i*)(b + i)));
+        if (_mm_movemask_epi8(eq) != 0xffff) {
+            break;
+        }
+    }
+    return i + compare_generic(a + i, b + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void fill_avx2(int* dst, size_t count, int value) {
+    __m256i v = _mm256_set1_epi32(value);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), v);
+    }
+    fill_generic(dst + i, count - i, value);
+}
+
+__attribute__((target("avx2")))
+static void scale_offset_avx2(int* dst, size_t count, int scale, int bias) {
+    __m256i s = _mm256_set1_epi32(scale);
+    __m256i b = _mm256_set1_epi32(bias);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(dst + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(_mm256_mullo_epi32(v, s), b));
+    }
+    scale_offset_generic(dst + i, count - i, scale, bias);
+}
+
+__attribute__((target("avx2")))
+static size_t compare_avx2(const int* a, const int* b, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                        _mm256_loadu_si256((const __m256i*)(b + i)));
+        if ((uint32_t)_mm256_movemask_epi8(eq) != 0xffffffffu) {
+            break;
+        }
+    }
+    return i + compare_generic(a + i, b + i, count - i);
+}
+#endif
+
+#if defined(__ARM_NEON)
+static void fill_neon(int* dst, size_t count, int value) {
+    int32x4_t v = vdupq_n_s32(value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s32(dst + i, v);
+        vst1q_s32(dst + i + 4, v);
+    }
+    fill_generic(dst + i, count - i, value);
+}
+
+static void scale_offset_neon(int* dst, size_t count, int scale, int bias) {
+    int32x4_t b = vdupq_n_s32(bias);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_s32(dst + i, vmlaq_n_s32(b, vld1q_s32(dst + i), scale));
+    }
+    scale_offset_generic(dst + i, count - i, scale, bias);
+}
+
+static size_t compare_neon(const int* a, const int* b, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t eq = vceqq_s32(vld1q_s32(a + i), vld1q_s32(b + i));
+        uint32x2_t all = vpmin_u32(vget_low_u32(eq), vget_high_u32(eq));  // ARMv7 has no vminvq
+        all = vpmin_u32(all, all);
+        if (vget_lane_u32(all, 0) == 0) {
+            break;
+        }
+    }
+    return i + compare_generic(a + i, b + i, count - i);
+}
+#endif
+
+static const LumenBlockKernels* select_block_kernels(void) {
+    static const LumenBlockKernels generic = { fill_generic, scale_offset_generic, compare_generic, "generic" };
+    unsigned int features = lumen_cpu_features();
+    (void)features;
+#if defined(__x86_64__) || defined(__i386__)
+    static const LumenBlockKernels sse2 = { fill_sse2, scale_offset_sse2, compare_sse2, "sse2" };
+    static const LumenBlockKernels avx2 = { fill_avx2, scale_offset_avx2, compare_avx2, "avx2" };
+    if (features & LUMEN_CPU_AVX2) return &avx2;
+    if (features & LUMEN_CPU_SSE2) return &sse2;
+#endif
+#if defined(__ARM_NEON)
+    static const LumenBlockKernels neon = { fill_neon, scale_offset_neon, compare_neon, "neon" };
+    if (features & LUMEN_CPU_NEON) return &neon;
+#endif
+    return &generic;
+}
+
+// Name of the kernel set the range operations dispatch to right now
+const char* lumen_block_kernel_name(void) {
+    return select_block_kernels()->name;
+}
+
+static int lumen_range_valid(const LumenMemBlock* mem, size_t offset, size_t count) {
+    return mem != NULL && mem->data_ptr != NULL && offset <= mem->block_size &&
+           count <= mem->block_size - offset;
+}
+
+int lumen_fill_range(LumenMemBlock* mem, size_t offset, size_t count, int value) {
+    if (!lumen_range_valid(mem, offset, count)) {
+        return -1;
+    }
+    select_block_kernels()->fill(mem->data_ptr + offset, count, value);
     return 0;
 }
 
-// ---- Logging ----
-// Platform guards for Lumen OS on Armv7-A Moto Nexus 6
-#if defined(__arm__) && defined(__ARM_ARCH_7A__)
-#define LUMEN_SYSTEM 1
-#define DEVICE_SPEC "Moto Nexus 6"
+// Overlapping ranges within one block are fine
+int lumen_copy_range(LumenMemBlock* dst, size_t dst_offset, const LumenMemBlock* src,
+                     size_t src_offset, size_t count) {
+    if (!lumen_range_valid(dst, dst_offset, count) || !lumen_range_valid(src, src_offset, count)) {
+        return -1;
+    }
+    memmove(dst->data_ptr + dst_offset, src->data_ptr + src_offset, count * sizeof(int));
+    return 0;
+}
+
+// data[i] = data[i] * scale + bias (wrapping)
+int lumen_scale_offset_range(LumenMemBlock* mem, size_t offset, size_t count, int scale, int bias) {
+    if (!lumen_range_valid(mem, offset, count)) {
+        return -1;
+    }
+    select_block_kernels()->scale_offset(mem->data_ptr + offset, count, scale, bias);
+    return 0;
+}
+
+// 0 if the ranges match, 1 if not (first_diff gets the offset into the range), -1 on bad input
+int lumen_compare_range(const LumenMemBlock* a, size_t a_offset, const LumenMemBlock* b,
+                        size_t b_offset, size_t count, size_t* first_diff) {
+    if (!lumen_range_valid(a, a_offset, count) || !lumen_range_valid(b, b_offset, count)) {
+        return -1;
+    }
+    
+    size_t match = select_block_kernels()->compare(a->data_ptr + a_offset, b->data_ptr + b_offset, count);
+    if (first_diff != NULL) {
+        *first_diff = match;
+    }
+    return (match == count) ? 0 : 1;
+}
+
+// ---- Unit reductions ----
+// Sum, min, max, mean and variance over a LumenAllocUnit. Data is reduced
+// in leaves of LUMEN_REDUCE_LEAF values (vector kernel: sum/min/max, then
+// squared deviations from the leaf mean while it is still in cache), and
+// leaves are merged pairwise with Chan's update, so rounding error grows
+// with log(n) instead of n. Large units can be split across threads.
+// ARMv7 NEON has no double lanes, so the Nexus 6 runs the generic kernel.
+#define LUMEN_REDUCE_LEAF 2048
+#define LUMEN_REDUCE_PARALLEL_MIN (1 << 18)  // Elements before threads pay off
+#ifndef LUMEN_REDUCE_MAX_THREADS
+#ifdef LUMEN_PROFILE_NEXUS6
+#define LUMEN_REDUCE_MAX_THREADS 4  // Quad-core Snapdragon 805
 #else
-#error "Designed exclusively for Lumen OS on Armv7-A (Moto Nexus 6)"
+#define LUMEN_REDUCE_MAX_THREADS 8
+#endif
 #endif
 
-// Struct for logging operations in Lumen environment
+// Partial result of one range
 typedef struct {
-    char log_buffer[512];
-    char device_marker[128];
-    int log_level;
-    time_t timestamp;
-    int status_flag;
-} LumenLogHandler;
+    size_t count;
+    double sum;
+    double mean;
+    double m2;  // Sum of squared deviations from mean
+    double min;
+    double max;
+} LumenReducePart;
+
+typedef struct {
+    void (*sum_min_max)(const double* x, size_t n, double* sum, double* min, double* max);
+    double (*sq_dev)(const double* x, size_t n, double mean);
+    const char* name;
+} LumenReduceKernels;
+
+static void sum_min_max_generic(const double* x, size_t n, double* sum, double* min, double* max) {
+    double s0 = 0.0, s1 = 0.0, lo = x[0], hi = x[0];
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        s0 += x[i];
+        s1 += x[i + 1];
+        lo = (x[i] < lo) ? x[i] : lo;
+        hi = (x[i] > hi) ? x[i] : hi;
+        lo = (x[i + 1] < lo) ? x[i + 1] : lo;
+        hi = (x[i + 1] > hi) ? x[i + 1] : hi;
+    }
+    for (; i < n; i++) {
+        s0 += x[i];
+        lo = (x[i] < lo) ? x[i] : lo;
+        hi = (x[i] > hi) ? x[i] : hi;
+    }
+    *sum = s0 + s1;
+    *min = lo;
+    *max = hi;
+}
+
+static double sq_dev_generic(const double* x, size_t n, double mean) {
+    double s0 = 0.0, s1 = 0.0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        double d0 = x[i] - mean, d1 = x[i + 1] - mean;
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+    }
+    for (; i < n; i++) {
+        double d = x[i] - mean;
+        s0 += d * d;
+    }
+    return s0 + s1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static void sum_min_max_sse2(const double* x, size_t n, double* sum, double* min, double* max) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    __m128d lo = _mm_set1_pd(x[0]), hi = lo;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d a = _mm_loadu_pd(x + i), b = _mm_loadu_pd(x + i + 2);
+        s0 = _mm_add_pd(s0, a);
+        s1 = _mm_add_pd(s1, b);
+        lo = _mm_min_pd(lo, _mm_min_pd(a, b));
+        hi = _mm_max_pd(hi, _mm_max_pd(a, b));
+    }
+    double part[2], lo2[2], hi2[2];
+    _mm_storeu_pd(part, _mm_add_pd(s0, s1));
+    _mm_storeu_pd(lo2, lo);
+    _mm_storeu_pd(hi2, hi);
+    double tail_sum = 0.0, tail_lo = lo2[0], tail_hi = hi2[0];
+    if (i < n) sum_min_max_generic(x + i, n - i, &tail_sum, &tail_lo, &tail_hi);
+    *sum = (part[0] + part[1]) + tail_sum;
+    *min = fmin(fmin(lo2[0], lo2[1]), tail_lo);
+    *max = fmax(fmax(hi2[0], hi2[1]), tail_hi);
+}
+
+__attribute__((target("sse2")))
+static double sq_dev_sse2(const double* x, size_t n, double mean) {
+    __m128d m = _mm_set1_pd(mean), s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128d a = _mm_sub_pd(_mm_loadu_pd(x + i), m), b = _mm_sub_pd(_mm_loadu_pd(x + i + 2), m);
+        s0 = _mm_add_pd(s0, _mm_mul_pd(a, a));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(b, b));
+    }
+    double part[2];
+    _mm_storeu_pd(part, _mm_add_pd(s0, s1));
+    return (part[0] + part[1]) + sq_dev_generic(x + i, n - i, mean);
+}
+
+__attribute__((target("avx2")))
+static void sum_min_max_avx2(const double* x, size_t n, double* sum, double* min, double* max) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d lo = _mm256_set1_pd(x[0]), hi = lo;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d a = _mm256_loadu_pd(x + i), b = _mm256_loadu_pd(x + i + 4);
+        s0 = _mm256_add_pd(s0, a);
+        s1 = _mm256_add_pd(s1, b);
+        lo = _mm256_min_pd(lo, _mm256_min_pd(a, b));
+        hi = _mm256_max_pd(hi, _mm256_max_pd(a, b));
+    }
+    double part[4], lo4[4], hi4[4];
+    _mm256_storeu_pd(part, _mm256_add_pd(s0, s1));
+    _mm256_storeu_pd(lo4, lo);
+    _mm256_storeu_pd(hi4, hi);
+    double tail_sum = 0.0, tail_lo = lo4[0], tail_hi = hi4[0];
+    if (i < n) sum_min_max_generic(x + i, n - i, &tail_sum, &tail_lo, &tail_hi);
+    *sum = ((part[0] + part[1]) + (part[2] + part[3])) + tail_sum;
+    *min = fmin(fmin(fmin(lo4[0], lo4[1]), fmin(lo4[2], lo4[3])), tail_lo);
+    *max = fmax(fmax(fmax(hi4[0], hi4[1]), fmax(hi4[2], hi4[3])), tail_hi);
+}
+
+__attribute__((target("avx2")))
+static double sq_dev_avx2(const double* x, size_t n, double mean) {
+    __m256d m = _mm256_set1_pd(mean), s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d a = _mm256_sub_pd(_mm256_loadu_pd(x + i), m), b = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), m);
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(a, a));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(b, b));
+    }
+    double part[4];
+    _mm256_storeu_pd(part, _mm256_add_pd(s0, s1));
+    return ((part[0] + part[1]) + (part[2] + part[3])) + sq_dev_generic(x + i, n - i, mean);
+}
+#endif
+
+#if defined(__aarch64__)
+static void sum_min_max_neon(const double* x, size_t n, double* sum, double* min, double* max) {
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+    float64x2_t lo = vdupq_n_f64(x[0]), hi = lo;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float64x2_t a = vld1q_f64(x + i), b = vld1q_f64(x + i + 2);
+        s0 = vaddq_f64(s0, a);
+        s1 = vaddq_f64(s1, b);
+        lo = vminq_f64(lo, vminq_f64(a, b));
+        hi = vmaxq_f64(hi, vmaxq_f64(a, b));
+    }
+    double tail_sum = 0.0, tail_lo = vgetq_lane_f64(lo, 0), tail_hi = vgetq_lane_f64(hi, 0);
+    if (i < n) sum_min_max_generic(x + i, n - i, &tail_sum, &tail_lo, &tail_hi);
+    *sum = vaddvq_f64(vaddq_f64(s0, s1)) + tail_sum;
+    *min = fmin(vminvq_f64(lo), tail_lo);
+    *max = fmax(vmaxvq_f64(hi), tail_hi);
+}
+
+static double sq_dev_neon(const double* x, size_t n, double mean) {
+    float64x2_t m = vdupq_n_f64(mean), s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float64x2_t a = vsubq_f64(vld1q_f64(x + i), m), b = vsubq_f64(vld1q_f64(x + i + 2), m);
+        s0 = vfmaq_f64(s0, a, a);
+        s1 = vfmaq_f64(s1, b, b);
+    }
+    return vaddvq_f64(vaddq_f64(s0, s1)) + sq_dev_generic(x + i, n - i, mean);
+}
+#endif
+
+static const LumenReduceKernels* select_reduce_kernels(void) {
+    static const LumenReduceKernels generic = { sum_min_max_generic, sq_dev_generic, "generic" };
+    unsigned int features = lumen_cpu_features();
+    (void)features;
+#if defined(__x86_64__) || defined(__i386__)
+    static const LumenReduceKernels sse2 = { sum_min_max_sse2, sq_dev_sse2, "sse2" };
+    static const LumenReduceKernels avx2 = { sum_min_max_avx2, sq_dev_avx2, "avx2" };
+    if (features & LUMEN_CPU_AVX2) return &avx2;
+    if (features & LUMEN_CPU_SSE2) return &sse2;
+#endif
+#if defined(__aarch64__)
+    static const LumenReduceKernels neon = { sum_min_max_neon, sq_dev_neon, "neon" };
+    if (features & LUMEN_CPU_NEON) return &neon;
+#endif
+    return &generic;
+}
+
+// Name of the kernel set the reductions dispatch to right now
+const char* lumen_reduce_kernel_name(void) {
+    return select_reduce_kernels()->name;
+}
+
+// Chan et al. pairwise combination of two partial results
+static LumenReducePart lumen_reduce_merge(LumenReducePart a, LumenReducePart b) {
+    LumenReducePart out;
+    
+    if (a.count == 0) return b;
+    if (b.count == 0) return a;
+    
+    double n = (double)(a.count + b.count);
+    double delta = b.mean - a.mean;
+    out.count = a.count + b.count;
+    out.sum = a.sum + b.sum;
+    out.mean = a.mean + delta * ((double)b.count / n);
+    out.m2 = a.m2 + b.m2 + delta * delta * ((double)a.count * (double)b.count / n);
+    out.min = (a.min < b.min) ? a.min : b.min;
+    out.max = (a.max > b.max) ? a.max : b.max;
+    return out;
+}
+
+static LumenReducePart lumen_reduce_range(const LumenReduceKernels* k, const double* x, size_t n) {
+    LumenReducePart part;
+    
+    if (n <= LUMEN_REDUCE_LEAF) {
+        part.count = n;
+        if (n == 0) {
+            part.sum = part.mean = part.m2 = part.min = part.max = 0.0;
+            return part;
+        }
+        k->sum_min_max(x, n, &part.sum, &part.min, &part.max);
+        part.mean = part.sum / (double)n;
+        part.m2 = k->sq_dev(x, n, part.mean);
+        return part;
+    }
+    
+    size_t half = (n / 2 + LUMEN_REDUCE_LEAF - 1) / LUMEN_REDUCE_LEAF * LUMEN_REDUCE_LEAF;
+    return lumen_reduce_merge(lumen_reduce_range(k, x, half), lumen_reduce_range(k, x + half, n - half));
+}
+
+typedef struct {
+    const LumenReduceKernels* kernels;
+    const double* data;
+    size_t count;
+    LumenReducePart result;
+} LumenReduceTask;
+
+static void* lumen_reduce_worker(void* arg) {
+    LumenReduceTask* task = (LumenReduceTask*)arg;
+    task->result = lumen_reduce_range(task->kernels, task->data, task->count);
+    return NULL;
+}
+
+// Stats over values[offset, offset + count). threads: 0 = automatic
+// (parallel above LUMEN_REDUCE_PARALLEL_MIN), 1 = calling thread only.
+int lumen_unit_stats_range(const LumenAllocUnit* unit, size_t offset, size_t count,
+                           int threads, LumenUnitStats* out) {
+    const LumenReduceKernels* kernels = select_reduce_kernels();
+    LumenReducePart total;
+    
+    if (unit == NULL || unit->values == NULL || out == NULL || offset > unit->alloc_count ||
+        count > unit->alloc_count - offset || count == 0) {
+        return -1;
+    }
+    
+    const double* data = unit->values + offset;
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (count >= LUMEN_REDUCE_PARALLEL_MIN && online > 1) ? (int)online : 1;
+    }
+    if (threads > LUMEN_REDUCE_MAX_THREADS) threads = LUMEN_REDUCE_MAX_THREADS;
+    if ((size_t)threads > count / LUMEN_REDUCE_LEAF) threads = (int)(count / LUMEN_REDUCE_LEAF);
+    
+    if (threads <= 1) {
+        total = lumen_reduce_range(kernels, data, count);
+    } else {
+        LumenReduceTask tasks[LUMEN_REDUCE_MAX_THREADS];
+        pthread_t workers[LUMEN_REDUCE_MAX_THREADS];
+        int started[LUMEN_REDUCE_MAX_THREADS];
+        size_t per_thread = count / threads;
+        
+        for (int t = 0; t < threads; t++) {
+            tasks[t].kernels = kernels;
+            tasks[t].data = data + t * per_thread;
+            tasks[t].count = (t == threads - 1) ? count - t * per_thread : per_thread;
+            started[t] = (t > 0) && pthread_create(&workers[t], NULL, lumen_reduce_worker, &tasks[t]) == 0;
+        }
+        
+        // The caller takes the first slice, and any slice whose thread failed to start
+        for (int t = 0; t < threads; t++) {
+            if (!started[t]) lumen_reduce_worker(&tasks[t]);
+        }
+        for (int t = 1; t < threads; t++) {
+            if (started[t]) pthread_join(workers[t], NULL);
+        }
+        
+        // Merge neighbours pairwise, like the leaves
+        for (int step = 1; step < threads; step *= 2) {
+            for (int t = 0; t + step < threads; t += 2 * step) {
+                tasks[t].result = lumen_reduce_merge(tasks[t].result, tasks[t + step].result);
+            }
+        }
+        total = tasks[0].result;
+    }
+    
+    out->count = total.count;
+    out->sum = total.sum;
+    out->min = total.min;
+    out->max = total.max;
+    out->mean = total.mean;
+    out->variance = total.m2 / (double)total.count;
+    return 0;
+}
+
+int lumen_unit_stats(const LumenAllocUnit* unit, LumenUnitStats* out) {
+    if (unit == NULL) {
+        return -1;
+    }
+    return lumen_unit_stats_range(unit, 0, unit->alloc_count, 0, out);
+}
+
+// ---- Logging ----
+// Device marker follows the selected profile
+#ifdef LUMEN_PROFILE_NEXUS6
+#define LUMEN_SYSTEM 1
+#endif
+#define DEVICE_SPEC LUMEN_DEVICE_NAME
 
 // Initialize the log handler with device specifics
 LumenLogHandler* create_lumen_logger(int level) {
@@ -380,1001 +1614,4696 @@ LumenLogHandler* create_lumen_logger(int level) {
     
     handler->log_level = level;
     handler->status_flag = 0;  // Initialized
+    handler->time_precision = LUMEN_TS_SECONDS;
     time(&handler->timestamp);
     
-    // Set device marker for logs
-    snprintf(handler->device_marker, sizeof(handler->device_marker), "[Lumen OS - %s]", DEVICE_SPEC);
+    // Set device marker for logs
+    snprintf(handler->device_marker, sizeof(handler->device_marker), "[Lumen OS - %s]", DEVICE_SPEC);
+    
+    return handler;
+}
+
+// Function to record a log message with timestamp and level
+void record_lumen_log(LumenLogHandler* handler, const char* message, int level) {
+    if (handler == NULL || message == NULL) {
+        return;
+    }
+    
+    if (level >= handler->log_level) {
+        time_t sec = handler->timestamp;
+        long nsec = 0;
+        if (handler->time_precision > 0) {
+            lumen_clock_now(&sec, &nsec);
+        }
+        
+        if (lumen_binlog_submit(sec, nsec, handler->time_precision, level, message) == 0) {
+            handler->status_flag = 2;  // Written by the binary backend
+            return;
+        }
+        
+        int queued = lumen_async_log_submit(sec, nsec, handler->time_precision, level, message);
+        if (queued >= 0) {
+            handler->status_flag = (queued == 0) ? 2 : -2;  // Queued / Dropped
+            return;
+        }
+        
+        char time_str[64];
+        lumen_format_timestamp(sec, nsec, handler->time_precision, time_str, sizeof(time_str));
+        
+        snprintf(handler->log_buffer, sizeof(handler->log_buffer), 
+                 "%s %s [Level %d]: %s\n", 
+                 handler->device_marker, time_str, level, message);
+        
+        handler->status_flag = 1;  // Logged
+    } else {
+        handler->status_flag = -1;  // Level too low
+    }
+}
+
+// Function to output the log with Lumen-specific handling
+void output_lumen_log(LumenLogHandler* handler) {
+    if (handler != NULL && (handler->status_flag == 2 || handler->status_flag == -2)) {
+        return;  // Owned by a backend (or counted as dropped)
+    }
+    if (handler != NULL && handler->status_flag == 1) {
+#ifdef LUMEN_SYSTEM
+        // Simulate Lumen mobile logging (e.g., to console or file)
+        printf("%s", handler->log_buffer);
+#else
+        printf("Log: %s", handler->log_buffer);
+#endif
+        // Reset buffer after output
+        memset(handler->log_buffer, 0, sizeof(handler->log_buffer));
+    } else {
+        printf("No log to output or error occurred\n");
+    }
+}
+
+// Function to release the logger resources
+void release_lumen_logger(LumenLogHandler* handler) {
+    if (handler != NULL) {
+        free(handler);
+    }
+}
+
+// Function to initialize on boot
+
+// Texts
+
+// ---- Async logging ----
+// Producers push fixed-size records into a bounded lock-free MPSC ring
+// (Vyukov sequence-numbered cells); one writer thread formats and writes
+// them in batches and sleeps on a condition variable while the ring is
+// empty. Under BLOCK, producers facing a full ring sleep on a second one
+// until the writer frees cells. record_lumen_log routes here while the
+// backend runs.
+#ifndef LUMEN_ASYNC_DEFAULT_CAPACITY
+#ifdef LUMEN_PROFILE_NEXUS6
+#define LUMEN_ASYNC_DEFAULT_CAPACITY 1024  // ~200KB ring on a 3GB phone
+#else
+#define LUMEN_ASYNC_DEFAULT_CAPACITY 4096
+#endif
+#endif
+#define LUMEN_ASYNC_BATCH 64
+
+typedef struct {
+    atomic_size_t sequence;
+    time_t timestamp;
+    long nsec;
+    int precision;
+    int level;
+    char message[LUMEN_ASYNC_MSG_MAX];
+} LumenLogRecord;
+
+typedef struct {
+    LumenLogRecord* cells;
+    size_t mask;
+    _Alignas(64) atomic_size_t enqueue_pos;
+    _Alignas(64) size_t dequeue_pos;  // Writer thread only
+    int overflow_policy;
+    FILE* sink;
+    pthread_t writer;
+    atomic_int running;
+    atomic_int producers;     // Submitters past the running check; stop waits for zero
+    atomic_int stopping;      // Set once producers are gone: final drain and exit
+    atomic_int writer_idle;   // Writer is (about to be) asleep on wake
+    atomic_int space_waiters; // BLOCK producers (about to be) asleep on space
+    pthread_mutex_t wake_lock;
+    pthread_cond_t wake;
+    pthread_cond_t space;
+    atomic_ulong submitted;
+    atomic_ulong dropped;
+    atomic_ulong blocked;
+    atomic_ulong truncated;
+    unsigned long written;
+    unsigned long batches;
+} LumenAsyncLogger;
+
+static LumenAsyncLogger lumen_async_log;
+
+static int lumen_async_try_push(LumenAsyncLogger* q, time_t timestamp, long nsec, int precision,
+                                int level, const char* message) {
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    LumenLogRecord* cell;
+    
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;  // Full
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    
+    cell->timestamp = timestamp;
+    cell->nsec = nsec;
+    cell->precision = precision;
+    cell->level = level;
+    size_t len = strnlen(message, LUMEN_ASYNC_MSG_MAX - 1);
+    memcpy(cell->message, message, len);
+    cell->message[len] = '\0';
+    
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return 0;
+}
+
+// Wake the writer if it went to sleep on an empty ring
+static void lumen_async_wake(LumenAsyncLogger* q) {
+    atomic_thread_fence(memory_order_seq_cst);  // Pairs with the fence in lumen_async_wait
+    if (atomic_load_explicit(&q->writer_idle, memory_order_relaxed)) {
+        pthread_mutex_lock(&q->wake_lock);
+        pthread_cond_signal(&q->wake);
+        pthread_mutex_unlock(&q->wake_lock);
+    }
+}
+
+// Is the next cell to enqueue still waiting for the writer?
+static int lumen_async_full(LumenAsyncLogger* q) {
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    size_t seq = atomic_load_explicit(&q->cells[pos & q->mask].sequence, memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)pos < 0;
+}
+
+// Writer side: wake BLOCK producers once a drain has freed cells
+static void lumen_async_release_space(LumenAsyncLogger* q) {
+    atomic_thread_fence(memory_order_seq_cst);  // Pairs with the fence in lumen_async_wait_space
+    if (atomic_load_explicit(&q->space_waiters, memory_order_relaxed)) {
+        pthread_mutex_lock(&q->wake_lock);
+        pthread_cond_broadcast(&q->space);
+        pthread_mutex_unlock(&q->wake_lock);
+    }
+}
+
+// Producer side: sleep while the ring is full and the backend runs
+static void lumen_async_wait_space(LumenAsyncLogger* q) {
+    pthread_mutex_lock(&q->wake_lock);
+    atomic_fetch_add_explicit(&q->space_waiters, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);  // Pairs with the fence in lumen_async_release_space
+    while (lumen_async_full(q) && atomic_load_explicit(&q->running, memory_order_relaxed)) {
+        pthread_cond_wait(&q->space, &q->wake_lock);
+    }
+    atomic_fetch_sub_explicit(&q->space_waiters, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&q->wake_lock);
+}
+
+static int lumen_async_push_and_wake(LumenAsyncLogger* q, time_t timestamp, long nsec, int precision,
+                                     int level, const char* message) {
+    if (lumen_async_try_push(q, timestamp, nsec, precision, level, message) != 0) {
+        return -1;
+    }
+    lumen_async_wake(q);
+    return 0;
+}
+
+int lumen_async_log_submit(time_t timestamp, long nsec, int precision, int level, const char* message) {
+    LumenAsyncLogger* q = &lumen_async_log;
+    int result = 1;
+    
+    // Register before checking running, so stop cannot free the ring under us
+    atomic_fetch_add(&q->producers, 1);
+    if (!atomic_load(&q->running)) {
+        atomic_fetch_sub(&q->producers, 1);
+        return -1;
+    }
+    
+    atomic_fetch_add_explicit(&q->submitted, 1, memory_order_relaxed);
+    if (lumen_async_push_and_wake(q, timestamp, nsec, precision, level, message) == 0) {
+        result = 0;
+    } else if (q->overflow_policy == LUMEN_LOG_OVERFLOW_BLOCK) {
+        atomic_fetch_add_explicit(&q->blocked, 1, memory_order_relaxed);
+        while (atomic_load_explicit(&q->running, memory_order_acquire)) {
+            lumen_async_wait_space(q);
+            if (lumen_async_push_and_wake(q, timestamp, nsec, precision, level, message) == 0) {
+                result = 0;
+                break;
+            }
+        }
+    }
+    
+    if (result != 0) {
+        atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+    } else if (strnlen(message, LUMEN_ASYNC_MSG_MAX) == LUMEN_ASYNC_MSG_MAX) {
+        atomic_fetch_add_explicit(&q->truncated, 1, memory_order_relaxed);
+    }
+    atomic_fetch_sub_explicit(&q->producers, 1, memory_order_release);
+    return result;
+}
+
+// Writer thread only: is the next cell published?
+static int lumen_async_pending(LumenAsyncLogger* q) {
+    LumenLogRecord* cell = &q->cells[q->dequeue_pos & q->mask];
+    size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    return (intptr_t)seq - (intptr_t)(q->dequeue_pos + 1) >= 0;
+}
+
+// Sleep until a producer publishes into the empty ring or stop is requested
+static void lumen_async_wait(LumenAsyncLogger* q) {
+    pthread_mutex_lock(&q->wake_lock);
+    atomic_store_explicit(&q->writer_idle, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);  // Pairs with the fence in lumen_async_wake
+    while (!lumen_async_pending(q) && !atomic_load_explicit(&q->stopping, memory_order_relaxed)) {
+        pthread_cond_wait(&q->wake, &q->wake_lock);
+    }
+    atomic_store_explicit(&q->writer_idle, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&q->wake_lock);
+}
+
+// Drain up to one batch into a single write. Returns records written.
+static int lumen_async_drain(LumenAsyncLogger* q, const char* marker) {
+    char out[LUMEN_ASYNC_BATCH * (LUMEN_ASYNC_MSG_MAX + 96)];
+    size_t used = 0;
+    int count = 0;
+    
+    while (count < LUMEN_ASYNC_BATCH && lumen_async_pending(q)) {
+        LumenLogRecord* cell = &q->cells[q->dequeue_pos & q->mask];
+        char time_str[64];
+        lumen_format_timestamp(cell->timestamp, cell->nsec, cell->precision, time_str, sizeof(time_str));
+        
+        int n = snprintf(out + used, sizeof(out) - used, "%s %s [Level %d]: %s\n",
+                         marker, time_str, cell->level, cell->message);
+        if (n > 0) {
+            used += ((size_t)n < sizeof(out) - used) ? (size_t)n : sizeof(out) - used - 1;
+        }
+        
+        atomic_store_explicit(&cell->sequence, q->dequeue_pos + q->mask + 1, memory_order_release);
+        q->dequeue_pos++;
+        count++;
+    }
+    
+    if (used > 0) {
+        fwrite(out, 1, used, q->sink);
+        fflush(q->sink);
+        q->written += count;
+        q->batches++;
+    }
+    return count;
+}
+
+static void* lumen_async_writer(void* arg) {
+    LumenAsyncLogger* q = (LumenAsyncLogger*)arg;
+    char marker[128];
+    
+    snprintf(marker, sizeof(marker), "[Lumen OS - %s]", DEVICE_SPEC);
+    
+    while (!atomic_load_explicit(&q->stopping, memory_order_acquire)) {
+        if (lumen_async_drain(q, marker) == 0) {
+            lumen_async_wait(q);
+        } else {
+            lumen_async_release_space(q);
+        }
+    }
+    
+    // Producers are gone: flush whatever they left behind
+    while (lumen_async_drain(q, marker) > 0) {
+    }
+    return NULL;
+}
+
+// Start the backend. capacity is rounded up to a power of two; sink defaults to stdout.
+int lumen_async_log_start(size_t capacity, int overflow_policy, FILE* sink) {
+    LumenAsyncLogger* q = &lumen_async_log;
+    size_t cells = 2;
+    
+    if (atomic_load(&q->running)) {
+        return -1;
+    }
+    if (capacity == 0) {
+        capacity = LUMEN_ASYNC_DEFAULT_CAPACITY;
+    }
+    while (cells < capacity) {
+        cells <<= 1;
+    }
+    
+    q->cells = (LumenLogRecord*)calloc(cells, sizeof(LumenLogRecord));
+    if (q->cells == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < cells; i++) {
+        atomic_init(&q->cells[i].sequence, i);
+    }
+    
+    q->mask = cells - 1;
+    atomic_init(&q->enqueue_pos, 0);
+    q->dequeue_pos = 0;
+    q->overflow_policy = overflow_policy;
+    q->sink = sink ? sink : stdout;
+    atomic_init(&q->submitted, 0);
+    atomic_init(&q->dropped, 0);
+    atomic_init(&q->blocked, 0);
+    atomic_init(&q->truncated, 0);
+    q->written = 0;
+    q->batches = 0;
+    atomic_init(&q->stopping, 0);
+    atomic_init(&q->writer_idle, 0);
+    atomic_init(&q->space_waiters, 0);
+    pthread_mutex_init(&q->wake_lock, NULL);
+    pthread_cond_init(&q->wake, NULL);
+    pthread_cond_init(&q->space, NULL);
+    
+    atomic_store(&q->running, 1);
+    if (pthread_create(&q->writer, NULL, lumen_async_writer, q) != 0) {
+        atomic_store(&q->running, 0);
+        pthread_cond_destroy(&q->space);
+        pthread_cond_destroy(&q->wake);
+        pthread_mutex_destroy(&q->wake_lock);
+        free(q->cells);
+        q->cells = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// Stop accepting records, flush the ring and join the writer. Late records
+// fall back to the sync path; submitters already past the running check
+// finish (or give up, under BLOCK) before the ring is flushed and freed.
+void lumen_async_log_stop(void) {
+    LumenAsyncLogger* q = &lumen_async_log;
+    
+    if (!atomic_exchange(&q->running, 0)) {
+        return;
+    }
+    pthread_mutex_lock(&q->wake_lock);
+    pthread_cond_broadcast(&q->space);  // BLOCK producers give up
+    pthread_mutex_unlock(&q->wake_lock);
+    while (atomic_load(&q->producers) > 0) {
+        sched_yield();
+    }
+    
+    pthread_mutex_lock(&q->wake_lock);
+    atomic_store_explicit(&q->stopping, 1, memory_order_release);
+    pthread_cond_signal(&q->wake);
+    pthread_mutex_unlock(&q->wake_lock);
+    
+    pthread_join(q->writer, NULL);
+    pthread_cond_destroy(&q->space);
+    pthread_cond_destroy(&q->wake);
+    pthread_mutex_destroy(&q->wake_lock);
+    free(q->cells);
+    q->cells = NULL;
+}
+
+void print_lumen_async_stats(void) {
+    LumenAsyncLogger* q = &lumen_async_log;
+    
+    printf("Async log: submitted=%lu written=%lu dropped=%lu blocked=%lu truncated=%lu batches=%lu\n",
+           atomic_load(&q->submitted), q->written, atomic_load(&q->dropped),
+           atomic_load(&q->blocked), atomic_load(&q->truncated), q->batches);
+}
+
+// ---- Binary logging ----
+// On-device logs as (format-id, timestamp, level, raw args) records. The
+// device marker lives once in the file header and each format string once in
+// a definition entry written at registration, so a log call only copies its
+// arguments. lumen_binlog_decode turns a file back into the text format.
+#define LUMEN_BINLOG_MAGIC "LUMB"
+#define LUMEN_BINLOG_VERSION 1
+#define LUMEN_BINLOG_RECORD_MAX 1024
+#define LUMEN_BINLOG_FMT_MESSAGE 0   // "%s", used by record_lumen_log
+
+#define LUMEN_BINLOG_ENTRY_FORMAT 1
+#define LUMEN_BINLOG_ENTRY_RECORD 2
+
+// Strings are cut to fit, so a record must hold the header and every fixed-size argument
+_Static_assert(LUMEN_BINLOG_RECORD_MAX >= 32 + LUMEN_BINLOG_MAX_ARGS * sizeof(int64_t),
+               "binary log record too small for LUMEN_BINLOG_MAX_ARGS arguments");
+
+// Argument kinds stored in a format's signature. long and long long are both
+// stored as 64 bits but read from va_list with their own type.
+#define LUMEN_BINARG_INT 'i'
+#define LUMEN_BINARG_LONG 'l'
+#define LUMEN_BINARG_LONGLONG 'L'
+#define LUMEN_BINARG_DOUBLE 'd'
+#define LUMEN_BINARG_STRING 's'
+
+static _Atomic(LumenBinLogger*) lumen_binlog_active = NULL;
+
+// Stored size of an argument, strings counted as an empty one
+static size_t lumen_binarg_min_size(char kind) {
+    switch (kind) {
+        case LUMEN_BINARG_INT: return sizeof(int32_t);
+        case LUMEN_BINARG_STRING: return sizeof(uint16_t);
+        default: return sizeof(int64_t);
+    }
+}
+
+// Build the argument signature of a printf-style format. Returns arg count or -1.
+static int lumen_binlog_signature(const char* format, char* signature) {
+    int count = 0;
+    
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+        while (*p && strchr("-+ #0123456789.", *p)) {
+            p++;
+        }
+        
+        int longs = 0;
+        while (*p == 'l' || *p == 'h') {
+            longs += (*p == 'l');
+            p++;
+        }
+        
+        if (count == LUMEN_BINLOG_MAX_ARGS || *p == '\0') {
+            return -1;
+        }
+        if (strchr("diuxXc", *p)) {
+            signature[count++] = (longs >= 2) ? LUMEN_BINARG_LONGLONG
+                               : (longs == 1) ? LUMEN_BINARG_LONG : LUMEN_BINARG_INT;
+        } else if (strchr("fgeGE", *p)) {
+            signature[count++] = LUMEN_BINARG_DOUBLE;
+        } else if (*p == 's') {
+            signature[count++] = LUMEN_BINARG_STRING;
+        } else {
+            return -1;  // %p, %n, %*d... are not recorded
+        }
+    }
+    
+    signature[count] = '\0';
+    return count;
+}
+
+// Register a format (the string must outlive the logger). Returns its id or -1.
+int lumen_binlog_register(LumenBinLogger* log, const char* format) {
+    LumenBinFormat* entry;
+    
+    if (log == NULL || format == NULL || log->format_count == LUMEN_BINLOG_MAX_FORMATS) {
+        return -1;
+    }
+    
+    entry = &log->formats[log->format_count];
+    if (lumen_binlog_signature(format, entry->signature) < 0) {
+        return -1;
+    }
+    entry->format = format;
+    
+    uint8_t kind = LUMEN_BINLOG_ENTRY_FORMAT;
+    uint16_t id = (uint16_t)log->format_count;
+    uint16_t len = (uint16_t)strnlen(format, UINT16_MAX);
+    fwrite(&kind, sizeof(kind), 1, log->file);
+    fwrite(&id, sizeof(id), 1, log->file);
+    fwrite(&len, sizeof(len), 1, log->file);
+    fwrite(format, 1, len, log->file);
+    atomic_fetch_add(&log->bytes, sizeof(kind) + sizeof(id) + sizeof(len) + len);
+    
+    return log->format_count++;
+}
+
+LumenBinLogger* create_lumen_binlog(const char* path, int level) {
+    LumenBinLogger* log = (LumenBinLogger*)calloc(1, sizeof(LumenBinLogger));
+    char marker[128];
+    
+    if (log == NULL) {
+        return NULL;
+    }
+    
+    log->file = fopen(path, "wb");
+    if (log->file == NULL) {
+        free(log);
+        return NULL;
+    }
+    log->log_level = level;
+    log->time_precision = LUMEN_TS_MICROS;
+    
+    // Header: magic, version, device marker
+    snprintf(marker, sizeof(marker), "[Lumen OS - %s]", DEVICE_SPEC);
+    uint16_t version = LUMEN_BINLOG_VERSION;
+    uint16_t marker_len = (uint16_t)strlen(marker);
+    fwrite(LUMEN_BINLOG_MAGIC, 1, 4, log->file);
+    fwrite(&version, sizeof(version), 1, log->file);
+    fwrite(&marker_len, sizeof(marker_len), 1, log->file);
+    fwrite(marker, 1, marker_len, log->file);
+    atomic_init(&log->bytes, 4 + sizeof(version) + sizeof(marker_len) + marker_len);
+    
+    lumen_binlog_register(log, "%s");  // LUMEN_BINLOG_FMT_MESSAGE
+    return log;
+}
+
+// Encode and append one record. String arguments are cut so the ones after
+// them still fit. Returns 0 when written, 1 when filtered by level, -1 on error.
+static int lumen_binlog_vwrite(LumenBinLogger* log, int format_id, time_t sec, long nsec,
+                               int precision, int level, va_list args) {
+    uint8_t record[LUMEN_BINLOG_RECORD_MAX];
+    size_t used = 0;
+    int truncated = 0;
+    
+    if (log == NULL || format_id < 0 || format_id >= log->format_count) {
+        return -1;
+    }
+    if (level < log->log_level) {
+        return 1;
+    }
+    
+    uint8_t kind = LUMEN_BINLOG_ENTRY_RECORD;
+    uint16_t id = (uint16_t)format_id;
+    int64_t stamp = (int64_t)sec;
+    int32_t frac = (int32_t)nsec;
+    int8_t digits = (int8_t)precision;
+    int32_t lvl = level;
+    
+#define LUMEN_BINLOG_PUT(ptr, n) do { memcpy(record + used, (ptr), (n)); used += (n); } while (0)
+    LUMEN_BINLOG_PUT(&kind, sizeof(kind));
+    LUMEN_BINLOG_PUT(&id, sizeof(id));
+    LUMEN_BINLOG_PUT(&stamp, sizeof(stamp));
+    LUMEN_BINLOG_PUT(&frac, sizeof(frac));
+    LUMEN_BINLOG_PUT(&digits, sizeof(digits));
+    LUMEN_BINLOG_PUT(&lvl, sizeof(lvl));
+    
+    // Room the arguments after the current one need at minimum; the header
+    // plus LUMEN_BINLOG_MAX_ARGS 64-bit arguments always fit in a record
+    const char* signature = log->formats[format_id].signature;
+    size_t reserve = 0;
+    for (const char* sig = signature; *sig; sig++) {
+        reserve += lumen_binarg_min_size(*sig);
+    }
+    
+    for (const char* sig = signature; *sig; sig++) {
+        reserve -= lumen_binarg_min_size(*sig);
+        if (*sig == LUMEN_BINARG_INT) {
+            int32_t v = va_arg(args, int);
+            LUMEN_BINLOG_PUT(&v, sizeof(v));
+        } else if (*sig == LUMEN_BINARG_LONG) {
+            int64_t v = va_arg(args, long);
+            LUMEN_BINLOG_PUT(&v, sizeof(v));
+        } else if (*sig == LUMEN_BINARG_LONGLONG) {
+            int64_t v = va_arg(args, long long);
+            LUMEN_BINLOG_PUT(&v, sizeof(v));
+        } else if (*sig == LUMEN_BINARG_DOUBLE) {
+            double v = va_arg(args, double);
+            LUMEN_BINLOG_PUT(&v, sizeof(v));
+        } else {
+            const char* str = va_arg(args, const char*);
+            size_t room = sizeof(record) - used - sizeof(uint16_t) - reserve;
+            uint16_t len = 0;
+            if (str) {
+                len = (uint16_t)strnlen(str, room);
+                truncated |= (len == room && str[len] != '\0');
+            }
+            LUMEN_BINLOG_PUT(&len, sizeof(len));
+            LUMEN_BINLOG_PUT(str, len);
+        }
+    }
+#undef LUMEN_BINLOG_PUT
+    
+    // One stdio call per record keeps records whole across threads
+    if (fwrite(record, 1, used, log->file) != used) {
+        atomic_fetch_add_explicit(&log->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+    if (truncated) {
+        atomic_fetch_add_explicit(&log->truncated, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&log->records, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&log->bytes, used, memory_order_relaxed);
+    return 0;
+}
+
+// Log with a registered format; arguments follow printf (int, long for %ld,
+// long long for %lld, double, const char*)
+int lumen_binlog_write(LumenBinLogger* log, int format_id, int level, ...) {
+    time_t sec;
+    long nsec;
+    va_list args;
+    
+    if (log == NULL) {
+        return -1;
+    }
+    lumen_clock_now(&sec, &nsec);
+    
+    va_start(args, level);
+    int result = lumen_binlog_vwrite(log, format_id, sec, nsec, log->time_precision, level, args);
+    va_end(args);
+    return result;
+}
+
+static int lumen_binlog_message(LumenBinLogger* log, time_t sec, long nsec, int precision,
+                                int level, ...) {
+    va_list args;
+    va_start(args, level);
+    int result = lumen_binlog_vwrite(log, LUMEN_BINLOG_FMT_MESSAGE, sec, nsec, precision, level, args);
+    va_end(args);
+    return result;
+}
+
+// Returns 0 when the binary backend took the message (written or below its
+// level), -1 when it is detached or the write failed so the caller falls back
+int lumen_binlog_submit(time_t timestamp, long nsec, int precision, int level, const char* message) {
+    LumenBinLogger* log = atomic_load_explicit(&lumen_binlog_active, memory_order_acquire);
+    
+    if (log == NULL) {
+        return -1;
+    }
+    return (lumen_binlog_message(log, timestamp, nsec, precision, level, message) < 0) ? -1 : 0;
+}
+
+// Route record_lumen_log through log (NULL detaches)
+void lumen_binlog_attach(LumenBinLogger* log) {
+    atomic_store_explicit(&lumen_binlog_active, log, memory_order_release);
+}
+
+// Detaches log if it is attached; loggers on other threads must be done with it
+void release_lumen_binlog(LumenBinLogger* log) {
+    if (log != NULL) {
+        LumenBinLogger* expected = log;
+        atomic_compare_exchange_strong(&lumen_binlog_active, &expected, NULL);
+        fclose(log->file);
+        free(log);
+    }
+}
+
+void print_lumen_binlog_stats(LumenBinLogger* log) {
+    if (log == NULL) {
+        return;
+    }
+    printf("Binary log: records=%lu bytes=%lu truncated=%lu dropped=%lu\n",
+           atomic_load(&log->records), atomic_load(&log->bytes),
+           atomic_load(&log->truncated), atomic_load(&log->dropped));
+}
+
+// Render one conversion spec with the next raw argument
+static int lumen_binlog_render(FILE* in, const char* format, const char* signature, char* out, size_t out_size) {
+    size_t used = 0;
+    int arg = 0;
+    
+    for (const char* p = format; *p && used + 1 < out_size; p++) {
+        if (*p != '%') {
+            out[used++] = *p;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            p++;
+            continue;
+        }
+        
+        char spec[32];
+        size_t spec_len = 0;
+        const char* start = p;
+        p++;
+        while (*p && !strchr("diuxXcfgeGEs", *p)) {
+            p++;
+        }
+        spec_len = (size_t)(p - start) + 1;
+        if (spec_len >= sizeof(spec) || signature[arg] == '\0') {
+            return -1;
+        }
+        memcpy(spec, start, spec_len);
+        spec[spec_len] = '\0';
+        
+        int n = 0;
+        size_t room = out_size - used;
+        if (signature[arg] == LUMEN_BINARG_INT) {
+            int32_t v;
+            if (fread(&v, sizeof(v), 1, in) != 1) return -1;
+            n = snprintf(out + used, room, spec, (int)v);
+        } else if (signature[arg] == LUMEN_BINARG_LONG) {
+            int64_t v;
+            if (fread(&v, sizeof(v), 1, in) != 1) return -1;
+            n = snprintf(out + used, room, spec, (long)v);
+        } else if (signature[arg] == LUMEN_BINARG_LONGLONG) {
+            int64_t v;
+            if (fread(&v, sizeof(v), 1, in) != 1) return -1;
+            n = snprintf(out + used, room, spec, (long long)v);
+        } else if (signature[arg] == LUMEN_BINARG_DOUBLE) {
+            double v;
+            if (fread(&v, sizeof(v), 1, in) != 1) return -1;
+            n = snprintf(out + used, room, spec, v);
+        } else {
+            char str[LUMEN_BINLOG_RECORD_MAX];
+            uint16_t len;
+            if (fread(&len, sizeof(len), 1, in) != 1 || len >= sizeof(str)) return -1;
+            if (fread(str, 1, len, in) != len) return -1;
+            str[len] = '\0';
+            n = snprintf(out + used, room, spec, str);
+        }
+        
+        if (n > 0) {
+            used += ((size_t)n < room) ? (size_t)n : room - 1;
+        }
+        arg++;
+    }
+    
+    out[used] = '\0';
+    return 0;
+}
+
+// Decode a binary log into the text format. Returns records decoded or -1.
+int lumen_binlog_decode(FILE* in, FILE* out) {
+    LumenBinFormat formats[LUMEN_BINLOG_MAX_FORMATS];
+    char* strings[LUMEN_BINLOG_MAX_FORMATS] = {0};
+    char marker[128];
+    char magic[4];
+    uint16_t version, marker_len;
+    int format_count = 0;
+    int records = 0;
+    uint8_t kind;
+    
+    if (fread(magic, 1, 4, in) != 4 || memcmp(magic, LUMEN_BINLOG_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, in) != 1 || version != LUMEN_BINLOG_VERSION ||
+        fread(&marker_len, sizeof(marker_len), 1, in) != 1 || marker_len >= sizeof(marker) ||
+        fread(marker, 1, marker_len, in) != marker_len) {
+        return -1;
+    }
+    marker[marker_len] = '\0';
+    
+    while (fread(&kind, sizeof(kind), 1, in) == 1) {
+        if (kind == LUMEN_BINLOG_ENTRY_FORMAT) {
+            uint16_t id, len;
+            if (fread(&id, sizeof(id), 1, in) != 1 || fread(&len, sizeof(len), 1, in) != 1 ||
+                id != format_count || id >= LUMEN_BINLOG_MAX_FORMATS) {
+                records = -1;
+                break;
+            }
+            strings[id] = (char*)malloc(len + 1u);
+            if (strings[id] == NULL || fread(strings[id], 1, len, in) != len) {
+                records = -1;
+                break;
+            }
+            strings[id][len] = '\0';
+            formats[id].format = strings[id];
+            if (lumen_binlog_signature(strings[id], formats[id].signature) < 0) {
+                records = -1;
+                break;
+            }
+            format_count++;
+        } else if (kind == LUMEN_BINLOG_ENTRY_RECORD) {
+            uint16_t id;
+            int64_t stamp;
+            int32_t frac, lvl;
+            int8_t digits;
+            char time_str[64];
+            char message[LUMEN_BINLOG_RECORD_MAX];
+            
+            if (fread(&id, sizeof(id), 1, in) != 1 || fread(&stamp, sizeof(stamp), 1, in) != 1 ||
+                fread(&frac, sizeof(frac), 1, in) != 1 || fread(&digits, sizeof(digits), 1, in) != 1 ||
+                fread(&lvl, sizeof(lvl), 1, in) != 1 || id >= format_count ||
+                lumen_binlog_render(in, formats[id].format, formats[id].signature, message, sizeof(message)) != 0) {
+                records = -1;
+                break;
+            }
+            
+            lumen_format_timestamp((time_t)stamp, frac, digits, time_str, sizeof(time_str));
+            fprintf(out, "%s %s [Level %d]: %s\n", marker, time_str, (int)lvl, message);
+            records++;
+        } else {
+            records = -1;
+            break;
+        }
+    }
+    
+    for (int i = 0; i < format_count + 1 && i < LUMEN_BINLOG_MAX_FORMATS; i++) {
+        free(strings[i]);
+    }
+    return records;
+}
+
+// ---- Request arena ----
+
+// Bump allocator for the temporaries of one collect_api_data* call: the
+// response buffer, cJSON nodes (via cJSON_InitHooks) and our header lists.
+// Leaving the outermost call rewinds it in one step; chunks are kept for the
+// next call, so steady-state polling costs no heap allocation. libcurl's own
+// internal allocations are not routed here.
+#define API_ARENA_CHUNK (64 * 1024)
+#ifndef API_ARENA_KEEP_MAX
+#ifdef LUMEN_PROFILE_NEXUS6
+#define API_ARENA_KEEP_MAX (256 * 1024)   // Chunks beyond this are freed on reset
+#else
+#define API_ARENA_KEEP_MAX (1024 * 1024)
+#endif
+#endif
+
+static _Thread_local struct request_arena api_thread_arena;
+static _Thread_local struct request_arena *api_current_arena = NULL;
+static pthread_once_t api_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t api_thread_key;
+
+void *arena_alloc(struct request_arena *arena, size_t size) {
+    struct arena_chunk *chunk = arena->current;
+    
+    size = (size + API_ARENA_ALIGN - 1) & ~(size_t)(API_ARENA_ALIGN - 1);
+    
+    // Current chunk, then retained chunks that are free again, then a new one
+    while (chunk && chunk->size - chunk->used < size) {
+        chunk = chunk->next;
+        if (chunk) chunk->used = 0;
+    }
+    
+    if (!chunk) {
+        size_t chunk_size = API_ARENA_CHUNK;
+        while (chunk_size < size) {
+            if (chunk_size > ((size_t)-1) / 4) return NULL;
+            chunk_size *= 2;
+        }
+        
+        chunk = (struct arena_chunk *)malloc(sizeof(struct arena_chunk) + chunk_size);
+        if (!chunk) {
+            fprintf(stderr, "ARENA: %zu byte chunk failed: %s\n", chunk_size, strerror(errno));
+            return NULL;
+        }
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        
+        // Insert after the current chunk so retained chunks stay reachable
+        if (arena->current) {
+            chunk->next = arena->current->next;
+            arena->current->next = chunk;
+        } else {
+            chunk->next = arena->chunks;
+            arena->chunks = chunk;
+        }
+        arena->chunk_allocs++;
+    }
+    
+    arena->current = chunk;
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->used += size;
+    if (arena->used > arena->peak_used) arena->peak_used = arena->used;
+    return ptr;
+}
+
+// Grow the most recent allocation in place. Returns 0, or -1 if it is not
+// the last one or the chunk is too small.
+int arena_extend(struct request_arena *arena, void *ptr, size_t old_size, size_t new_size) {
+    struct arena_chunk *chunk = arena->current;
+    
+    old_size = (old_size + API_ARENA_ALIGN - 1) & ~(size_t)(API_ARENA_ALIGN - 1);
+    new_size = (new_size + API_ARENA_ALIGN - 1) & ~(size_t)(API_ARENA_ALIGN - 1);
+    
+    if (!chunk || (unsigned char *)ptr + old_size != chunk->data + chunk->used ||
+        new_size - old_size > chunk->size - chunk->used) {
+        return -1;
+    }
+    
+    chunk->used += new_size - old_size;
+    arena->used += new_size - old_size;
+    if (arena->used > arena->peak_used) arena->peak_used = arena->used;
+    return 0;
+}
+
+int arena_owns(const struct request_arena *arena, const void *ptr) {
+    const unsigned char *p = (const unsigned char *)ptr;
+    
+    for (const struct arena_chunk *chunk = arena->chunks; chunk; chunk = chunk->next) {
+        if (p >= chunk->data && p < chunk->data + chunk->size) return 1;
+    }
+    return 0;
+}
+
+// Rewind to empty, keeping up to API_ARENA_KEEP_MAX bytes of chunks
+void arena_reset(struct request_arena *arena) {
+    struct arena_chunk **link = &arena->chunks;
+    size_t kept = 0;
+    
+    while (*link) {
+        struct arena_chunk *chunk = *link;
+        if (kept + chunk->size > API_ARENA_KEEP_MAX) {
+            *link = chunk->next;
+            free(chunk);
+            continue;
+        }
+        kept += chunk->size;
+        chunk->used = 0;
+        link = &chunk->next;
+    }
+    
+    arena->current = arena->chunks;
+    arena->used = 0;
+    arena->resets++;
+}
+
+// Free every chunk. The thread arena is destroyed when its thread exits.
+void arena_destroy(struct request_arena *arena) {
+    while (arena->chunks) {
+        struct arena_chunk *chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free(chunk);
+    }
+    arena->current = NULL;
+    arena->used = 0;
+}
+
+static void *arena_cjson_malloc(size_t size) {
+    return api_current_arena ? arena_alloc(api_current_arena, size) : malloc(size);
+}
+
+// Only the calling thread's arena is checked: a cJSON tree parsed inside a
+// request must be deleted by the same thread before request_arena_leave.
+// Handing it to another thread (or keeping it past the request) would pass
+// arena memory to free().
+static void arena_cjson_free(void *ptr) {
+    if (ptr && arena_owns(&api_thread_arena, ptr)) return;  // Released by the reset
+    free(ptr);
+}
+
+// Thread exit: free the arena's chunks and the cached response buffers
+static void api_thread_release(void *unused) {
+    (void)unused;
+    arena_destroy(&api_thread_arena);
+    drain_response_buffers();
+}
+
+static void api_thread_init(void) {
+    cJSON_Hooks hooks = { arena_cjson_malloc, arena_cjson_free };
+    cJSON_InitHooks(&hooks);
+    pthread_key_create(&api_thread_key, api_thread_release);
+}
+
+// Have this thread's arena and buffer cache freed when it exits
+static void api_thread_register(void) {
+    pthread_once(&api_thread_once, api_thread_init);
+    if (!pthread_getspecific(api_thread_key)) {
+        pthread_setspecific(api_thread_key, &api_thread_arena);
+    }
+}
+
+// Route this thread's request temporaries into its arena until the matching leave
+struct request_arena *request_arena_enter(void) {
+    if (api_thread_arena.depth++ == 0) {
+        api_thread_register();
+        api_current_arena = &api_thread_arena;
+    }
+    return &api_thread_arena;
+}
+
+void request_arena_leave(void) {
+    if (api_thread_arena.depth > 0 && --api_thread_arena.depth == 0) {
+        api_current_arena = NULL;
+        arena_reset(&api_thread_arena);
+    }
+}
+
+// curl_slist_append, with node and string taken from the active arena.
+// libcurl only reads the list, so hand-built nodes are fine.
+struct curl_slist *arena_slist_append(struct curl_slist *list, const char *line) {
+    if (!api_current_arena) return curl_slist_append(list, line);
+    
+    size_t len = strlen(line) + 1;
+    struct curl_slist *node = (struct curl_slist *)arena_alloc(api_current_arena, sizeof(struct curl_slist) + len);
+    if (!node) return list;
+    
+    node->data = (char *)(node + 1);
+    memcpy(node->data, line, len);
+    node->next = NULL;
+    
+    if (!list) return node;
+    struct curl_slist *tail = list;
+    while (tail->next) tail = tail->next;
+    tail->next = node;
+    return list;
+}
+
+void arena_slist_free(struct curl_slist *list) {
+    if (list && !arena_owns(&api_thread_arena, list)) {
+        curl_slist_free_all(list);
+    }
+}
+
+void print_arena_stats(void) {
+    size_t reserved = 0;
+    for (const struct arena_chunk *chunk = api_thread_arena.chunks; chunk; chunk = chunk->next) {
+        reserved += chunk->size;
+    }
+    printf("Arena: %zu bytes reserved | peak %zu | chunk allocs %lu | resets %lu\n",
+           reserved, api_thread_arena.peak_used, api_thread_arena.chunk_allocs, api_thread_arena.resets);
+}
+
+// ---- Response buffers ----
+
+// Response body buffer shared by every collector. Grows geometrically, is
+// pre-sized from Content-Length, and goes back to a per-thread free list
+// after parsing, so steady-state polling does no heap allocation at all.
+#define RESPONSE_BUFFER_MIN 4096
+#define RESPONSE_BUFFER_KEEP_MAX (1024 * 1024)  // Bigger buffers are freed, not cached
+#define RESPONSE_FREE_LIST_MAX 8
+
+static _Thread_local struct response_buffer *response_free_list = NULL;
+static _Thread_local int response_free_count = 0;
+
+// Make room for `needed` bytes plus the terminating NUL. Returns 0, or -1 if out of memory.
+int response_buffer_reserve(struct response_buffer *buf, size_t needed) {
+    if (needed < buf->capacity) return 0;
+    
+    size_t capacity = buf->capacity ? buf->capacity : RESPONSE_BUFFER_MIN;
+    while (capacity <= needed) {
+        if (capacity > ((size_t)-1) / 2) return -1;
+        capacity *= 2;
+    }
+    
+    char *ptr;
+    if (buf->arena_backed) {
+        // Extend in place when the body is the newest allocation, else move
+        // (the old storage stays in the arena until the reset)
+        if (buf->data && arena_extend(api_current_arena, buf->data, buf->capacity, capacity) == 0) {
+            ptr = buf->data;
+        } else {
+            ptr = arena_alloc(api_current_arena, capacity);
+            if (ptr && buf->size) memcpy(ptr, buf->data, buf->size + 1);
+        }
+    } else {
+        ptr = realloc(buf->data, capacity);
+    }
+    if (!ptr) {
+        fprintf(stderr, "RECV: Buffer growth to %zu bytes failed: %s\n", capacity, strerror(errno));
+        return -1;
+    }
+    
+    buf->data = ptr;
+    buf->capacity = capacity;
+    return 0;
+}
+
+// Take a cleared buffer from the request arena, this thread's free list,
+// or a new allocation
+struct response_buffer *acquire_response_buffer(void) {
+    struct response_buffer *buf = response_free_list;
+    
+    if (api_current_arena) {
+        buf = (struct response_buffer *)arena_alloc(api_current_arena, sizeof(struct response_buffer));
+        if (!buf) return NULL;
+        memset(buf, 0, sizeof(struct response_buffer));
+        buf->arena_backed = 1;
+        if (response_buffer_reserve(buf, 0) != 0) return NULL;
+    } else if (buf) {
+        response_free_list = buf->next_free;
+        response_free_count--;
+    } else {
+        buf = (struct response_buffer *)calloc(1, sizeof(struct response_buffer));
+        if (!buf) return NULL;
+        if (response_buffer_reserve(buf, 0) != 0) {
+            free(buf);
+            return NULL;
+        }
+    }
+    
+    buf->next_free = NULL;
+    buf->size = 0;
+    buf->expected_size = 0;
+    buf->etag[0] = '\0';
+    buf->last_modified[0] = '\0';
+    buf->data[0] = '\0';
+    return buf;
+}
+
+// Hand a buffer back once its contents have been parsed
+void release_response_buffer(struct response_buffer *buf) {
+    if (!buf || buf->arena_backed) return;
+    
+    if (response_free_count >= RESPONSE_FREE_LIST_MAX || buf->capacity > RESPONSE_BUFFER_KEEP_MAX) {
+        free(buf->data);
+        free(buf);
+        return;
+    }
+    
+    api_thread_register();
+    buf->size = 0;
+    buf->next_free = response_free_list;
+    response_free_list = buf;
+    response_free_count++;
+}
+
+// Drop this thread's cached buffers now (exiting threads drop theirs)
+void drain_response_buffers(void) {
+    while (response_free_list) {
+        struct response_buffer *buf = response_free_list;
+        response_free_list = buf->next_free;
+        free(buf->data);
+        free(buf);
+    }
+    response_free_count = 0;
+}
+
+static size_t WriteResponseCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    struct response_buffer *buf = (struct response_buffer *)userp;
+    
+    if (response_buffer_reserve(buf, buf->size + realsize) != 0) {
+        return 0;  // Aborts the transfer with CURLE_WRITE_ERROR
+    }
+    
+    memcpy(buf->data + buf->size, contents, realsize);
+    buf->size += realsize;
+    buf->data[buf->size] = '\0';
+    
+    return realsize;
+}
+
+// Copy a header value (trimmed, without CRLF) into dst
+static void copy_header_value(char *dst, size_t dst_size, const char *value, size_t len) {
+    while (len > 0 && (*value == ' ' || *value == '\t')) {
+        value++;
+        len--;
+    }
+    while (len > 0 && (value[len - 1] == '\r' || value[len - 1] == '\n' || value[len - 1] == ' ')) {
+        len--;
+    }
+    if (len >= dst_size) {
+        dst[0] = '\0';  // Truncated validators are useless, drop them
+        return;
+    }
+    memcpy(dst, value, len);
+    dst[len] = '\0';
+}
+
+// Pre-size the body buffer as soon as Content-Length is known, and keep
+// ETag / Last-Modified for cache revalidation
+static size_t ResponseHeaderCallback(char *header, size_t size, size_t nitems, void *userp) {
+    size_t realsize = size * nitems;
+    struct response_buffer *buf = (struct response_buffer *)userp;
+    static const char name[] = "content-length:";
+    static const char etag[] = "etag:";
+    static const char last_modified[] = "last-modified:";
+    
+    if (realsize > sizeof(etag) - 1 && strncasecmp(header, etag, sizeof(etag) - 1) == 0) {
+        copy_header_value(buf->etag, sizeof(buf->etag),
+                          header + sizeof(etag) - 1, realsize - (sizeof(etag) - 1));
+    } else if (realsize > sizeof(last_modified) - 1 &&
+               strncasecmp(header, last_modified, sizeof(last_modified) - 1) == 0) {
+        copy_header_value(buf->last_modified, sizeof(buf->last_modified),
+                          header + sizeof(last_modified) - 1, realsize - (sizeof(last_modified) - 1));
+    } else if (realsize > sizeof(name) - 1 && strncasecmp(header, name, sizeof(name) - 1) == 0) {
+        char *end = NULL;
+        unsigned long long length = strtoull(header + sizeof(name) - 1, &end, 10);
+        if (end != header + sizeof(name) - 1 && length <= RESPONSE_BUFFER_KEEP_MAX * 16ULL) {
+            buf->expected_size = (size_t)length;
+            response_buffer_reserve(buf, (size_t)length);  // Only a hint, growth still works
+        }
+    }
+    
+    return realsize;
+}
+
+// Point a handle's body and header output at buf
+void attach_response_buffer(CURL *curl, struct response_buffer *buf) {
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteResponseCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)buf);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ResponseHeaderCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)buf);
+}
+
+// ---- Streaming extraction ----
+
+// Incremental extractor for the three system-info fields we actually read.
+// Fed straight from the curl write callback, it fills a struct os as the
+// keys go past and allocates nothing. The rest of the document is still
+// checked for syntax, so a body is only accepted once it has ended the way
+// cJSON_Parse would accept it. Anything it cannot handle exactly like cJSON
+// (bad syntax, truncation, \u escapes in a field we read) reports MALFORMED
+// so the caller can fall back to the full cJSON_Parse path with unchanged
+// semantics.
+
+#define SYSINFO_BULK_THRESHOLD (64 * 1024)  // Bodies this large go to the SIMD scanner
+
+void sysinfo_extractor_init(struct sysinfo_extractor *ex, struct os *out, unsigned int wanted) {
+    memset(ex, 0, sizeof(struct sysinfo_extractor));
+    ex->out = out;
+    ex->state = SX_VALUE;
+    ex->wanted = wanted ? wanted : SYSINFO_FIELD_ALL;
+    ex->result = SYSINFO_SCAN_MORE;
+}
+
+static void sx_fail(struct sysinfo_extractor *ex) {
+    ex->result = SYSINFO_SCAN_MALFORMED;
+}
+
+static int sx_top_is_array(const struct sysinfo_extractor *ex) {
+    return (ex->array_bits >> (ex->depth - 1)) & 1ULL;
+}
+
+static void sx_token_char(struct sysinfo_extractor *ex, char c) {
+    if (ex->token_len < SYSINFO_TOKEN_MAX - 1) {
+        ex->token[ex->token_len++] = c;
+    } else {
+        ex->token_len = SYSINFO_TOKEN_MAX;
+    }
+}
+
+// Case-insensitive like cJSON_GetObjectItem
+static int sx_match_key(const struct sysinfo_extractor *ex) {
+    if (ex->token_len >= SYSINFO_TOKEN_MAX) return 0;
+    if (ex->token_len == 8 && strncasecmp(ex->token, "apimodel", 8) == 0) return SYSINFO_FIELD_APIMODEL;
+    if (ex->token_len == 6 && strncasecmp(ex->token, "system", 6) == 0) return SYSINFO_FIELD_SYSTEM;
+    if (ex->token_len == 6 && strncasecmp(ex->token, "osname", 6) == 0) return SYSINFO_FIELD_OSNAME;
+    return 0;
+}
+
+static void sx_open(struct sysinfo_extractor *ex, int is_array) {
+    if (ex->depth >= SYSINFO_MAX_DEPTH) {
+        sx_fail(ex);
+        return;
+    }
+    if (is_array) {
+        ex->array_bits |= 1ULL << ex->depth;
+    } else {
+        ex->array_bits &= ~(1ULL << ex->depth);
+    }
+    ex->depth++;
+    ex->field = 0;  // Containers never satisfy a field
+    ex->allow_close = 1;
+    ex->state = is_array ? SX_VALUE : SX_KEY;
+}
+
+static void sx_close(struct sysinfo_extractor *ex, char c) {
+    if (ex->depth == 0 || sx_top_is_array(ex) != (c == ']')) {
+        sx_fail(ex);
+        return;
+    }
+    ex->depth--;
+    ex->allow_close = 0;
+    if (ex->depth == 0) {
+        ex->state = SX_END;
+        ex->result = SYSINFO_SCAN_COMPLETE;  // Whole document seen
+    } else {
+        ex->state = SX_AFTER_VALUE;
+    }
+}
+
+static void sx_value_done(struct sysinfo_extractor *ex) {
+    ex->field = 0;
+    if (ex->depth == 0) {
+        ex->state = SX_END;
+        ex->result = SYSINFO_SCAN_COMPLETE;  // Top-level scalar
+    } else {
+        ex->state = SX_AFTER_VALUE;
+    }
+}
+
+static void sx_end_number(struct sysinfo_extractor *ex) {
+    if (ex->token_len >= SYSINFO_TOKEN_MAX) {
+        sx_fail(ex);
+        return;
+    }
+    ex->token[ex->token_len] = '\0';
+    
+    char *end = NULL;
+    double number = strtod(ex->token, &end);
+    if (end != ex->token + ex->token_len) {
+        sx_fail(ex);
+        return;
+    }
+    
+    if (ex->field == SYSINFO_FIELD_APIMODEL || ex->field == SYSINFO_FIELD_SYSTEM) {
+        // Same saturation as cJSON's valueint
+        int value = number >= 2147483647.0 ? 2147483647
+                  : number <= -2147483648.0 ? (-2147483647 - 1) : (int)number;
+        if (ex->field == SYSINFO_FIELD_APIMODEL) {
+            ex->out->apimodel = value;
+        } else {
+            ex->out->system = value;
+        }
+        ex->found |= ex->field;
+    }
+    sx_value_done(ex);
+}
+
+static void sx_end_literal(struct sysinfo_extractor *ex) {
+    if (!((ex->token_len == 4 && memcmp(ex->token, "true", 4) == 0) ||
+          (ex->token_len == 5 && memcmp(ex->token, "false", 5) == 0) ||
+          (ex->token_len == 4 && memcmp(ex->token, "null", 4) == 0))) {
+        sx_fail(ex);
+        return;
+    }
+    sx_value_done(ex);
+}
+
+static void sx_end_string(struct sysinfo_extractor *ex) {
+    if (ex->string_is_key) {
+        int field = (ex->depth == 1) ? sx_match_key(ex) : 0;
+        if (field & ex->seen) field = 0;  // Duplicate key: cJSON keeps the first
+        ex->seen |= field;
+        ex->field = field & ex->wanted;
+        ex->state = SX_COLON;
+        return;
+    }
+    
+    if (ex->field == SYSINFO_FIELD_OSNAME) {
+        ex->out->osname[ex->osname_len] = '\0';
+        ex->found |= SYSINFO_FIELD_OSNAME;
+    }
+    sx_value_done(ex);
+}
+
+static void sx_string_char(struct sysinfo_extractor *ex, char c) {
+    if (ex->string_is_key) {
+        sx_token_char(ex, c);
+    } else if (ex->field == SYSINFO_FIELD_OSNAME && ex->osname_len < sizeof(ex->out->osname) - 1) {
+        ex->out->osname[ex->osname_len++] = c;
+    }
+}
+
+static void sx_begin_value(struct sysinfo_extractor *ex, char c) {
+    ex->allow_close = 0;
+    ex->token_len = 0;
+    
+    if (c == '{') {
+        sx_open(ex, 0);
+    } else if (c == '[') {
+        sx_open(ex, 1);
+    } else if (c == '"') {
+        ex->string_is_key = 0;
+        ex->osname_len = 0;
+        ex->state = SX_STRING;
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+        sx_token_char(ex, c);
+        ex->state = SX_NUMBER;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        sx_token_char(ex, c);
+        ex->state = SX_LITERAL;
+    } else {
+        sx_fail(ex);
+    }
+}
+
+// Consume one chunk. Returns the current sysinfo_scan_result.
+int sysinfo_extractor_feed(struct sysinfo_extractor *ex, const char *data, size_t len) {
+    size_t i = 0;
+    
+    while (i < len && ex->result == SYSINFO_SCAN_MORE) {
+        char c = data[i];
+        
+        switch (ex->state) {
+            case SX_STRING:
+                if (c == '\\') {
+                    ex->state = SX_STRING_ESCAPE;
+                } else if (c == '"') {
+                    sx_end_string(ex);
+                } else if ((unsigned char)c < 0x20) {
+                    sx_fail(ex);
+                } else {
+                    sx_string_char(ex, c);
+                }
+                i++;
+                continue;
+            
+            case SX_STRING_ESCAPE: {
+                char decoded;
+                switch (c) {
+                    case '"': case '\\': case '/': decoded = c; break;
+                    case 'b': decoded = '\b'; break;
+                    case 'f': decoded = '\f'; break;
+                    case 'n': decoded = '\n'; break;
+                    case 'r': decoded = '\r'; break;
+                    case 't': decoded = '\t'; break;
+                    case 'u':
+                        // Only matters if it could change a key we match or a value we keep
+                        if (ex->string_is_key ? ex->depth == 1 : ex->field == SYSINFO_FIELD_OSNAME) {
+                            sx_fail(ex);
+                        }
+                        decoded = '?';
+                        break;
+                    default:
+                        sx_fail(ex);
+                        decoded = 0;
+                }
+                sx_string_char(ex, decoded);
+                ex->state = SX_STRING;
+                i++;
+                continue;
+            }
+            
+            case SX_NUMBER:
+                if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                    sx_token_char(ex, c);
+                    i++;
+                } else {
+                    sx_end_number(ex);  // Terminator is re-read as structure
+                }
+                continue;
+            
+            case SX_LITERAL:
+                if (c >= 'a' && c <= 'z') {
+                    sx_token_char(ex, c);
+                    i++;
+                } else {
+                    sx_end_literal(ex);
+                }
+                continue;
+            
+            default:
+                break;
+        }
+        
+        i++;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') continue;
+        
+        switch (ex->state) {
+            case SX_VALUE:
+                if (c == ']' && ex->allow_close) {
+                    sx_close(ex, c);
+                } else {
+                    sx_begin_value(ex, c);
+                }
+                break;
+            case SX_KEY:
+                if (c == '"') {
+                    ex->string_is_key = 1;
+                    ex->token_len = 0;
+                    ex->allow_close = 0;
+                    ex->state = SX_STRING;
+                } else if (c == '}' && ex->allow_close) {
+                    sx_close(ex, c);
+                } else {
+                    sx_fail(ex);
+                }
+                break;
+            case SX_COLON:
+                if (c == ':') {
+                    ex->state = SX_VALUE;
+                } else {
+                    sx_fail(ex);
+                }
+                break;
+            case SX_AFTER_VALUE:
+                if (c == ',') {
+                    ex->field = 0;
+                    ex->state = sx_top_is_array(ex) ? SX_VALUE : SX_KEY;
+                } else if (c == '}' || c == ']') {
+                    sx_close(ex, c);
+                } else {
+                    sx_fail(ex);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    
+    return ex->result;
+}
+
+// Signal end of input. A document that stops half way is MALFORMED.
+int sysinfo_extractor_finish(struct sysinfo_extractor *ex) {
+    if (ex->result == SYSINFO_SCAN_MORE) {
+        if (ex->state == SX_NUMBER && ex->depth == 0) {
+            sx_end_number(ex);
+        } else if (ex->state == SX_LITERAL && ex->depth == 0) {
+            sx_end_literal(ex);
+        }
+    }
+    if (ex->result == SYSINFO_SCAN_MORE) {
+        ex->result = SYSINFO_SCAN_MALFORMED;
+    }
+    return ex->result;
+}
+
+static size_t StreamingWriteCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    struct streaming_sink *sink = (struct streaming_sink *)userp;
+    
+    // Document ended: drain trailing bytes (ignored, as cJSON_Parse does) so
+    // the connection stays reusable
+    if (sink->ex.result == SYSINFO_SCAN_COMPLETE) {
+        return realsize;
+    }
+    
+    if (sink->buf->size == 0 && sink->buf->expected_size >= SYSINFO_BULK_THRESHOLD) {
+        sink->bulk_scan = 1;
+    }
+    
+    if (WriteResponseCallback(contents, size, nmemb, sink->buf) != realsize) {
+        return 0;
+    }
+    if (!sink->bulk_scan) {
+        sysinfo_extractor_feed(&sink->ex, (const char *)contents, realsize);
+    }
+    return realsize;
+}
+
+void attach_streaming_sink(CURL *curl, struct streaming_sink *sink, struct response_buffer *buf) {
+    memset(&sink->fields, 0, sizeof(struct os));
+    sink->buf = buf;
+    sink->bulk_scan = 0;
+    sysinfo_extractor_init(&sink->ex, &sink->fields, SYSINFO_FIELD_ALL);
+    
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamingWriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)sink);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ResponseHeaderCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)buf);
+}
+
+// ---- SIMD key scanner ----
+
+// Bulk locator for the top-level apimodel/system/osname keys in large
+// payloads. A vector kernel turns each 64-byte block into a bitmask of JSON
+// structural characters; only those positions are visited, so long strings
+// and padding are skipped 16-32 bytes at a time. The grammar is still
+// checked in full: the text between two structural characters must be
+// whitespace, or a single number or literal where a value is expected, and
+// escapes are validated. Used for payloads above SYSINFO_BULK_THRESHOLD.
+
+typedef uint64_t (*structural_mask_fn)(const unsigned char *block);
+
+static const unsigned char json_structural[256] = {
+    ['"'] = 1, ['\\'] = 1, ['{'] = 1, ['}'] = 1, ['['] = 1, [']'] = 1, [','] = 1, [':'] = 1
+};
+
+static uint64_t structural_mask_generic(const unsigned char *block) {
+    uint64_t mask = 0;
+    for (int i = 0; i < 64; i++) {
+        if (json_structural[block[i]]) mask |= 1ULL << i;
+    }
+    return mask;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static uint64_t structural_mask_sse2(const unsigned char *block) {
+    uint64_t mask = 0;
+    for (int lane = 0; lane < 4; lane++) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(block + 16 * lane));
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')), _mm_cmpeq_epi8(v, _mm_set1_epi8('}')))),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')), _mm_cmpeq_epi8(v, _mm_set1_epi8(']'))),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')), _mm_cmpeq_epi8(v, _mm_set1_epi8(':')))));
+        mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(m) << (16 * lane);
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+static uint64_t structural_mask_avx2(const unsigned char *block) {
+    uint64_t mask = 0;
+    for (int lane = 0; lane < 2; lane++) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(block + 32 * lane));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}')))),
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']'))),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')))));
+        mask |= (uint64_t)(uint32_t)_mm256_movemask_epi8(m) << (32 * lane);
+    }
+    return mask;
+}
+#endif
+
+#if defined(__ARM_NEON)
+static uint64_t structural_mask_neon(const unsigned char *block) {
+    static const uint8_t bit_weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t weights = vld1q_u8(bit_weights);
+    uint64_t mask = 0;
+    
+    for (int lane = 0; lane < 4; lane++) {
+        uint8x16_t v = vld1q_u8(block + 16 * lane);
+        uint8x16_t m = vorrq_u8(
+            vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+                     vorrq_u8(vceqq_u8(v, vdupq_n_u8('{')), vceqq_u8(v, vdupq_n_u8('}')))),
+            vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('[')), vceqq_u8(v, vdupq_n_u8(']'))),
+                     vorrq_u8(vceqq_u8(v, vdupq_n_u8(',')), vceqq_u8(v, vdupq_n_u8(':')))));
+        
+        // No movemask on ARMv7: weight each lane by its bit and fold with pairwise adds
+        uint8x16_t t = vandq_u8(m, weights);
+        uint8x8_t lo = vget_low_u8(t);
+        uint8x8_t hi = vget_high_u8(t);
+        lo = vpadd_u8(lo, lo); lo = vpadd_u8(lo, lo); lo = vpadd_u8(lo, lo);
+        hi = vpadd_u8(hi, hi); hi = vpadd_u8(hi, hi); hi = vpadd_u8(hi, hi);
+        uint64_t bits = (uint64_t)vget_lane_u8(lo, 0) | ((uint64_t)vget_lane_u8(hi, 0) << 8);
+        mask |= bits << (16 * lane);
+    }
+    return mask;
+}
+#endif
+
+static structural_mask_fn select_structural_mask(void) {
+    unsigned int features = lumen_cpu_features();
+    (void)features;
+#if defined(__x86_64__) || defined(__i386__)
+    if (features & LUMEN_CPU_AVX2) return structural_mask_avx2;
+    if (features & LUMEN_CPU_SSE2) return structural_mask_sse2;
+#endif
+#if defined(__ARM_NEON)
+    if (features & LUMEN_CPU_NEON) return structural_mask_neon;
+#endif
+    return structural_mask_generic;
+}
+
+// Grammar position between structural characters
+enum scan_state {
+    SCAN_VALUE,
+    SCAN_KEY,
+    SCAN_COLON,
+    SCAN_AFTER
+};
+
+static int scan_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Check the text in data[start, end) between two structural characters.
+// Returns 1 if it held a scalar value, 0 for whitespace only, or
+// SYSINFO_SCAN_MALFORMED. A number feeding `field` is stored in out.
+static int scan_gap(const char *data, size_t start, size_t end, int allow_scalar,
+                    int field, struct os *out, unsigned int *found) {
+    while (start < end && scan_is_space(data[start])) start++;
+    while (end > start && scan_is_space(data[end - 1])) end--;
+    if (start == end) return 0;
+    if (!allow_scalar) return SYSINFO_SCAN_MALFORMED;
+    
+    const char *token = data + start;
+    size_t n = end - start;
+    
+    if ((n == 4 && memcmp(token, "true", 4) == 0) || (n == 5 && memcmp(token, "false", 5) == 0) ||
+        (n == 4 && memcmp(token, "null", 4) == 0)) {
+        return 1;  // Wrong type for every field: treated as missing, like cJSON_IsNumber
+    }
+    if (n >= SYSINFO_TOKEN_MAX || (token[0] != '-' && (token[0] < '0' || token[0] > '9'))) {
+        return SYSINFO_SCAN_MALFORMED;
+    }
+    
+    // Same character set cJSON's parse_number accepts before calling strtod,
+    // and strtod has to use all of it
+    char number_text[SYSINFO_TOKEN_MAX];
+    for (size_t i = 0; i < n; i++) {
+        char c = token[i];
+        if (!((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')) {
+            return SYSINFO_SCAN_MALFORMED;
+        }
+        number_text[i] = c;
+    }
+    number_text[n] = '\0';
+    
+    char *stop = NULL;
+    double number = strtod(number_text, &stop);
+    if (stop != number_text + n) return SYSINFO_SCAN_MALFORMED;
+    
+    if (field == SYSINFO_FIELD_APIMODEL || field == SYSINFO_FIELD_SYSTEM) {
+        int value = number >= 2147483647.0 ? 2147483647
+                  : number <= -2147483648.0 ? (-2147483647 - 1) : (int)number;
+        if (field == SYSINFO_FIELD_APIMODEL) {
+            out->apimodel = value;
+        } else {
+            out->system = value;
+        }
+        *found |= (unsigned int)field;
+    }
+    return 1;
+}
+
+// Validate the escape whose backslash is at data[pos]. \u is checked for four
+// hex digits; surrogates are left to cJSON, which rejects unpaired ones.
+static int scan_escape(const char *data, size_t pos) {
+    unsigned int code = 0;
+    
+    switch (data[pos + 1]) {
+        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+            return 0;
+        case 'u':
+            for (int i = 2; i < 6; i++) {
+                char h = data[pos + i];  // Stops at the terminating NUL
+                if (h >= '0' && h <= '9') code = code * 16 + (unsigned int)(h - '0');
+                else if (h >= 'a' && h <= 'f') code = code * 16 + (unsigned int)(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') code = code * 16 + (unsigned int)(h - 'A' + 10);
+                else return SYSINFO_SCAN_MALFORMED;
+            }
+            return (code >= 0xD800 && code <= 0xDFFF) ? SYSINFO_SCAN_MALFORMED : 0;
+        default:
+            return SYSINFO_SCAN_MALFORMED;
+    }
+}
+
+// Decode the osname string body data[start, end)
+static int scan_osname(const char *data, size_t start, size_t end, struct os *out) {
+    size_t n = 0;
+    
+    for (size_t pos = start; pos < end; pos++) {
+        char c = data[pos];
+        if ((unsigned char)c < 0x20) return SYSINFO_SCAN_MALFORMED;
+        if (c == '\\') {
+            switch (data[++pos]) {
+                case '"': case '\\': case '/': c = data[pos]; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                default: return SYSINFO_SCAN_MALFORMED;  // \u goes to cJSON
+            }
+        }
+        if (n < sizeof(out->osname) - 1) out->osname[n++] = c;
+    }
+    out->osname[n] = '\0';
+    return 0;
+}
+
+// Case-insensitive like cJSON_GetObjectItem
+static int scan_match_key(const char *key, size_t key_len) {
+    if (key_len == 8 && strncasecmp(key, "apimodel", 8) == 0) return SYSINFO_FIELD_APIMODEL;
+    if (key_len == 6 && strncasecmp(key, "system", 6) == 0) return SYSINFO_FIELD_SYSTEM;
+    if (key_len == 6 && strncasecmp(key, "osname", 6) == 0) return SYSINFO_FIELD_OSNAME;
+    return 0;
+}
+
+// Scan a complete NUL-terminated document (data[len] == '\0'). Returns
+// SYSINFO_SCAN_COMPLETE with *found set once the top-level container closes
+// (trailing bytes are ignored, as cJSON_Parse does), or SYSINFO_SCAN_MALFORMED.
+int sysinfo_scan_buffer(const char *data, size_t len, struct os *out, unsigned int *found) {
+    structural_mask_fn mask_fn = select_structural_mask();
+    unsigned char tail[64];
+    unsigned long long array_bits = 0;
+    size_t escaped_pos = (size_t)-1;
+    size_t string_start = 0;
+    size_t gap_start = 0;           // First byte after the last structural character
+    int state = SCAN_VALUE;
+    int allow_close = 0;            // Right after '{' or '[' the closing bracket is legal
+    int depth = 0;
+    int in_string = 0;
+    int string_is_key = 0;
+    int field = 0;                  // Field the next value feeds, 0 = ignored
+    unsigned int seen = 0;
+    
+    *found = 0;
+    
+    // cJSON stops at the first NUL; the mask would skip it inside a string
+    if (memchr(data, '\0', len)) return SYSINFO_SCAN_MALFORMED;
+    
+    for (size_t block = 0; block < len; block += 64) {
+        const unsigned char *p = (const unsigned char *)data + block;
+        if (len - block < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, len - block);
+            p = tail;
+        }
+        
+        uint64_t mask = mask_fn(p);
+        while (mask) {
+            size_t pos = block + (size_t)__builtin_ctzll(mask);
+            mask &= mask - 1;
+            char c = data[pos];
+            
+            if (in_string) {
+                if (pos == escaped_pos) continue;
+                if (c == '\\') {
+                    escaped_pos = pos + 1;
+                    if (string_is_key && depth == 1) return SYSINFO_SCAN_MALFORMED;  // Escaped top-level key: let cJSON decode it
+                    if (scan_escape(data, pos) < 0) return SYSINFO_SCAN_MALFORMED;
+                } else if (c == '"') {
+                    in_string = 0;
+                    gap_start = pos + 1;
+                    if (string_is_key) {
+                        field = (depth == 1) ? scan_match_key(data + string_start, pos - string_start) : 0;
+                        if (field & seen) field = 0;  // First occurrence wins
+                        seen |= (unsigned int)field;
+                        state = SCAN_COLON;
+                    } else {
+                        if (field == SYSINFO_FIELD_OSNAME) {
+                            if (scan_osname(data, string_start, pos, out) < 0) return SYSINFO_SCAN_MALFORMED;
+                            *found |= SYSINFO_FIELD_OSNAME;
+                        }
+                        field = 0;
+                        state = SCAN_AFTER;
+                    }
+                }
+                continue;
+            }
+            
+            int scalar = scan_gap(data, gap_start, pos, state == SCAN_VALUE && depth > 0, field, out, found);
+            if (scalar < 0) return scalar;
+            if (scalar) {
+                field = 0;
+                allow_close = 0;
+                state = SCAN_AFTER;
+            }
+            gap_start = pos + 1;
+            
+            switch (c) {
+                case '"':
+                    // Top-level strings are left to cJSON
+                    if (depth == 0 || (state != SCAN_VALUE && state != SCAN_KEY)) return SYSINFO_SCAN_MALFORMED;
+                    in_string = 1;
+                    string_start = pos + 1;
+                    string_is_key = (state == SCAN_KEY);
+                    allow_close = 0;
+                    break;
+                case '{':
+                case '[':
+                    if (state != SCAN_VALUE || depth >= SYSINFO_MAX_DEPTH) return SYSINFO_SCAN_MALFORMED;
+                    if (c == '[') array_bits |= 1ULL << depth; else array_bits &= ~(1ULL << depth);
+                    depth++;
+                    field = 0;  // Containers never satisfy a field
+                    allow_close = 1;
+                    state = (c == '{') ? SCAN_KEY : SCAN_VALUE;
+                    break;
+                case '}':
+                case ']':
+                    if (state != SCAN_AFTER && !(allow_close && state == ((c == '}') ? SCAN_KEY : SCAN_VALUE))) {
+                        return SYSINFO_SCAN_MALFORMED;
+                    }
+                    if (depth == 0 || (int)((array_bits >> (depth - 1)) & 1ULL) != (c == ']')) {
+                        return SYSINFO_SCAN_MALFORMED;
+                    }
+                    depth--;
+                    if (depth == 0) return SYSINFO_SCAN_COMPLETE;
+                    allow_close = 0;
+                    state = SCAN_AFTER;
+                    break;
+                case ',':
+                    if (state != SCAN_AFTER) return SYSINFO_SCAN_MALFORMED;
+                    state = ((array_bits >> (depth - 1)) & 1ULL) ? SCAN_VALUE : SCAN_KEY;
+                    break;
+                case ':':
+                    if (state != SCAN_COLON) return SYSINFO_SCAN_MALFORMED;
+                    state = SCAN_VALUE;
+                    break;
+                default:
+                    return SYSINFO_SCAN_MALFORMED;  // Backslash outside a string
+            }
+        }
+    }
+    
+    return SYSINFO_SCAN_MALFORMED;  // Ran out of input inside the document
+}
+
+// Redirect to Website
+
+// ---- Error handling ----
+
+// Safe initialization of struct: copy backup, or clear it when backup is NULL
+int init_api_struct(struct os *api_data, const struct os *backup) {
+    if (!api_data) {
+        fprintf(stderr, "Error: NULL pointer passed to init_api_struct\n");
+        return API_STRUCT_INIT_ERROR;
+    }
+    
+    if (backup) {
+        memcpy(api_data, backup, sizeof(struct os));
+        return API_SUCCESS;
+    }
+    
+    api_data->apimodel = 0;
+    api_data->system = 0;
+    api_data->osname[0] = '\0';
+    return API_SUCCESS;
+}
+
+// Copy streamed fields into api_data with the same defaults as the cJSON path
+static void apply_extracted_fields(struct os *api_data, const struct sysinfo_extractor *ex) {
+    if (ex->found & SYSINFO_FIELD_APIMODEL) {
+        api_data->apimodel = ex->out->apimodel;
+    } else {
+        fprintf(stderr, "Warning: Invalid or missing apimodel field\n");
+        api_data->apimodel = -1;  // Error value
+    }
+    
+    if (ex->found & SYSINFO_FIELD_SYSTEM) {
+        api_data->system = ex->out->system;
+    } else {
+        fprintf(stderr, "Warning: Invalid or missing system field\n");
+        api_data->system = -1;
+    }
+    
+    if (ex->found & SYSINFO_FIELD_OSNAME) {
+        memcpy(api_data->osname, ex->out->osname, sizeof(api_data->osname));
+    } else {
+        fprintf(stderr, "Warning: Invalid or missing osname field\n");
+        strcpy(api_data->osname, "Unknown");
+    }
+}
+
+static void apply_attempt_timeout(CURL *curl, struct endpoint_registry *reg, const char *url,
+                                  const struct timeout_policy *policy, int retry);
+
+// Collect API data with full error handling. There is no registry or policy
+// here: the attempt gets the default policy's fixed timeout.
+int collect_api_data(struct os *api_data, const char *api_url) {
+    CURL *curl = NULL;
+    CURLcode res;
+    struct response_buffer *chunk = NULL;
+    struct streaming_sink sink;
+    cJSON *json = NULL;
+    int result = API_SUCCESS;
+    
+    // Validate inputs
+    if (!api_data || !api_url) {
+        fprintf(stderr, "Error: NULL api_data or api_url\n");
+        return API_STRUCT_INIT_ERROR;
+    }
+    
+    // Every temporary of this call comes from the request arena
+    request_arena_enter();
+    chunk = acquire_response_buffer();
+    if (!chunk) {
+        fprintf(stderr, "Error: Failed to allocate memory for response buffer\n");
+        request_arena_leave();
+        return API_MEM_ERROR;
+    }
+    
+    // Initialize curl
+    curl = curl_easy_init();
+    if (!curl) {
+        fprintf(stderr, "Error: curl_easy_init failed\n");
+        release_response_buffer(chunk);
+        request_arena_leave();
+        return API_CURL_INIT_ERROR;
+    }
+    
+    // Configure curl (fields are extracted while the body streams in)
+    curl_easy_setopt(curl, CURLOPT_URL, api_url);
+    attach_streaming_sink(curl, &sink, chunk);
+    apply_attempt_timeout(curl, NULL, api_url, NULL, 0);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    
+    // Perform request
+    res = curl_easy_perform(curl);
+    if (res != CURLE_OK) {
+        fprintf(stderr, "Error: curl_easy_perform failed: %s\n", curl_easy_strerror(res));
+        result = API_NETWORK_ERROR;
+        goto cleanup;
+    }
+    
+    // Check if we got any data
+    if (chunk->size == 0) {
+        fprintf(stderr, "Warning: Empty response from API\n");
+    }
+    
+    // Fast path: the document ended cleanly, with or without every field
+    int scan = sink.bulk_scan
+             ? sysinfo_scan_buffer(chunk->data, chunk->size, &sink.fields, &sink.ex.found)
+             : sysinfo_extractor_finish(&sink.ex);
+    if (scan == SYSINFO_SCAN_COMPLETE) {
+        apply_extracted_fields(api_data, &sink.ex);
+        goto cleanup;
+    }
+    
+    // Malformed for the streaming extractor: full parse decides, as before
+    json = cJSON_Parse(chunk->data);
+    if (json == NULL) {
+        const char *error_ptr = cJSON_GetErrorPtr();
+        if (error_ptr) {
+            fprintf(stderr, "Error: JSON parse failed at: %s\n", error_ptr);
+        } else {
+            fprintf(stderr, "Error: JSON parse failed (unknown reason)\n");
+        }
+        result = API_JSON_PARSE_ERROR;
+        goto cleanup;
+    }
+    
+    // Extract data safely
+    cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
+    cJSON *system_json = cJSON_GetObjectItem(json, "system");
+    cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
+    
+    if (cJSON_IsNumber(apimodel_json)) {
+        api_data->apimodel = apimodel_json->valueint;
+    } else {
+        fprintf(stderr, "Warning: Invalid or missing apimodel field\n");
+        api_data->apimodel = -1;  // Error value
+    }
+    
+    if (cJSON_IsNumber(system_json)) {
+        api_data->system = system_json->valueint;
+    } else {
+        fprintf(stderr, "Warning: Invalid or missing system field\n");
+        api_data->system = -1;
+    }
+    
+    if (cJSON_IsString(osname_json) && osname_json->valuestring) {
+        strncpy(api_data->osname, osname_json->valuestring, sizeof(api_data->osname) - 1);
+        api_data->osname[sizeof(api_data->osname) - 1] = '\0';
+    } else {
+        fprintf(stderr, "Warning: Invalid or missing osname field\n");
+        strcpy(api_data->osname, "Unknown");
+    }
+    
+cleanup:
+    if (json) cJSON_Delete(json);
+    curl_easy_cleanup(curl);
+    release_response_buffer(chunk);
+    request_arena_leave();
+    return result;
+}
+
+// Print results with status
+void print_api_data(const struct os *api_data, int status) {
+    printf("=== API Data Collection Results ===\n");
+    printf("Status: ");
+    
+    switch (status) {
+        case API_SUCCESS:
+            printf("SUCCESS\n");
+            break;
+        case API_MEM_ERROR:
+            printf("MEMORY ALLOCATION FAILED\n");
+            break;
+        case API_CURL_INIT_ERROR:
+            printf("CURL INITIALIZATION FAILED\n");
+            break;
+        case API_NETWORK_ERROR:
+            printf("NETWORK/CURL REQUEST FAILED\n");
+            break;
+        case API_JSON_PARSE_ERROR:
+            printf("JSON PARSING FAILED\n");
+            break;
+        case API_STRUCT_INIT_ERROR:
+            printf("STRUCT INITIALIZATION FAILED\n");
+            break;
+        default:
+            printf("UNKNOWN ERROR (%d)\n", status);
+    }
+    
+    printf("API Model: %d\n", api_data->apimodel);
+    printf("System ID: %d\n", api_data->system);
+    printf("OS Name: %s\n", api_data->osname);
+    printf("==============================\n");
+}
+
+// ---- Connection pool ----
+
+// Limits for the warm handle pool
+
+// libcurl needs these before a share handle is used from more than one thread
+static void pool_share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
+    struct curl_handle_pool *pool = (struct curl_handle_pool *)userptr;
+    (void)handle;
+    (void)access;
+    pthread_mutex_lock(&pool->share_locks[data]);
+}
+
+static void pool_share_unlock(CURL *handle, curl_lock_data data, void *userptr) {
+    struct curl_handle_pool *pool = (struct curl_handle_pool *)userptr;
+    (void)handle;
+    pthread_mutex_unlock(&pool->share_locks[data]);
+}
+
+int init_handle_pool(struct curl_handle_pool *pool) {
+    if (!pool) return API_STRUCT_INIT_ERROR;
+    
+    memset(pool, 0, sizeof(struct curl_handle_pool));
+    pthread_mutex_init(&pool->lock, NULL);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&pool->share_locks[i], NULL);
+    }
+    
+    pool->share = curl_share_init();
+    if (!pool->share) {
+        fprintf(stderr, "POOL: curl_share_init failed\n");
+        return API_CURL_INIT_ERROR;
+    }
+    curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, pool_share_lock);
+    curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC, pool_share_unlock);
+    curl_share_setopt(pool->share, CURLSHOPT_USERDATA, pool);
+    curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    
+    return API_SUCCESS;
+}
+
+// Find the slot for an endpoint, claiming a free one on first use. Caller holds pool->lock.
+static struct pool_endpoint *pool_find_endpoint(struct curl_handle_pool *pool, const char *url) {
+    for (int i = 0; i < pool->endpoint_count; i++) {
+        if (strcmp(pool->endpoints[i].url, url) == 0) {
+            return &pool->endpoints[i];
+        }
+    }
+    
+    if (pool->endpoint_count >= API_POOL_MAX_ENDPOINTS || strlen(url) >= API_POOL_URL_MAX) {
+        return NULL;  // Unpooled endpoint, handles are created and destroyed per use
+    }
+    
+    struct pool_endpoint *ep = &pool->endpoints[pool->endpoint_count++];
+    strcpy(ep->url, url);
+    return ep;
+}
+
+// Get a ready-to-configure handle for url. Falls back to curl_easy_init when pool is NULL.
+CURL *pool_acquire_handle(struct curl_handle_pool *pool, const char *url) {
+    CURL *curl = NULL;
+    
+    if (!pool || !url) {
+        return curl_easy_init();
+    }
+    
+    pthread_mutex_lock(&pool->lock);
+    struct pool_endpoint *ep = pool_find_endpoint(pool, url);
+    if (ep && ep->idle_count > 0) {
+        curl = ep->idle[--ep->idle_count];
+        pool->handles_reused++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    
+    if (curl) {
+        curl_easy_reset(curl);  // Clears options, keeps live connections and DNS cache
+    } else {
+        curl = curl_easy_init();
+        if (!curl) return NULL;
+        pthread_mutex_lock(&pool->lock);
+        pool->handles_created++;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    
+    // Reset wipes CURLOPT_SHARE as well, so reattach every time
+    if (pool->share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, pool->share);
+    }
+    return curl;
+}
+
+// Account for one finished transfer: did it open a new connection or reuse one?
+void pool_record_transfer(struct curl_handle_pool *pool, const char *url, CURL *curl) {
+    long new_connections = 0;
+    
+    if (!pool || !url || !curl) return;
+    
+    if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections) != CURLE_OK) {
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->lock);
+    struct pool_endpoint *ep = pool_find_endpoint(pool, url);
+    if (ep) ep->transfers++;
+    
+    if (new_connections == 0) {
+        pool->connections_reused++;
+        if (ep) ep->reused_connections++;
+    } else {
+        pool->connections_opened += (unsigned long)new_connections;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Park a handle for the next attempt against url, or destroy it if the slot is full
+void pool_release_handle(struct curl_handle_pool *pool, const char *url, CURL *curl) {
+    if (!curl) return;
+    
+    if (!pool || !url) {
+        curl_easy_cleanup(curl);
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->lock);
+    struct pool_endpoint *ep = pool_find_endpoint(pool, url);
+    if (ep && ep->idle_count < API_POOL_HANDLES_PER_ENDPOINT) {
+        ep->idle[ep->idle_count++] = curl;
+        curl = NULL;
+    } else {
+        pool->handles_discarded++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    
+    if (curl) curl_easy_cleanup(curl);
+}
+
+void destroy_handle_pool(struct curl_handle_pool *pool) {
+    if (!pool) return;
+    
+    for (int i = 0; i < pool->endpoint_count; i++) {
+        struct pool_endpoint *ep = &pool->endpoints[i];
+        while (ep->idle_count > 0) {
+            curl_easy_cleanup(ep->idle[--ep->idle_count]);
+        }
+    }
+    pool->endpoint_count = 0;
+    
+    if (pool->share) {
+        curl_share_cleanup(pool->share);
+        pool->share = NULL;
+    }
+    
+    pthread_mutex_destroy(&pool->lock);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&pool->share_locks[i]);
+    }
+}
+
+void print_pool_stats(struct curl_handle_pool *pool) {
+    struct pool_endpoint endpoints[API_POOL_MAX_ENDPOINTS];
+    
+    if (!pool) return;
+    
+    // Snapshot under the lock, print after: workers may be mid-transfer
+    pthread_mutex_lock(&pool->lock);
+    unsigned long created = pool->handles_created;
+    unsigned long reused = pool->handles_reused;
+    unsigned long discarded = pool->handles_discarded;
+    unsigned long opened = pool->connections_opened;
+    unsigned long conn_reused = pool->connections_reused;
+    int endpoint_count = pool->endpoint_count;
+    memcpy(endpoints, pool->endpoints, sizeof(struct pool_endpoint) * endpoint_count);
+    pthread_mutex_unlock(&pool->lock);
+    
+    unsigned long transfers = conn_reused + opened;
+    
+    printf("=== CONNECTION POOL ===\n");
+    printf("Handles: created=%lu reused=%lu discarded=%lu\n", created, reused, discarded);
+    printf("Connections: opened=%lu reused=%lu (%.1f%% reuse)\n", opened, conn_reused,
+           transfers ? (100.0 * conn_reused) / transfers : 0.0);
+    for (int i = 0; i < endpoint_count; i++) {
+        const struct pool_endpoint *ep = &endpoints[i];
+        printf("  %s: %lu transfers, %lu reused, %d idle\n",
+               ep->url, ep->transfers, ep->reused_connections, ep->idle_count);
+    }
+    printf("=======================\n");
+}
+
+// ---- Retry scheduler ----
+
+// Monotonic clock in microseconds for latency accounting and timers
+static long long api_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Hashed timer wheel: 256 slots of 10ms, timers beyond one revolution stay
+// in their slot until the wheel comes round to the right lap.
+
+int init_retry_wheel(struct retry_wheel *wheel) {
+    if (!wheel) return API_STRUCT_INIT_ERROR;
+    memset(wheel, 0, sizeof(struct retry_wheel));
+    wheel->origin_us = api_now_us();
+    return API_SUCCESS;
+}
+
+// Release the wheel's multi handle. Every job submitted to it must be done.
+void destroy_retry_wheel(struct retry_wheel *wheel) {
+    if (!wheel) return;
+    if (wheel->multi) curl_multi_cleanup(wheel->multi);
+    wheel->multi = NULL;
+    wheel->transfers = 0;
+}
+
+static unsigned long long retry_wheel_now_tick(const struct retry_wheel *wheel) {
+    return (unsigned long long)((api_now_us() - wheel->origin_us) / (RETRY_WHEEL_TICK_MS * 1000LL));
+}
+
+// Park fn(arg) to run delay_ms from now. The timer must stay valid until it fires.
+int retry_wheel_schedule(struct retry_wheel *wheel, struct retry_timer *timer,
+                         long delay_ms, retry_fn fn, void *arg) {
+    if (!wheel || !timer || !fn || timer->armed) return API_STRUCT_INIT_ERROR;
+    
+    unsigned long long ticks = (delay_ms + RETRY_WHEEL_TICK_MS - 1) / RETRY_WHEEL_TICK_MS;
+    if (ticks == 0) ticks = 1;
+    
+    timer->expires_tick = retry_wheel_now_tick(wheel) + ticks;
+    timer->fn = fn;
+    timer->arg = arg;
+    timer->armed = 1;
+    
+    unsigned int slot = (unsigned int)(timer->expires_tick % RETRY_WHEEL_SLOTS);
+    timer->next = wheel->slots[slot];
+    wheel->slots[slot] = timer;
+    wheel->pending++;
+    return API_SUCCESS;
+}
+
+// Fire every timer that is due. Returns how many callbacks ran.
+int retry_wheel_advance(struct retry_wheel *wheel) {
+    int fired = 0;
+    
+    if (!wheel) return 0;
+    
+    unsigned long long now_tick = retry_wheel_now_tick(wheel);
+    
+    while (wheel->current_tick <= now_tick) {
+        unsigned int slot = (unsigned int)(wheel->current_tick % RETRY_WHEEL_SLOTS);
+        struct retry_timer **link = &wheel->slots[slot];
+        
+        while (*link) {
+            struct retry_timer *timer = *link;
+            if (timer->expires_tick <= now_tick) {
+                *link = timer->next;    // Unlink first: the callback may re-arm it
+                timer->next = NULL;
+                timer->armed = 0;
+                wheel->pending--;
+                timer->fn(timer->arg);
+                fired++;
+            } else {
+                link = &timer->next;    // Due on a later lap
+            }
+        }
+        
+        if (wheel->current_tick == now_tick) break;
+        wheel->current_tick++;
+    }
+    return fired;
+}
+
+// Milliseconds until the next timer is due (0 if overdue, -1 if the wheel is empty)
+long retry_wheel_next_delay_ms(const struct retry_wheel *wheel) {
+    if (!wheel || wheel->pending == 0) return -1;
+    
+    unsigned long long now_tick = retry_wheel_now_tick(wheel);
+    unsigned long long best = 0;
+    int found = 0;
+    
+    for (int i = 0; i < RETRY_WHEEL_SLOTS; i++) {
+        for (const struct retry_timer *t = wheel->slots[i]; t; t = t->next) {
+            if (!found || t->expires_tick < best) {
+                best = t->expires_tick;
+                found = 1;
+            }
+        }
+    }
+    
+    if (!found || best <= now_tick) return 0;
+    return (long)((best - now_tick) * RETRY_WHEEL_TICK_MS);
+}
+
+// Wait at most max_wait_ms for the next due timer or finished transfer, then
+// handle what is due. Returns how many callbacks ran and attempts finished.
+// Callers with their own event loop use retry_wheel_next_delay_ms + advance
+// instead, and call retry_wheel_perform while wheel->transfers > 0.
+int retry_wheel_poll(struct retry_wheel *wheel, long max_wait_ms) {
+    long wait_ms = retry_wheel_next_delay_ms(wheel);
+    int finished = 0;
+    
+    if (wait_ms < 0 || wait_ms > max_wait_ms) wait_ms = max_wait_ms;
+    if (wheel && wheel->transfers > 0) {
+        // Sleep in the multi handle so a finished transfer cuts the wait short
+        curl_multi_poll(wheel->multi, NULL, 0, (int)wait_ms, NULL);
+        finished = retry_wheel_perform(wheel);
+    } else if (wait_ms > 0) {
+        usleep((useconds_t)wait_ms * 1000);
+    }
+    return finished + retry_wheel_advance(wheel);
+}
+
+// Backoff range for the blocking collectors
+
+void init_retry_backoff(struct retry_backoff *backoff, long base_ms, long cap_ms) {
+    if (!backoff) return;
+    backoff->base_ms = base_ms;
+    backoff->cap_ms = cap_ms;
+    backoff->prev_ms = base_ms;
+    backoff->seed = (unsigned int)api_now_us() ^ (unsigned int)(size_t)backoff;
+}
+
+long retry_backoff_next(struct retry_backoff *backoff) {
+    long upper = backoff->prev_ms * 3;
+    if (upper <= backoff->base_ms) upper = backoff->base_ms + 1;
+    
+    long delay = backoff->base_ms + (long)(rand_r(&backoff->seed) % (unsigned long)(upper - backoff->base_ms));
+    if (delay > backoff->cap_ms) delay = backoff->cap_ms;
+    
+    backoff->prev_ms = delay;
+    return delay;
+}
+
+// Process-wide retry budget (token bucket). Every first attempt deposits
+// `ratio` tokens, a retry spends one, and a small per-second floor keeps a
+// quiet process able to retry at all. During a fleet-wide outage retries are
+// capped at ~ratio of normal traffic instead of multiplying it.
+struct retry_budget {
+    double tokens;
+    double max_tokens;
+    double ratio;
+    double min_per_sec;
+    long long last_refill_us;
+    unsigned long retries_allowed;
+    unsigned long retries_denied;
+    pthread_mutex_t lock;
+};
+
+static struct retry_budget api_retry_budget = {
+    10.0, 10.0, 0.1, 1.0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER
+};
+
+void configure_retry_budget(double ratio, double min_per_sec, double max_tokens) {
+    pthread_mutex_lock(&api_retry_budget.lock);
+    api_retry_budget.ratio = ratio;
+    api_retry_budget.min_per_sec = min_per_sec;
+    api_retry_budget.max_tokens = max_tokens;
+    if (api_retry_budget.tokens > max_tokens) api_retry_budget.tokens = max_tokens;
+    pthread_mutex_unlock(&api_retry_budget.lock);
+}
+
+// Caller holds budget->lock
+static void retry_budget_refill(struct retry_budget *budget, double deposit) {
+    long long now = api_now_us();
+    
+    if (budget->last_refill_us > 0) {
+        deposit += budget->min_per_sec * (double)(now - budget->last_refill_us) / 1000000.0;
+    }
+    budget->last_refill_us = now;
+    
+    budget->tokens += deposit;
+    if (budget->tokens > budget->max_tokens) budget->tokens = budget->max_tokens;
+}
+
+// Call once per first attempt
+void retry_budget_on_request(void) {
+    pthread_mutex_lock(&api_retry_budget.lock);
+    retry_budget_refill(&api_retry_budget, api_retry_budget.ratio);
+    pthread_mutex_unlock(&api_retry_budget.lock);
+}
+
+// Returns 1 if a retry may go ahead, 0 if the budget is spent
+int retry_budget_try_spend(void) {
+    int allowed = 0;
+    
+    pthread_mutex_lock(&api_retry_budget.lock);
+    retry_budget_refill(&api_retry_budget, 0.0);
+    if (api_retry_budget.tokens >= 1.0) {
+        api_retry_budget.tokens -= 1.0;
+        api_retry_budget.retries_allowed++;
+        allowed = 1;
+    } else {
+        api_retry_budget.retries_denied++;
+    }
+    pthread_mutex_unlock(&api_retry_budget.lock);
+    return allowed;
+}
+
+void print_retry_budget(void) {
+    pthread_mutex_lock(&api_retry_budget.lock);
+    double tokens = api_retry_budget.tokens;
+    double max_tokens = api_retry_budget.max_tokens;
+    unsigned long allowed = api_retry_budget.retries_allowed;
+    unsigned long denied = api_retry_budget.retries_denied;
+    pthread_mutex_unlock(&api_retry_budget.lock);
+    
+    printf("Retry budget: %.1f/%.1f tokens, allowed=%lu denied=%lu\n",
+           tokens, max_tokens, allowed, denied);
+}
+
+// ---- Adaptive timeouts ----
+
+void init_timeout_policy(struct timeout_policy *policy) {
+    if (!policy) return;
+    policy->adaptive = 1;
+    policy->multiplier = API_TIMEOUT_MULTIPLIER;
+    policy->retry_multiplier = API_TIMEOUT_RETRY_MULTIPLIER;
+    policy->floor_ms = API_TIMEOUT_FLOOR_MS;
+    policy->ceiling_ms = API_TIMEOUT_CEILING_MS;
+    policy->fixed_ms = API_TIMEOUT_FIXED_MS;
+    policy->connect_ms = API_CONNECT_TIMEOUT_MS;
+}
+
+// Timeout for one attempt on url; the connect phase gets the same budget or less
+static void apply_attempt_timeout(CURL *curl, struct endpoint_registry *reg, const char *url,
+                                  const struct timeout_policy *policy, int retry) {
+    long timeout_ms = endpoint_timeout_ms(reg, url, policy, retry);
+    long connect_ms = policy ? policy->connect_ms : API_CONNECT_TIMEOUT_MS;
+    
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (connect_ms < timeout_ms) ? connect_ms : timeout_ms);
+}
+
+// ---- Recovery ----
+
+// Initialize recovery context with backup data
+int init_recovery_ctx(struct recovery_ctx *ctx, struct os *backup) {
+    if (!ctx || !backup) return API_STRUCT_INIT_ERROR;
+    
+    ctx->retry_count = 0;
+    ctx->max_retries = 3;
+    ctx->recovery_active = 0;
+    ctx->pool = NULL;
+    ctx->endpoints = NULL;
+    init_timeout_policy(&ctx->timeouts);
+    
+    // Store backup data
+    memcpy(&ctx->backup_data, backup, sizeof(struct os));
+    return API_SUCCESS;
+}
+
+// Apply Basic or Bearer credentials to a handle. Returns the header list the
+// caller must free once the transfer is over (NULL for Basic or no auth).
+static struct curl_slist *apply_auth_config(CURL *curl, const struct auth_config *auth) {
+    struct curl_slist *headers = NULL;
+    
+    if (!auth) return NULL;
+    
+    if (auth->use_basic_auth) {
+        curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+        curl_easy_setopt(curl, CURLOPT_USERNAME, auth->username);
+        curl_easy_setopt(curl, CURLOPT_PASSWORD, auth->password);
+    }
+    
+    if (auth->use_bearer_auth && auth->bearer_token[0]) {
+        char auth_header[300];
+        snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", auth->bearer_token);
+        headers = arena_slist_append(headers, auth_header);
+        headers = arena_slist_append(headers, "Accept: application/json");
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+    
+    return headers;
+}
+
+// Parse a system-info body into api_data. api_data is left untouched on failure.
+static int parse_system_info(struct os *api_data, const char *body) {
+    cJSON *json = cJSON_Parse(body);
+    if (!json) return API_JSON_PARSE_ERROR;
+    
+    cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
+    cJSON *system_json = cJSON_GetObjectItem(json, "system");
+    cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
+    
+    if (cJSON_IsNumber(apimodel_json)) api_data->apimodel = apimodel_json->valueint;
+    if (cJSON_IsNumber(system_json)) api_data->system = system_json->valueint;
+    if (cJSON_IsString(osname_json) && osname_json->valuestring) {
+        strncpy(api_data->osname, osname_json->valuestring, sizeof(api_data->osname) - 1);
+        api_data->osname[sizeof(api_data->osname) - 1] = '\0';
+    }
+    
+    cJSON_Delete(json);
+    return API_SUCCESS;
+}
+
+// RETRY WITH BACKOFF: Core recovery mechanism. auth is optional (NULL = no credentials).
+// Sleeps between retries; the scheduled collector is the non-blocking variant.
+int collect_api_data_with_recovery(struct os *api_data, const char *api_url,
+                                  struct recovery_ctx *ctx, const struct auth_config *auth) {
+    CURL *curl = NULL;
+    CURLcode res;
+    struct response_buffer *chunk = NULL;
+    long http_status = 0;
+    struct curl_slist *headers = NULL;
+    struct retry_backoff backoff;
+    struct endpoint_plan plan;
+    
+    // Re-entered from inside a transfer on the same context (e.g. from a
+    // callback): answer with the backup instead of clobbering the live state
+    if (ctx->recovery_active) {
+        memcpy(api_data, &ctx->backup_data, sizeof(struct os));
+        return API_RECOVERY_SUCCESS;
+    }
+    
+    init_retry_backoff(&backoff, API_RETRY_BASE_MS, API_RETRY_CAP_MS);
+    retry_budget_on_request();
+    
+    // api_url plus the fallbacks, best scoring first when a registry is attached
+    plan_endpoints(ctx->endpoints, api_url, &plan);
+    
+    for (int url_idx = 0; url_idx < plan.count; url_idx++) {
+        const char *url = plan.urls[url_idx];
+        ctx->retry_count = 0;
+        
+        while (ctx->retry_count < ctx->max_retries) {
+            // Skip endpoints whose breaker is open (no cost when no registry is attached)
+            if (!endpoint_allow_request(ctx->endpoints, url)) {
+                fprintf(stderr, "⛔ Circuit open, skipping %s\n", url);
+                break;
+            }
+            
+            // Buffer, header list and cJSON nodes of this attempt live in the arena
+            request_arena_enter();
+            chunk = acquire_response_buffer();
+            if (!chunk) {
+                request_arena_leave();
+                memcpy(api_data, &ctx->backup_data, sizeof(struct os));
+                return API_RECOVERY_SUCCESS;
+            }
+            
+            curl = pool_acquire_handle(ctx->pool, url);
+            if (!curl) {
+                ctx->retry_count++;
+                release_response_buffer(chunk);
+                request_arena_leave();
+                // Last try here or no budget left: fail over without waiting
+                if (ctx->retry_count >= ctx->max_retries) break;
+                if (!retry_budget_try_spend()) break;
+                usleep((useconds_t)retry_backoff_next(&backoff) * 1000);
+                continue;
+            }
+            
+            // CORE CURL SETUP
+            curl_easy_setopt(curl, CURLOPT_URL, url);
+            attach_response_buffer(curl, chunk);
+            apply_attempt_timeout(curl, ctx->endpoints, url, &ctx->timeouts, ctx->retry_count);
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+            
+            // *** AUTHENTICATION SETUP ***
+            headers = apply_auth_config(curl, auth);
+            
+            // EXECUTE WITH RECOVERY
+            long long started_us = api_now_us();
+            ctx->recovery_active = 1;
+            res = curl_easy_perform(curl);
+            ctx->recovery_active = 0;
+            
+            // Check HTTP status
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
+            
+            pool_record_transfer(ctx->pool, url, curl);
+            pool_release_handle(ctx->pool, url, curl);
+            arena_slist_free(headers);
+            
+            // AUTHENTICATION SUCCESS CHECK
+            int parsed = API_NETWORK_ERROR;
+            if (res == CURLE_OK && http_status == 200 && chunk->size > 0) {
+                parsed = parse_system_info(api_data, chunk->data);
+            }
+            release_response_buffer(chunk);
+            request_arena_leave();
+            
+            if (parsed == API_SUCCESS) {
+                record_endpoint_latency(ctx->endpoints, url, api_now_us() - started_us);
+                record_endpoint_result(ctx->endpoints, url, API_SUCCESS);
+                return API_SUCCESS;
+            }
+            
+            // SPECIFIC AUTH ERROR HANDLING
+            if (http_status == 401) {
+                fprintf(stderr, "❌ AUTH FAILED: 401 Unauthorized\n");
+                record_endpoint_result(ctx->endpoints, url, API_AUTH_ERROR);
+                return API_AUTH_ERROR;
+            }
+            
+            if (res == CURLE_OPERATION_TIMEDOUT) {
+                record_endpoint_timeout(ctx->endpoints, url, api_now_us() - started_us);
+            }
+            record_endpoint_result(ctx->endpoints, url, parsed);
+            ctx->retry_count++;
+            fprintf(stderr, "🔄 Retry %d/%d | HTTP %ld | %s\n", 
+                   ctx->retry_count, ctx->max_retries, http_status, 
+                   curl_easy_strerror(res));
+            
+            // Budget and backoff only pay for another try on this endpoint;
+            // moving on to the next one is immediate
+            if (ctx->retry_count >= ctx->max_retries) break;
+            if (!retry_budget_try_spend()) {
+                fprintf(stderr, "🔄 Retry budget exhausted, trying next endpoint\n");
+                break;
+            }
+            usleep((useconds_t)retry_backoff_next(&backoff) * 1000);
+        }
+    }
+    
+    fprintf(stderr, "🔄 RECOVERY: Using backup data\n");
+    memcpy(api_data, &ctx->backup_data, sizeof(struct os));
+    return API_RECOVERY_SUCCESS;
+}
+
+void print_recovery_status(const struct os *data, int status, const struct recovery_ctx *ctx) {
+    printf("\n=== RECOVERY REPORT ===\n");
+    printf("Final Status: ");
+    
+    switch (status) {
+        case API_SUCCESS: printf("FULL SUCCESS\n"); break;
+        case API_RECOVERY_SUCCESS: printf("RECOVERY SUCCESS (using backup/fallback)\n"); break;
+        case API_AUTH_ERROR: printf("AUTHENTICATION FAILED\n"); break;
+        default: printf("HARD FAILURE (code: %d)\n", status);
+    }
+    
+    printf("Retries Used: %d/%d\n", ctx->retry_count, ctx->max_retries);
+    if (ctx->timeouts.adaptive) {
+        printf("Timeouts: adaptive, %.1fx p99 in [%ld, %ld]ms, x%.1f per retry\n",
+               ctx->timeouts.multiplier, ctx->timeouts.floor_ms, ctx->timeouts.ceiling_ms,
+               ctx->timeouts.retry_multiplier);
+    } else {
+        printf("Timeouts: fixed, %ldms (at most %ldms)\n",
+               ctx->timeouts.fixed_ms, ctx->timeouts.ceiling_ms);
+    }
+    printf("API Model: %d | System: %d | OS: %s\n", 
+           data->apimodel, data->system, data->osname);
+    printf("==================\n\n");
+}
+
+// Auth
+
+// Initialize authentication config
+int init_auth_config(struct auth_config *auth, const char *username, const char *password) {
+    if (!auth || !username) {
+        fprintf(stderr, "AUTH: Invalid auth config parameters\n");
+        return API_STRUCT_INIT_ERROR;
+    }
+    
+    memset(auth, 0, sizeof(struct auth_config));
+    strncpy(auth->username, username, sizeof(auth->username) - 1);
+    if (password) {
+        strncpy(auth->password, password, sizeof(auth->password) - 1);
+    }
+    
+    auth->use_basic_auth = 1;  // Default to Basic Auth
+    return API_SUCCESS;
+}
+
+// Initialize Bearer token auth
+int set_bearer_token(struct auth_config *auth, const char *token) {
+    if (!auth || !token) return API_STRUCT_INIT_ERROR;
+    
+    strncpy(auth->bearer_token, token, sizeof(auth->bearer_token) - 1);
+    auth->use_bearer_auth = 1;
+    auth->use_basic_auth = 0;  // Disable basic auth
+    return API_SUCCESS;
+}
+
+// ---- Circuit breaker ----
+
+// State machine only; the registry below owns the breakers and their lock.
+
+const char *endpoint_breaker_state_name(int state) {
+    switch (state) {
+        case API_BREAKER_CLOSED: return "closed";
+        case API_BREAKER_OPEN: return "open";
+        case API_BREAKER_HALF_OPEN: return "half-open";
+        default: return "unknown";
+    }
+}
+
+static void breaker_open(struct endpoint_breaker *br, long long now) {
+    br->state = API_BREAKER_OPEN;
+    br->opened_us = now;
+    br->probe_started_us = 0;
+    br->opens++;
+}
+
+// May a request go out now? Moves open -> half-open once the cool-down is
+// over and hands the single trial slot to the caller. A trial that never
+// reports back frees the slot after another cool-down.
+static int breaker_allow(struct endpoint_breaker *br, long open_ms, long long now) {
+    switch (br->state) {
+        case API_BREAKER_OPEN:
+            if (now - br->opened_us < open_ms * 1000LL) break;
+            br->state = API_BREAKER_HALF_OPEN;
+            br->half_opens++;
+            br->probe_started_us = now;
+            return 1;
+        case API_BREAKER_HALF_OPEN:
+            if (br->probe_started_us && now - br->probe_started_us < open_ms * 1000LL) break;
+            br->probe_started_us = now;
+            return 1;
+        default:
+            return 1;
+    }
+    br->rejected++;
+    return 0;
+}
+
+// A request started at started_us was cancelled without an outcome. If it
+// was the trial (it started after the slot was taken and no later request
+// could have), free the slot so the next request probes right away.
+static void breaker_cancel(struct endpoint_breaker *br, long long started_us) {
+    if (br->state == API_BREAKER_HALF_OPEN && br->probe_started_us &&
+        br->probe_started_us <= started_us) {
+        br->probe_started_us = 0;
+    }
+}
+
+static void breaker_record(struct endpoint_breaker *br, int success, int threshold, long long now) {
+    if (success) {
+        br->consecutive_failures = 0;
+        if (br->state != API_BREAKER_CLOSED) {
+            br->state = API_BREAKER_CLOSED;
+            br->probe_started_us = 0;
+            br->closes++;
+        }
+        return;
+    }
+    
+    br->consecutive_failures++;
+    if (br->state == API_BREAKER_HALF_OPEN ||
+        (br->state == API_BREAKER_CLOSED && br->consecutive_failures >= threshold)) {
+        breaker_open(br, now);
+    }
+}
+
+// ---- Endpoint latency stats ----
+
+// Sliding window of recent latencies kept per endpoint
+
+int init_endpoint_registry(struct endpoint_registry *reg) {
+    if (!reg) return API_STRUCT_INIT_ERROR;
+    memset(reg, 0, sizeof(struct endpoint_registry));
+    reg->breaker_threshold = API_BREAKER_FAILURE_THRESHOLD;
+    reg->breaker_open_ms = API_BREAKER_OPEN_MS;
+    reg->selection = API_SELECT_SCORE;
+    reg->seed = (unsigned int)api_now_us();
+    pthread_mutex_init(&reg->lock, NULL);
+    return API_SUCCESS;
+}
+
+// Caller holds reg->lock
+static struct endpoint_stats *registry_find(struct endpoint_registry *reg, const char *url, int create) {
+    for (int i = 0; i < reg->endpoint_count; i++) {
+        if (strcmp(reg->endpoints[i].url, url) == 0) {
+            return &reg->endpoints[i];
+        }
+    }
+    
+    if (!create || reg->endpoint_count >= API_POOL_MAX_ENDPOINTS || strlen(url) >= API_POOL_URL_MAX) {
+        return NULL;
+    }
+    
+    struct endpoint_stats *st = &reg->endpoints[reg->endpoint_count++];
+    strcpy(st->url, url);
+    return st;
+}
+
+// EWMA latency inflated by the EWMA error rate. Untried endpoints score 0,
+// so each gets sampled once; open breakers sort after everything else.
+// Caller holds reg->lock.
+static double registry_score(const struct endpoint_stats *st) {
+    if (!st || st->successes + st->failures == 0) return 0.0;
+    
+    double latency = (st->sample_count > 0) ? st->ewma_latency_us : API_EWMA_UNKNOWN_US;
+    double score = latency * (1.0 + API_EWMA_ERROR_PENALTY * st->ewma_error_rate);
+    if (st->breaker.state == API_BREAKER_OPEN) score += 1e12;
+    return score;
+}
+
+static int compare_latency(const void *a, const void *b) {
+    long long x = *(const long long *)a;
+    long long y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank quantile over a sorted window
+static long long window_quantile(const long long *sorted, int count, double q) {
+    int rank = (int)(q * count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static int copy_sorted_window(const struct endpoint_stats *st, long long *out) {
+    memcpy(out, st->samples_us, sizeof(long long) * st->sample_count);
+    qsort(out, st->sample_count, sizeof(long long), compare_latency);
+    return st->sample_count;
+}
+
+// Streaming quantile in O(1) space: step the estimate up by q * step when a
+// sample lands above it and down by (1 - q) * step otherwise, so it settles
+// where a fraction 1 - q of samples exceed it. The step follows an EWMA of the
+// deviation, so the estimate scales with the endpoint and tracks drift.
+// Caller holds reg->lock.
+static void tail_record(struct endpoint_stats *st, double sample_us) {
+    const double q = API_TIMEOUT_QUANTILE;
+    
+    if (st->tail_samples++ == 0) {
+        st->tail_us = sample_us;
+        st->tail_step_us = sample_us / 2.0;
+        return;
+    }
+    
+    st->tail_step_us = API_EWMA_ALPHA * fabs(sample_us - st->tail_us) +
+                       (1.0 - API_EWMA_ALPHA) * st->tail_step_us;
+    if (sample_us > st->tail_us) {
+        st->tail_us += q * st->tail_step_us;
+    } else {
+        st->tail_us -= (1.0 - q) * st->tail_step_us;
+        if (st->tail_us < sample_us) st->tail_us = sample_us;
+    }
+}
+
+// Caller holds reg->lock
+static void window_record(struct endpoint_stats *st, long long latency_us) {
+    st->samples_us[st->sample_next] = latency_us;
+    st->sample_next = (st->sample_next + 1) % API_LATENCY_WINDOW;
+    if (st->sample_count < API_LATENCY_WINDOW) st->sample_count++;
+    st->p95_dirty = 1;
+}
+
+// p95 of the window, or -1 below API_LATENCY_MIN_SAMPLES. Caller holds reg->lock.
+static long long window_p95(struct endpoint_stats *st) {
+    long long sorted[API_LATENCY_WINDOW];
+    
+    if (st->sample_count < API_LATENCY_MIN_SAMPLES) return -1;
+    if (st->p95_dirty) {
+        int count = copy_sorted_window(st, sorted);
+        st->p95_us = window_quantile(sorted, count, 0.95);
+        st->p95_dirty = 0;
+    }
+    return st->p95_us;
+}
+
+void record_endpoint_latency(struct endpoint_registry *reg, const char *url, long long latency_us) {
+    if (!reg || !url) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 1);
+    if (st) {
+        tail_record(st, (double)latency_us);
+        st->ewma_latency_us = (st->sample_count == 0)
+            ? (double)latency_us
+            : API_EWMA_ALPHA * (double)latency_us + (1.0 - API_EWMA_ALPHA) * st->ewma_latency_us;
+        window_record(st, latency_us);
+        st->last_us = latency_us;
+    }
+    pthread_mutex_unlock(&reg->lock);
+}
+
+// An attempt cancelled after elapsed_us (a losing hedge) only shows that its
+// latency was at least that long. It may raise the p95 window and the tail
+// estimate when it is above them, but never lowers either, and it stays out
+// of the EWMA that ranks endpoints.
+void record_endpoint_cancelled(struct endpoint_registry *reg, const char *url, long long elapsed_us) {
+    if (!reg || !url) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 0);
+    if (st) {
+        if (st->tail_samples > 0 && (double)elapsed_us > st->tail_us) {
+            tail_record(st, (double)elapsed_us);
+        }
+        long long p95 = window_p95(st);
+        if (p95 >= 0 && elapsed_us > p95) window_record(st, elapsed_us);
+    }
+    pthread_mutex_unlock(&reg->lock);
+}
+
+void record_endpoint_outcome(struct endpoint_registry *reg, const char *url, int success) {
+    if (!reg || !url) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 1);
+    if (st) {
+        double miss = success ? 0.0 : 1.0;
+        st->ewma_error_rate = (st->successes + st->failures == 0)
+            ? miss
+            : API_EWMA_ALPHA * miss + (1.0 - API_EWMA_ALPHA) * st->ewma_error_rate;
+    }
+    if (st && success) {
+        st->successes++;
+    } else if (st) {
+        st->failures++;
+    }
+    if (st) breaker_record(&st->breaker, success, reg->breaker_threshold, api_now_us());
+    pthread_mutex_unlock(&reg->lock);
+}
+
+// Outcome of one attempt from its API_* status. A 401 means the endpoint
+// answered and only the credentials were wrong, so it counts as a response:
+// bad credentials never open breakers, and a 401 settles a half-open trial.
+void record_endpoint_result(struct endpoint_registry *reg, const char *url, int status) {
+    record_endpoint_outcome(reg, url, status == API_SUCCESS || status == API_AUTH_ERROR);
+}
+
+// An attempt that hit its timeout: the elapsed time is a lower bound on the
+// latency, so it also pushes the tail estimate (and the next timeout) up
+void record_endpoint_timeout(struct endpoint_registry *reg, const char *url, long long elapsed_us) {
+    if (!reg || !url) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 1);
+    if (st) {
+        st->timeouts++;
+        tail_record(st, (double)elapsed_us);
+    }
+    pthread_mutex_unlock(&reg->lock);
+}
+
+// Per-attempt timeout for url under policy (NULL = defaults), see struct timeout_policy
+long endpoint_timeout_ms(struct endpoint_registry *reg, const char *url,
+                         const struct timeout_policy *policy, int retry) {
+    struct timeout_policy defaults;
+    double tail_us = -1.0;
+    
+    if (!policy) {
+        init_timeout_policy(&defaults);
+        policy = &defaults;
+    }
+    if (retry < 0) retry = 0;
+    
+    if (policy->adaptive && reg && url) {
+        pthread_mutex_lock(&reg->lock);
+        struct endpoint_stats *st = registry_find(reg, url, 0);
+        if (st && st->tail_samples >= API_LATENCY_MIN_SAMPLES) tail_us = st->tail_us;
+        pthread_mutex_unlock(&reg->lock);
+    }
+    if (tail_us < 0) {
+        return (policy->fixed_ms < policy->ceiling_ms) ? policy->fixed_ms : policy->ceiling_ms;
+    }
+    
+    double timeout_ms = policy->multiplier * tail_us / 1000.0;
+    if (timeout_ms < policy->floor_ms) timeout_ms = policy->floor_ms;
+    for (int i = 0; i < retry && timeout_ms < policy->ceiling_ms; i++) {
+        timeout_ms *= policy->retry_multiplier;
+    }
+    if (timeout_ms > policy->ceiling_ms) timeout_ms = policy->ceiling_ms;
+    return (long)timeout_ms;
+}
+
+void configure_endpoint_breaker(struct endpoint_registry *reg, int failure_threshold, long open_ms) {
+    if (!reg) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    reg->breaker_threshold = (failure_threshold > 0) ? failure_threshold : API_BREAKER_FAILURE_THRESHOLD;
+    reg->breaker_open_ms = (open_ms > 0) ? open_ms : API_BREAKER_OPEN_MS;
+    pthread_mutex_unlock(&reg->lock);
+}
+
+// 1 if a request to url may go out now, 0 if its breaker is open. Always 1
+// without a registry. Collectors ask before every attempt.
+int endpoint_allow_request(struct endpoint_registry *reg, const char *url) {
+    if (!reg || !url) return 1;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 1);
+    int allowed = st ? breaker_allow(&st->breaker, reg->breaker_open_ms, api_now_us()) : 1;
+    pthread_mutex_unlock(&reg->lock);
+    return allowed;
+}
+
+// For a request that endpoint_allow_request let through and that was then
+// cancelled (a losing race or hedge); started_us is when it went out
+void endpoint_cancel_request(struct endpoint_registry *reg, const char *url, long long started_us) {
+    if (!reg || !url) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 0);
+    if (st) breaker_cancel(&st->breaker, started_us);
+    pthread_mutex_unlock(&reg->lock);
+}
+
+int get_endpoint_breaker(struct endpoint_registry *reg, const char *url, struct endpoint_breaker *out) {
+    if (!reg || !url || !out) return API_STRUCT_INIT_ERROR;
+    
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 0);
+    if (st) memcpy(out, &st->breaker, sizeof(struct endpoint_breaker));
+    pthread_mutex_unlock(&reg->lock);
+    return st ? API_SUCCESS : API_STRUCT_INIT_ERROR;
+}
+
+// p95 of the recent window, or -1 if there are not enough samples yet
+long long endpoint_p95_us(struct endpoint_registry *reg, const char *url) {
+    if (!reg || !url) return -1;
+    
+    long long p95 = -1;
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 0);
+    if (st) p95 = window_p95(st);
+    pthread_mutex_unlock(&reg->lock);
+    return p95;
+}
+
+int get_endpoint_latency_stats(struct endpoint_registry *reg, const char *url, struct latency_snapshot *out) {
+    long long sorted[API_LATENCY_WINDOW];
+    
+    if (!reg || !url || !out) return API_STRUCT_INIT_ERROR;
+    
+    memset(out, 0, sizeof(struct latency_snapshot));
+    pthread_mutex_lock(&reg->lock);
+    struct endpoint_stats *st = registry_find(reg, url, 0);
+    if (!st) {
+        pthread_mutex_unlock(&reg->lock);
+        return API_STRUCT_INIT_ERROR;
+    }
+    
+    out->samples = st->sample_count;
+    out->last_us = st->last_us;
+    out->successes = st->successes;
+    out->failures = st->failures;
+    out->ewma_latency_us = st->ewma_latency_us;
+    out->ewma_error_rate = st->ewma_error_rate;
+    out->score = registry_score(st);
+    out->tail_us = (st->tail_samples >= API_LATENCY_MIN_SAMPLES) ? (long long)st->tail_us : -1;
+    out->timeouts = st->timeouts;
+    int count = (st->sample_count > 0) ? copy_sorted_window(st, sorted) : 0;
+    pthread_mutex_unlock(&reg->lock);
+    
+    if (count > 0) {
+        out->p50_us = window_quantile(sorted, count, 0.50);
+        out->p95_us = window_quantile(sorted, count, 0.95);
+        out->p99_us = window_quantile(sorted, count, 0.99);
+        out->max_us = sorted[count - 1];
+    }
+    return API_SUCCESS;
+}
+
+void print_endpoint_stats(struct endpoint_registry *reg) {
+    struct latency_snapshot snap;
+    struct endpoint_breaker breaker;
+    
+    if (!reg) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    int count = reg->endpoint_count;  // Slots are only ever appended
+    pthread_mutex_unlock(&reg->lock);
+    
+    printf("=== ENDPOINT LATENCY ===\n");
+    for (int i = 0; i < count; i++) {
+        const char *url = reg->endpoints[i].url;
+        if (get_endpoint_latency_stats(reg, url, &snap) != API_SUCCESS) continue;
+        printf("%s: ok=%lu fail=%lu n=%d p50=%lldus p95=%lldus p99=%lldus max=%lldus\n",
+               url, snap.successes, snap.failures, snap.samples,
+               snap.p50_us, snap.p95_us, snap.p99_us, snap.max_us);
+        printf("  ewma=%.0fus errors=%.1f%% score=%.0f\n",
+               snap.ewma_latency_us, 100.0 * snap.ewma_error_rate, snap.score);
+        if (snap.tail_us >= 0) {
+            printf("  timeout %ldms (default policy) from p99~%lldus, timed out=%lu\n",
+                   endpoint_timeout_ms(reg, url, NULL, 0), snap.tail_us, snap.timeouts);
+        } else {
+            printf("  timeout fixed until %d samples, timed out=%lu\n",
+                   API_LATENCY_MIN_SAMPLES, snap.timeouts);
+        }
+        if (get_endpoint_breaker(reg, url, &breaker) == API_SUCCESS) {
+            printf("  breaker %s: opened=%lu half-opened=%lu closed=%lu rejected=%lu\n",
+                   endpoint_breaker_state_name(breaker.state), breaker.opens,
+                   breaker.half_opens, breaker.closes, breaker.rejected);
+        }
+    }
+    printf("========================\n");
+}
+
+// ---- Endpoint selection ----
+
+// Used when the registry has no list of its own, or there is no registry
+static const char *api_default_endpoints[] = {
+    "http://localhost:8080/api/system-info",
+    "http://127.0.0.1:8080/api/system-info",
+    "http://localhost:3000/api/system",
+    NULL
+};
+
+// Replace the registry's endpoint list (count 0 = back to the defaults).
+// Plans already handed out keep their own copy.
+int set_registry_endpoints(struct endpoint_registry *reg, const char *const *urls, int count) {
+    if (!reg || count < 0 || count > API_POOL_MAX_ENDPOINTS || (count > 0 && !urls)) {
+        return API_STRUCT_INIT_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!urls[i] || strlen(urls[i]) >= API_POOL_URL_MAX) return API_STRUCT_INIT_ERROR;
+    }
+    
+    pthread_mutex_lock(&reg->lock);
+    for (int i = 0; i < count; i++) {
+        strcpy(reg->endpoint_urls[i], urls[i]);
+    }
+    reg->endpoint_url_count = count;
+    pthread_mutex_unlock(&reg->lock);
+    return API_SUCCESS;
+}
+
+void configure_endpoint_selection(struct endpoint_registry *reg, int mode) {
+    if (!reg) return;
+    
+    pthread_mutex_lock(&reg->lock);
+    reg->selection = (mode >= API_SELECT_ORDERED && mode <= API_SELECT_P2C) ? mode : API_SELECT_SCORE;
+    pthread_mutex_unlock(&reg->lock);
+}
+
+double endpoint_score(struct endpoint_registry *reg, const char *url) {
+    if (!reg || !url) return 0.0;
+    
+    pthread_mutex_lock(&reg->lock);
+    double score = registry_score(registry_find(reg, url, 0));
+    pthread_mutex_unlock(&reg->lock);
+    return score;
+}
+
+static void plan_add(struct endpoint_plan *plan, const char *url) {
+    if (!url || !url[0] || strlen(url) >= API_POOL_URL_MAX || plan->count >= API_POOL_MAX_ENDPOINTS) return;
+    for (int i = 0; i < plan->count; i++) {
+        if (strcmp(plan->urls[i], url) == 0) return;
+    }
+    strcpy(plan->urls[plan->count++], url);
+}
+
+// Fill plan with the endpoints to try, best first. primary (optional) joins
+// the list and wins ties. Without a registry the order is primary, then the
+// defaults. Returns the number of endpoints.
+int plan_endpoints(struct endpoint_registry *reg, const char *primary, struct endpoint_plan *plan) {
+    double scores[API_POOL_MAX_ENDPOINTS];
+    
+    if (!plan) return 0;
+    plan->count = 0;
+    plan_add(plan, primary);
+    
+    if (!reg) {
+        for (int i = 0; api_default_endpoints[i]; i++) plan_add(plan, api_default_endpoints[i]);
+        return plan->count;
+    }
+    
+    pthread_mutex_lock(&reg->lock);
+    if (reg->endpoint_url_count > 0) {
+        for (int i = 0; i < reg->endpoint_url_count; i++) plan_add(plan, reg->endpoint_urls[i]);
+    } else {
+        for (int i = 0; api_default_endpoints[i]; i++) plan_add(plan, api_default_endpoints[i]);
+    }
+    
+    if (reg->selection != API_SELECT_ORDERED) {
+        for (int i = 0; i < plan->count; i++) {
+            scores[i] = registry_score(registry_find(reg, plan->urls[i], 0));
+        }
+        
+        // Stable insertion sort, at most API_POOL_MAX_ENDPOINTS entries
+        for (int i = 1; i < plan->count; i++) {
+            char url[API_POOL_URL_MAX];
+            double score = scores[i];
+            int j = i;
+            strcpy(url, plan->urls[i]);
+            while (j > 0 && scores[j - 1] > score) {
+                scores[j] = scores[j - 1];
+                strcpy(plan->urls[j], plan->urls[j - 1]);
+                j--;
+            }
+            scores[j] = score;
+            strcpy(plan->urls[j], url);
+        }
+        
+        // Two random candidates, the better one goes first. Spreads load
+        // across near-equal endpoints instead of piling onto the single best.
+        if (reg->selection == API_SELECT_P2C && plan->count >= 2) {
+            int a = (int)(rand_r(&reg->seed) % (unsigned int)plan->count);
+            int b = (int)(rand_r(&reg->seed) % (unsigned int)(plan->count - 1));
+            if (b >= a) b++;
+            int pick = (scores[a] <= scores[b]) ? a : b;
+            if (pick > 0) {
+                char url[API_POOL_URL_MAX];
+                strcpy(url, plan->urls[pick]);
+                memmove(plan->urls[1], plan->urls[0], (size_t)pick * API_POOL_URL_MAX);
+                strcpy(plan->urls[0], url);
+            }
+        }
+    }
+    pthread_mutex_unlock(&reg->lock);
+    return plan->count;
+}
+
+// ---- Latency histogram ----
+
+// Values below 2^SUB_BITS get one slot each. Above that, every power-of-two
+// range is split into 2^(SUB_BITS-1) equal slots.
+static int histogram_index(long long value) {
+    if (value < (1LL << API_HIST_SUB_BITS)) return (int)value;
+    
+    int magnitude = 63 - __builtin_clzll((unsigned long long)value);
+    int shift = magnitude - (API_HIST_SUB_BITS - 1);
+    int sub = (int)(value >> shift) - (1 << (API_HIST_SUB_BITS - 1));
+    return (1 << API_HIST_SUB_BITS) + (shift - 1) * (1 << (API_HIST_SUB_BITS - 1)) + sub;
+}
+
+// Largest value that lands in slot idx
+static long long histogram_highest(int idx) {
+    if (idx < (1 << API_HIST_SUB_BITS)) return idx;
+    
+    int rel = idx - (1 << API_HIST_SUB_BITS);
+    int shift = rel / (1 << (API_HIST_SUB_BITS - 1)) + 1;
+    long long sub = rel % (1 << (API_HIST_SUB_BITS - 1)) + (1 << (API_HIST_SUB_BITS - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+void init_latency_histogram(struct latency_histogram *hist) {
+    if (!hist) return;
+    memset(hist, 0, sizeof(struct latency_histogram));
+    hist->min_us = API_HIST_MAX_US;
+}
+
+void latency_histogram_record(struct latency_histogram *hist, long long value_us) {
+    if (!hist) return;
+    
+    if (value_us < 0) value_us = 0;
+    if (value_us > API_HIST_MAX_US) value_us = API_HIST_MAX_US;
+    
+    hist->counts[histogram_index(value_us)]++;
+    hist->total++;
+    hist->sum_us += (double)value_us;
+    if (value_us < hist->min_us) hist->min_us = value_us;
+    if (value_us > hist->max_us) hist->max_us = value_us;
+}
+
+void latency_histogram_merge(struct latency_histogram *dst, const struct latency_histogram *src) {
+    if (!dst || !src || src->total == 0) return;
+    
+    for (int i = 0; i < API_HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    dst->sum_us += src->sum_us;
+    if (src->min_us < dst->min_us) dst->min_us = src->min_us;
+    if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+}
+
+// Value at percentile (0..100), reported as the top of its slot like
+// HdrHistogram does. 0 for an empty histogram.
+long long latency_histogram_percentile(const struct latency_histogram *hist, double percentile) {
+    if (!hist || hist->total == 0) return 0;
+    if (percentile >= 100.0) return hist->max_us;
+    
+    unsigned long long rank = (unsigned long long)(percentile / 100.0 * (double)hist->total + 0.5);
+    if (rank < 1) rank = 1;
+    
+    unsigned long long seen = 0;
+    for (int i = 0; i < API_HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            long long value = histogram_highest(i);
+            return (value > hist->max_us) ? hist->max_us : value;
+        }
+    }
+    return hist->max_us;
+}
+
+double latency_histogram_mean(const struct latency_histogram *hist) {
+    if (!hist || hist->total == 0) return 0.0;
+    return hist->sum_us / (double)hist->total;
+}
+
+// ---- Concurrent collection ----
+
+#define API_MAX_INFLIGHT 8
+
+// One in-flight request driven by the multi handle
+struct multi_attempt {
+    CURL *curl;
+    const char *url;
+    struct response_buffer *chunk;
+    struct curl_slist *headers;
+    long long started_us;
+    int active;
+};
+
+// Configure and add one request to the multi handle
+static int start_multi_attempt(CURLM *multi, struct multi_attempt *att, const char *url,
+                               struct recovery_ctx *ctx, const struct auth_config *auth) {
+    memset(att, 0, sizeof(struct multi_attempt));
+    att->url = url;
+    
+    att->chunk = acquire_response_buffer();
+    if (!att->chunk) return API_MEM_ERROR;
+    
+    att->curl = pool_acquire_handle(ctx->pool, url);
+    if (!att->curl) {
+        release_response_buffer(att->chunk);
+        return API_CURL_INIT_ERROR;
+    }
+    
+    curl_easy_setopt(att->curl, CURLOPT_URL, url);
+    attach_response_buffer(att->curl, att->chunk);
+    curl_easy_setopt(att->curl, CURLOPT_PRIVATE, (void *)att);
+    apply_attempt_timeout(att->curl, ctx->endpoints, url, &ctx->timeouts, 0);
+    curl_easy_setopt(att->curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(att->curl, CURLOPT_NOSIGNAL, 1L);
+    att->headers = apply_auth_config(att->curl, auth);
+    
+    if (curl_multi_add_handle(multi, att->curl) != CURLM_OK) {
+        pool_release_handle(ctx->pool, url, att->curl);
+        arena_slist_free(att->headers);
+        release_response_buffer(att->chunk);
+        return API_CURL_INIT_ERROR;
+    }
+    
+    att->started_us = api_now_us();
+    att->active = 1;
+    return API_SUCCESS;
+}
+
+// Detach a finished or cancelled request and hand its handle back to the pool
+static void end_multi_attempt(CURLM *multi, struct multi_attempt *att,
+                              struct recovery_ctx *ctx, int completed) {
+    if (!att->active) return;
+    
+    curl_multi_remove_handle(multi, att->curl);
+    if (completed) {
+        pool_record_transfer(ctx->pool, att->url, att->curl);
+    }
+    pool_release_handle(ctx->pool, att->url, att->curl);
+    arena_slist_free(att->headers);
+    release_response_buffer(att->chunk);
+    
+    att->curl = NULL;
+    att->headers = NULL;
+    att->chunk = NULL;
+    att->active = 0;
+}
+
+// Check a completed transfer. Returns API_SUCCESS when it produced usable data.
+static int finish_multi_attempt(struct multi_attempt *att, CURLcode res, struct os *api_data) {
+    long http_status = 0;
+    
+    curl_easy_getinfo(att->curl, CURLINFO_RESPONSE_CODE, &http_status);
+    
+    if (http_status == 401) {
+        fprintf(stderr, "MULTI: 401 Unauthorized from %s\n", att->url);
+        return API_AUTH_ERROR;
+    }
+    if (res != CURLE_OK || http_status != 200 || att->chunk->size == 0) {
+        fprintf(stderr, "MULTI: %s failed | HTTP %ld | %s\n",
+                att->url, http_status, curl_easy_strerror(res));
+        return API_NETWORK_ERROR;
+    }
+    return parse_system_info(api_data, att->chunk->data);
+}
+
+// Race every configured endpoint from one event loop; the first valid JSON
+// response wins and the remaining transfers are cancelled. Worst case costs a
+// single timeout instead of max_retries timeouts per endpoint.
+int collect_api_data_concurrent(struct os *api_data, struct recovery_ctx *ctx,
+                                const struct auth_config *auth) {
+    struct multi_attempt attempts[API_MAX_INFLIGHT];
+    struct endpoint_plan plan;
+    struct os candidate;
+    CURLM *multi = NULL;
+    int attempt_count = 0;
+    int active = 0;
+    int result = API_NETWORK_ERROR;
+    int saw_parse_error = 0;
+    int saw_auth_error = 0;
+    
+    if (!api_data || !ctx) return API_STRUCT_INIT_ERROR;
+    
+    multi = curl_multi_init();
+    if (!multi) {
+        fprintf(stderr, "MULTI: curl_multi_init failed\n");
+        return API_CURL_INIT_ERROR;
+    }
+    request_arena_enter();
+    
+    plan_endpoints(ctx->endpoints, NULL, &plan);
+    for (int i = 0; i < plan.count && attempt_count < API_MAX_INFLIGHT; i++) {
+        if (!endpoint_allow_request(ctx->endpoints, plan.urls[i])) continue;
+        if (start_multi_attempt(multi, &attempts[attempt_count], plan.urls[i], ctx, auth) == API_SUCCESS) {
+            attempt_count++;
+            active++;
+        }
+    }
+    
+    while (active > 0 && result != API_SUCCESS) {
+        int running = 0;
+        int queued = 0;
+        CURLMsg *msg;
+        
+        if (curl_multi_perform(multi, &running) != CURLM_OK) break;
+        
+        while (result != API_SUCCESS && (msg = curl_multi_info_read(multi, &queued)) != NULL) {
+            struct multi_attempt *att = NULL;
+            
+            if (msg->msg != CURLMSG_DONE) continue;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&att);
+            if (!att) continue;
+            
+            memcpy(&candidate, api_data, sizeof(struct os));
+            int status = finish_multi_attempt(att, msg->data.result, &candidate);
+            if (msg->data.result == CURLE_OPERATION_TIMEDOUT) {
+                record_endpoint_timeout(ctx->endpoints, att->url, api_now_us() - att->started_us);
+            }
+            record_endpoint_result(ctx->endpoints, att->url, status);
+            if (status == API_SUCCESS) {
+                record_endpoint_latency(ctx->endpoints, att->url, api_now_us() - att->started_us);
+                memcpy(api_data, &candidate, sizeof(struct os));
+                result = API_SUCCESS;
+            } else if (status == API_JSON_PARSE_ERROR) {
+                saw_parse_error = 1;
+            } else if (status == API_AUTH_ERROR) {
+                saw_auth_error = 1;
+            }
+            
+            end_multi_attempt(multi, att, ctx, 1);
+            active--;
+        }
+        
+        if (result != API_SUCCESS && active > 0) {
+            curl_multi_poll(multi, NULL, 0, 1000, NULL);
+        }
+    }
+    
+    // Cancel the losers, handing back a half-open trial slot one of them holds
+    for (int i = 0; i < attempt_count; i++) {
+        if (attempts[i].active) {
+            endpoint_cancel_request(ctx->endpoints, attempts[i].url, attempts[i].started_us);
+        }
+        end_multi_attempt(multi, &attempts[i], ctx, 0);
+    }
+    curl_multi_cleanup(multi);
+    request_arena_leave();
+    
+    if (result == API_SUCCESS) return API_SUCCESS;
+    
+    if (saw_auth_error && !saw_parse_error) {
+        fprintf(stderr, "MULTI: All endpoints rejected credentials\n");
+        return API_AUTH_ERROR;
+    }
     
-    return handler;
+    fprintf(stderr, "MULTI: No endpoint returned valid data (%s), restoring backup data\n",
+            saw_parse_error ? "bad JSON" : "network");
+    memcpy(api_data, &ctx->backup_data, sizeof(struct os));
+    return API_RECOVERY_SUCCESS;
 }
 
-// Function to record a log message with timestamp and level
-void record_lumen_log(LumenLogHandler* handler, const char* message, int level) {
-    if (handler == NULL || message == NULL) {
-        return;
+// ---- Hedged collection ----
+
+// Hedge delay bounds, used until an endpoint has enough latency samples
+#define API_HEDGE_DEFAULT_MS 100
+#define API_HEDGE_MIN_MS 5
+#define API_HEDGE_MAX_MS 2000
+#define API_HEDGE_MAX_EXTRA 1   // Duplicates fired on timer (failures still fail over)
+
+// How long to wait on url before sending a duplicate elsewhere: its recent p95
+static long long hedge_delay_us(struct endpoint_registry *reg, const char *url) {
+    long long delay = endpoint_p95_us(reg, url);
+    
+    if (delay < 0) delay = API_HEDGE_DEFAULT_MS * 1000LL;
+    if (delay < API_HEDGE_MIN_MS * 1000LL) delay = API_HEDGE_MIN_MS * 1000LL;
+    if (delay > API_HEDGE_MAX_MS * 1000LL) delay = API_HEDGE_MAX_MS * 1000LL;
+    return delay;
+}
+
+// Send to the primary endpoint only; if it has not answered within its p95,
+// fire a duplicate at the next endpoint and take whichever answers first.
+// Load stays at ~1 request per poll while the tail is cut to roughly p95.
+int collect_api_data_hedged(struct os *api_data, struct recovery_ctx *ctx,
+                            const struct auth_config *auth) {
+    struct multi_attempt attempts[API_MAX_INFLIGHT];
+    struct endpoint_plan plan;
+    struct os candidate;
+    CURLM *multi = NULL;
+    int attempt_count = 0;
+    int next_url = 0;
+    int hedges_fired = 0;
+    int active = 0;
+    int result = API_NETWORK_ERROR;
+    int saw_parse_error = 0;
+    int saw_auth_error = 0;
+    long long hedge_at_us = 0;
+    
+    if (!api_data || !ctx) return API_STRUCT_INIT_ERROR;
+    
+    multi = curl_multi_init();
+    if (!multi) {
+        fprintf(stderr, "HEDGE: curl_multi_init failed\n");
+        return API_CURL_INIT_ERROR;
     }
+    request_arena_enter();
+    plan_endpoints(ctx->endpoints, NULL, &plan);  // Primary is the best scoring endpoint
     
-    if (level >= handler->log_level) {
-        struct tm* time_info = localtime(&handler->timestamp);
-        char time_str[64];
-        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", time_info);
+    for (;;) {
+        long long now = api_now_us();
+        int launch = 0;
         
-        snprintf(handler->log_buffer, sizeof(handler->log_buffer), 
-                 "%s %s [Level %d]: %s\n", 
-                 handler->device_marker, time_str, level, message);
+        // Launch the primary, a timer-triggered hedge, or a failover when nothing is in flight
+        if (next_url < plan.count && attempt_count < API_MAX_INFLIGHT &&
+            (active == 0 || (hedges_fired < API_HEDGE_MAX_EXTRA && now >= hedge_at_us))) {
+            // Asked only when about to send, so a half-open trial slot is never taken and left unused
+            if (!endpoint_allow_request(ctx->endpoints, plan.urls[next_url])) {
+                next_url++;
+                continue;
+            }
+            launch = 1;
+            if (active > 0) hedges_fired++;
+        }
         
-        handler->status_flag = 1;  // Logged
-    } else {
-        handler->status_flag = -1;  // Level too low
+        if (launch) {
+            const char *url = plan.urls[next_url++];
+            if (start_multi_attempt(multi, &attempts[attempt_count], url, ctx, auth) == API_SUCCESS) {
+                attempt_count++;
+                active++;
+                hedge_at_us = api_now_us() + hedge_delay_us(ctx->endpoints, url);
+            }
+            continue;
+        }
+        
+        if (active == 0) break;  // Every endpoint tried and failed
+        
+        int running = 0;
+        int queued = 0;
+        CURLMsg *msg;
+        
+        if (curl_multi_perform(multi, &running) != CURLM_OK) break;
+        
+        while (result != API_SUCCESS && (msg = curl_multi_info_read(multi, &queued)) != NULL) {
+            struct multi_attempt *att = NULL;
+            
+            if (msg->msg != CURLMSG_DONE) continue;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&att);
+            if (!att) continue;
+            
+            memcpy(&candidate, api_data, sizeof(struct os));
+            int status = finish_multi_attempt(att, msg->data.result, &candidate);
+            if (msg->data.result == CURLE_OPERATION_TIMEDOUT) {
+                record_endpoint_timeout(ctx->endpoints, att->url, api_now_us() - att->started_us);
+            }
+            record_endpoint_result(ctx->endpoints, att->url, status);
+            if (status == API_SUCCESS) {
+                record_endpoint_latency(ctx->endpoints, att->url, api_now_us() - att->started_us);
+                memcpy(api_data, &candidate, sizeof(struct os));
+                result = API_SUCCESS;
+            } else if (status == API_JSON_PARSE_ERROR) {
+                saw_parse_error = 1;
+            } else if (status == API_AUTH_ERROR) {
+                saw_auth_error = 1;
+            }
+            
+            end_multi_attempt(multi, att, ctx, 1);
+            active--;
+        }
+        
+        if (result == API_SUCCESS) break;
+        
+        if (active > 0) {
+            long long wait_us = 1000000LL;
+            if (next_url < plan.count && hedges_fired < API_HEDGE_MAX_EXTRA) {
+                wait_us = hedge_at_us - api_now_us();
+                if (wait_us < 0) wait_us = 0;
+                if (wait_us > 1000000LL) wait_us = 1000000LL;
+            }
+            curl_multi_poll(multi, NULL, 0, (int)((wait_us + 999) / 1000), NULL);
+        }
     }
-}
-
-// Function to output the log with Lumen-specific handling
-void output_lumen_log(LumenLogHandler* handler) {
-    if (handler != NULL && handler->status_flag == 1) {
-#ifdef LUMEN_SYSTEM
-        // Simulate Lumen mobile logging (e.g., to console or file)
-        printf("%s", handler->log_buffer);
-#else
-        printf("Log: %s", handler->log_buffer);
-#endif
-        // Reset buffer after output
-        memset(handler->log_buffer, 0, sizeof(handler->log_buffer));
-    } else {
-        printf("No log to output or error occurred\n");
+    
+    // Cancel the loser. Its elapsed time is a lower bound on its latency: it
+    // can raise the p95 (or slow answers never would) but not lower it.
+    for (int i = 0; i < attempt_count; i++) {
+        if (attempts[i].active) {
+            record_endpoint_cancelled(ctx->endpoints, attempts[i].url, api_now_us() - attempts[i].started_us);
+            endpoint_cancel_request(ctx->endpoints, attempts[i].url, attempts[i].started_us);
+        }
+        end_multi_attempt(multi, &attempts[i], ctx, 0);
     }
-}
-
-// Function to release the logger resources
-void release_lumen_logger(LumenLogHandler* handler) {
-    if (handler != NULL) {
-        free(handler);
+    curl_multi_cleanup(multi);
+    request_arena_leave();
+    
+    if (result == API_SUCCESS) return API_SUCCESS;
+    
+    if (saw_auth_error && !saw_parse_error) {
+        fprintf(stderr, "HEDGE: All endpoints rejected credentials\n");
+        return API_AUTH_ERROR;
     }
+    
+    fprintf(stderr, "HEDGE: No endpoint returned valid data, restoring backup data\n");
+    memcpy(api_data, &ctx->backup_data, sizeof(struct os));
+    return API_RECOVERY_SUCCESS;
 }
 
-int main() {
-    // Create logger with minimum level 2
-    LumenLogHandler* logger = create_lumen_logger(2);
-    if (logger == NULL) {
-        printf("Logger creation failed on Lumen OS\n");
-        return 1;
+// ---- Scheduled collection ----
+
+// Add one attempt against url to the wheel's multi handle
+static int start_collect_attempt(struct collect_job *job, const char *url) {
+    struct retry_wheel *wheel = job->wheel;
+    
+    if (!wheel->multi) {
+        wheel->multi = curl_multi_init();
+        if (!wheel->multi) return API_CURL_INIT_ERROR;
     }
     
-    // Record some logs
-    record_lumen_log(logger, "System boot initiated", 3);
-    output_lumen_log(logger);
+    job->chunk = acquire_response_buffer();
+    if (!job->chunk) return API_MEM_ERROR;
     
-    record_lumen_log(logger, "Debug info: Memory check passed", 1);  // Below level, skipped
-    output_lumen_log(logger);
+    job->curl = pool_acquire_handle(job->ctx->pool, url);
+    if (!job->curl) {
+        release_response_buffer(job->chunk);
+        job->chunk = NULL;
+        return API_CURL_INIT_ERROR;
+    }
     
-    record_lumen_log(logger, "Warning: Low battery detected", 2);
-    output_lumen_log(logger);
+    curl_easy_setopt(job->curl, CURLOPT_URL, url);
+    attach_response_buffer(job->curl, job->chunk);
+    curl_easy_setopt(job->curl, CURLOPT_PRIVATE, (void *)job);
+    apply_attempt_timeout(job->curl, job->ctx->endpoints, url, &job->ctx->timeouts, job->retry_count);
+    curl_easy_setopt(job->curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(job->curl, CURLOPT_NOSIGNAL, 1L);
+    job->headers = apply_auth_config(job->curl, job->auth);
     
-    // Update timestamp for next logs
-    time(&logger->timestamp);
+    if (curl_multi_add_handle(wheel->multi, job->curl) != CURLM_OK) {
+        pool_release_handle(job->ctx->pool, url, job->curl);
+        arena_slist_free(job->headers);
+        release_response_buffer(job->chunk);
+        job->curl = NULL;
+        job->headers = NULL;
+        job->chunk = NULL;
+        return API_CURL_INIT_ERROR;
+    }
     
-    record_lumen_log(logger, "Error: Connection timeout", 4);
-    output_lumen_log(logger);
+    job->started_us = api_now_us();
+    wheel->transfers++;
+    return API_SUCCESS;
+}
+
+// Judge a finished transfer and hand its handle back to the pool
+static int finish_collect_attempt(struct collect_job *job, CURLcode res) {
+    const char *url = job->plan.urls[job->url_idx];
+    struct recovery_ctx *ctx = job->ctx;
+    struct os candidate;
+    long http_status = 0;
+    int status;
     
-    // Delay to simulate Lumen OS processing
-    usleep(250000);  // 0.25s
+    curl_easy_getinfo(job->curl, CURLINFO_RESPONSE_CODE, &http_status);
     
-    // Release
-    release_lumen_logger(logger);
+    if (http_status == 401) {
+        status = API_AUTH_ERROR;
+    } else if (res != CURLE_OK || http_status != 200 || job->chunk->size == 0) {
+        status = API_NETWORK_ERROR;
+    } else {
+        request_arena_enter();
+        memcpy(&candidate, job->api_data, sizeof(struct os));
+        status = parse_system_info(&candidate, job->chunk->data);
+        request_arena_leave();
+        if (status == API_SUCCESS) {
+            memcpy(job->api_data, &candidate, sizeof(struct os));
+            record_endpoint_latency(ctx->endpoints, url, api_now_us() - job->started_us);
+        }
+    }
+    if (res == CURLE_OPERATION_TIMEDOUT) {
+        record_endpoint_timeout(ctx->endpoints, url, api_now_us() - job->started_us);
+    }
+    record_endpoint_result(ctx->endpoints, url, status);
     
-    return 0;
+    curl_multi_remove_handle(job->wheel->multi, job->curl);
+    pool_record_transfer(ctx->pool, url, job->curl);
+    pool_release_handle(ctx->pool, url, job->curl);
+    arena_slist_free(job->headers);
+    release_response_buffer(job->chunk);
+    job->curl = NULL;
+    job->headers = NULL;
+    job->chunk = NULL;
+    return status;
 }
 
-// Function to initialize on boot
-
-// Texts
-
-// ---- API data collection ----
-
-// Fixed API Module struct - using flexible array member for osname
-struct os {
-    int apimodel;
-    int system;
-    char osname[1];  // Flexible array member - allocate more space at runtime
-};
+static void complete_collect_job(struct collect_job *job, int status) {
+    if (status == API_RECOVERY_SUCCESS) {
+        memcpy(job->api_data, &job->ctx->backup_data, sizeof(struct os));
+    }
+    job->status = status;
+    job->done = 1;
+    if (job->on_done) job->on_done(job);
+}
 
-// Callback for curl to collect response data
-struct MemoryStruct {
-    char *memory;
-    size_t size;
-};
+static void collect_job_failed(struct collect_job *job);
 
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
+// Timer callback: start the attempt on the current endpoint
+static void run_collect_attempt(void *arg) {
+    struct collect_job *job = (struct collect_job *)arg;
     
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        printf("Not enough memory (realloc returned NULL)
-");
-        return 0;
+    while (job->url_idx < job->plan.count &&
+           !endpoint_allow_request(job->ctx->endpoints, job->plan.urls[job->url_idx])) {
+        job->url_idx++;
+        job->retry_count = 0;
+    }
+    if (job->url_idx >= job->plan.count) {
+        fprintf(stderr, "SCHED: No endpoint left to try, restoring backup data\n");
+        complete_collect_job(job, API_RECOVERY_SUCCESS);
+        return;
     }
     
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
-    
-    return realsize;
+    if (start_collect_attempt(job, job->plan.urls[job->url_idx]) != API_SUCCESS) {
+        collect_job_failed(job);
+    }
 }
 
-// Function to collect API data and populate struct
-int collect_api_data(struct os *api_data, const char *api_url) {
-    CURL *curl;
-    CURLcode res;
-    struct MemoryStruct chunk;
-    
-    chunk.memory = malloc(1);
-    chunk.size = 0;
+// Park a retry on the same endpoint while retries and budget allow it,
+// otherwise fail over to the next endpoint straight away
+static void collect_job_failed(struct collect_job *job) {
+    job->retry_count++;
     
-    curl = curl_easy_init();
-    if (curl) {
-        curl_easy_setopt(curl, CURLOPT_URL, api_url);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-        
-        res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            fprintf(stderr, "curl_easy_perform() failed: %s
-", curl_easy_strerror(res));
-            curl_easy_cleanup(curl);
-            free(chunk.memory);
-            return -1;
+    if (job->retry_count < job->ctx->max_retries) {
+        if (retry_budget_try_spend()) {
+            long delay_ms = retry_backoff_next(&job->backoff);
+            fprintf(stderr, "SCHED: Retry %d on %s parked for %ldms\n",
+                    job->retry_count, job->plan.urls[job->url_idx], delay_ms);
+            retry_wheel_schedule(job->wheel, &job->timer, delay_ms, run_collect_attempt, job);
+            return;
         }
-        
-        curl_easy_cleanup(curl);
+        fprintf(stderr, "SCHED: Retry budget exhausted, trying next endpoint\n");
     }
     
-    // Parse JSON response (example assumes API returns system info)
-    cJSON *json = cJSON_Parse(chunk.memory);
-    if (json != NULL) {
-        // Example: extract apimodel and system from JSON response
-        cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
-        cJSON *system_json = cJSON_GetObjectItem(json, "system");
-        cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
+    job->url_idx++;
+    job->retry_count = 0;
+    run_collect_attempt(job);
+}
+
+// Drive the wheel's transfers without blocking and settle the finished ones.
+// Returns how many attempts finished.
+int retry_wheel_perform(struct retry_wheel *wheel) {
+    int running = 0;
+    int queued = 0;
+    int finished = 0;
+    CURLMsg *msg;
+    
+    if (!wheel || !wheel->multi || wheel->transfers == 0) return 0;
+    
+    curl_multi_perform(wheel->multi, &running);
+    while ((msg = curl_multi_info_read(wheel->multi, &queued)) != NULL) {
+        if (msg->msg != CURLMSG_DONE) continue;
         
-        if (apimodel_json) api_data->apimodel = apimodel_json->valueint;
-        if (system_json) api_data->system = system_json->valueint;
-        if (osname_json && cJSON_IsString(osname_json)) {
-            strncpy(api_data->osname, osname_json->valuestring, 99);
-            api_data->osname[99] = '';
-        }
+        struct collect_job *job = NULL;
+        CURLcode res = msg->data.result;    // msg is gone once the handle is removed
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&job);
+        wheel->transfers--;
+        finished++;
         
-        cJSON_Delete(json);
+        int status = finish_collect_attempt(job, res);
+        if (status == API_SUCCESS || status == API_AUTH_ERROR) {
+            complete_collect_job(job, status);
+        } else {
+            collect_job_failed(job);
+        }
     }
-    
-    free(chunk.memory);
-    return 0;
+    return finished;
 }
 
-int main() {
-    // Allocate space for struct + osname string (100 chars)
-    struct os *h1 = malloc(sizeof(struct os) + 100);
-    if (!h1) {
-        printf("Memory allocation failed
-");
-        return 1;
-    }
+// Queue a collection; the first attempt starts on the next retry_wheel_advance
+// and is driven by retry_wheel_poll / retry_wheel_perform from then on.
+// job must stay valid until job->done is set (on_done, if given, is called then).
+int submit_collect_job(struct retry_wheel *wheel, struct collect_job *job,
+                       struct os *api_data, struct recovery_ctx *ctx,
+                       const struct auth_config *auth, void (*on_done)(struct collect_job *job)) {
+    if (!wheel || !job || !api_data || !ctx) return API_STRUCT_INIT_ERROR;
     
-    // Collect data from internal API
-    const char *internal_api = "http://localhost:8080/api/system-info";
-    if (collect_api_data(h1, internal_api) == 0) {
-        printf("API Data Collected:
-");
-        printf("OS Name: %s
-", h1->osname);
-        printf("API Model: %d
-", h1->apimodel);
-        printf("System ID: %d
-", h1->system);
-    } else {
-        // Fallback values if API fails
-        h1->apimodel = 1;
-        h1->system = 1;
-        strcpy(h1->osname, "Lumen");
-        printf("Using fallback values
-");
-    }
+    memset(job, 0, sizeof(struct collect_job));
+    job->api_data = api_data;
+    job->ctx = ctx;
+    job->auth = auth;
+    job->wheel = wheel;
+    job->on_done = on_done;
+    job->status = API_SUCCESS;
+    init_retry_backoff(&job->backoff, API_RETRY_BASE_MS, API_RETRY_CAP_MS);
+    plan_endpoints(ctx->endpoints, NULL, &job->plan);
     
-    free(h1);
-    return 0;
+    retry_budget_on_request();
+    return retry_wheel_schedule(wheel, &job->timer, 0, run_collect_attempt, job);
 }
 
-// Redirect to Website
-
-// ---- Error handling ----
-
-// API Module struct with proper size
-struct os {
-    int apimodel;
-    int system;
-    char osname[100];  // Fixed size for simplicity
-};
+// ---- Response cache ----
 
-// Error codes
-enum API_ERROR {
-    API_SUCCESS = 0,
-    API_MEM_ERROR = -1,
-    API_CURL_INIT_ERROR = -2,
-    API_NETWORK_ERROR = -3,
-    API_JSON_PARSE_ERROR = -4,
-    API_STRUCT_INIT_ERROR = -5
-};
+// In-process cache of parsed system-info, keyed by URL and auth identity.
+// Fresh entries are served without any I/O. Expired entries are revalidated
+// with If-None-Match / If-Modified-Since, so a 304 skips both the body
+// transfer and the JSON parse.
 
-// Callback for curl with error handling
-struct MemoryStruct {
-    char *memory;
-    size_t size;
-};
+int init_response_cache(struct response_cache *cache, long ttl_ms) {
+    if (!cache) return API_STRUCT_INIT_ERROR;
+    
+    memset(cache, 0, sizeof(struct response_cache));
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->ttl_ms = (ttl_ms > 0) ? ttl_ms : API_CACHE_DEFAULT_TTL_MS;
+    init_timeout_policy(&cache->timeouts);
+    return API_SUCCESS;
+}
 
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
+// FNV-1a over every credential apply_auth_config sends (0 for anonymous).
+// Basic and Bearer may both be set, and then both go on the wire.
+unsigned long long auth_identity_hash(const struct auth_config *auth) {
+    unsigned long long hash = 1469598103934665603ULL;
+    const char *parts[5];
+    int count = 0;
     
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        fprintf(stderr, "realloc failed: %s
-", strerror(errno));
-        return 0;
-    }
+    if (!auth) return 0;
     
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
+    if (auth->use_basic_auth) {
+        parts[count++] = "basic";
+        parts[count++] = auth->username;
+        parts[count++] = auth->password;
+    }
+    if (auth->use_bearer_auth && auth->bearer_token[0]) {
+        parts[count++] = "bearer";
+        parts[count++] = auth->bearer_token;
+    }
+    if (count == 0) return 0;
     
-    return realsize;
+    for (int i = 0; i < count; i++) {
+        for (const unsigned char *p = (const unsigned char *)parts[i]; *p; p++) {
+            hash ^= *p;
+            hash *= 1099511628211ULL;
+        }
+        hash ^= 0xff;  // Separator so "ab"+"c" != "a"+"bc"
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
 }
 
-// Safe initialization of struct
-int init_api_struct(struct os *api_data) {
-    if (!api_data) {
-        fprintf(stderr, "Error: NULL pointer passed to init_api_struct
-");
-        return API_STRUCT_INIT_ERROR;
+// Find the entry for (url, auth_id), or claim an empty / least recently used
+// slot. Caller holds cache->lock.
+static struct cache_entry *cache_slot(struct response_cache *cache, const char *url,
+                                      unsigned long long auth_id, int *existing) {
+    struct cache_entry *victim = NULL;
+    
+    for (int i = 0; i < API_CACHE_SLOTS; i++) {
+        struct cache_entry *e = &cache->entries[i];
+        if (e->valid && e->auth_id == auth_id && strcmp(e->url, url) == 0) {
+            *existing = 1;
+            return e;
+        }
+        if (!victim || (!e->valid && victim->valid) ||
+            (e->valid == victim->valid && e->last_used_us < victim->last_used_us)) {
+            victim = e;
+        }
     }
     
-    api_data->apimodel = 0;
-    api_data->system = 0;
-    api_data->osname[0] = '';
-    return API_SUCCESS;
+    *existing = 0;
+    return victim;
 }
 
-// Collect API data with full error handling
-int collect_api_data(struct os *api_data, const char *api_url) {
-    CURL *curl = NULL;
+// collect_api_data with a TTL cache in front. Same return codes; api_data is
+// only written on API_SUCCESS. The lock is dropped for the transfer, so the
+// entry is looked up again before it is updated.
+int collect_api_data_cached(struct response_cache *cache, struct os *api_data,
+                            const char *api_url, const struct auth_config *auth) {
+    struct response_buffer *chunk = NULL;
+    struct curl_slist *headers = NULL;
+    struct cache_entry snapshot;
+    struct os candidate;
+    long http_status = 0;
+    int existing = 0;
+    int result;
     CURLcode res;
-    struct MemoryStruct chunk = {0};
-    int result = API_SUCCESS;
+    CURL *curl;
     
-    // Validate inputs
-    if (!api_data || !api_url) {
-        fprintf(stderr, "Error: NULL api_data or api_url
-");
+    if (!cache || !api_data || !api_url || strlen(api_url) >= API_POOL_URL_MAX) {
         return API_STRUCT_INIT_ERROR;
     }
     
-    // Initialize memory chunk
-    chunk.memory = malloc(1);
-    if (!chunk.memory) {
-        fprintf(stderr, "Error: Failed to allocate memory for response buffer
-");
+    unsigned long long auth_id = auth_identity_hash(auth);
+    
+    pthread_mutex_lock(&cache->lock);
+    long long now = api_now_us();
+    struct cache_entry *entry = cache_slot(cache, api_url, auth_id, &existing);
+    
+    if (existing && now < entry->expires_us) {
+        cache->hits++;
+        entry->last_used_us = now;
+        memcpy(api_data, &entry->data, sizeof(struct os));
+        pthread_mutex_unlock(&cache->lock);
+        return API_SUCCESS;
+    }
+    
+    cache->misses++;
+    int conditional = existing && (entry->etag[0] || entry->last_modified[0]);
+    if (conditional) {
+        memcpy(&snapshot, entry, sizeof(struct cache_entry));
+        cache->revalidations++;
+    }
+    pthread_mutex_unlock(&cache->lock);
+    
+    request_arena_enter();
+    chunk = acquire_response_buffer();
+    if (!chunk) {
+        request_arena_leave();
         return API_MEM_ERROR;
     }
-    chunk.size = 0;
     
-    // Initialize curl
-    curl = curl_easy_init();
+    curl = pool_acquire_handle(cache->pool, api_url);
     if (!curl) {
-        fprintf(stderr, "Error: curl_easy_init failed
-");
-        free(chunk.memory);
+        release_response_buffer(chunk);
+        request_arena_leave();
         return API_CURL_INIT_ERROR;
     }
     
-    // Configure curl
     curl_easy_setopt(curl, CURLOPT_URL, api_url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
+    attach_response_buffer(curl, chunk);
+    apply_attempt_timeout(curl, cache->endpoints, api_url, &cache->timeouts, 0);
     curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    headers = apply_auth_config(curl, auth);
     
-    // Perform request
-    res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        fprintf(stderr, "Error: curl_easy_perform failed: %s
-", curl_easy_strerror(res));
-        result = API_NETWORK_ERROR;
-        goto cleanup;
-    }
-    
-    // Check if we got any data
-    if (chunk.size == 0) {
-        fprintf(stderr, "Warning: Empty response from API
-");
-    }
-    
-    // Parse JSON response
-    cJSON *json = cJSON_Parse(chunk.memory);
-    if (json == NULL) {
-        const char *error_ptr = cJSON_GetErrorPtr();
-        if (error_ptr) {
-            fprintf(stderr, "Error: JSON parse failed at: %s
-", error_ptr);
-        } else {
-            fprintf(stderr, "Error: JSON parse failed (unknown reason)
-");
+    if (conditional) {
+        char line[160];
+        if (snapshot.etag[0]) {
+            snprintf(line, sizeof(line), "If-None-Match: %s", snapshot.etag);
+            headers = arena_slist_append(headers, line);
         }
-        result = API_JSON_PARSE_ERROR;
-        goto cleanup;
+        if (snapshot.last_modified[0]) {
+            snprintf(line, sizeof(line), "If-Modified-Since: %s", snapshot.last_modified);
+            headers = arena_slist_append(headers, line);
+        }
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
     }
     
-    // Extract data safely
-    cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
-    cJSON *system_json = cJSON_GetObjectItem(json, "system");
-    cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
+    long long started_us = api_now_us();
+    res = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
+    pool_record_transfer(cache->pool, api_url, curl);
+    pool_release_handle(cache->pool, api_url, curl);
+    arena_slist_free(headers);
     
-    if (cJSON_IsNumber(apimodel_json)) {
-        api_data->apimodel = apimodel_json->valueint;
-    } else {
-        fprintf(stderr, "Warning: Invalid or missing apimodel field
-");
-        api_data->apimodel = -1;  // Error value
+    now = api_now_us();
+    if (res == CURLE_OPERATION_TIMEDOUT) {
+        record_endpoint_timeout(cache->endpoints, api_url, now - started_us);
+    } else if (res == CURLE_OK && (http_status == 200 || http_status == 304)) {
+        record_endpoint_latency(cache->endpoints, api_url, now - started_us);
     }
-    
-    if (cJSON_IsNumber(system_json)) {
-        api_data->system = system_json->valueint;
+    if (res != CURLE_OK) {
+        fprintf(stderr, "CACHE: %s failed: %s\n", api_url, curl_easy_strerror(res));
+        result = API_NETWORK_ERROR;
+    } else if (http_status == 304 && conditional) {
+        // Unchanged: no body, no parse
+        pthread_mutex_lock(&cache->lock);
+        cache->not_modified++;
+        entry = cache_slot(cache, api_url, auth_id, &existing);
+        if (existing) {
+            entry->expires_us = now + cache->ttl_ms * 1000LL;
+            entry->last_used_us = now;
+        }
+        memcpy(api_data, &snapshot.data, sizeof(struct os));
+        pthread_mutex_unlock(&cache->lock);
+        result = API_SUCCESS;
+    } else if (http_status == 401) {
+        result = API_AUTH_ERROR;
+    } else if (http_status != 200 || chunk->size == 0) {
+        fprintf(stderr, "CACHE: %s returned HTTP %ld\n", api_url, http_status);
+        result = API_NETWORK_ERROR;
     } else {
-        fprintf(stderr, "Warning: Invalid or missing system field
-");
-        api_data->system = -1;
+        memcpy(&candidate, api_data, sizeof(struct os));
+        result = parse_system_info(&candidate, chunk->data);
+        if (result == API_SUCCESS) {
+            memcpy(api_data, &candidate, sizeof(struct os));
+            
+            pthread_mutex_lock(&cache->lock);
+            cache->refreshes++;
+            entry = cache_slot(cache, api_url, auth_id, &existing);
+            strcpy(entry->url, api_url);
+            entry->auth_id = auth_id;
+            memcpy(&entry->data, &candidate, sizeof(struct os));
+            strcpy(entry->etag, chunk->etag);
+            strcpy(entry->last_modified, chunk->last_modified);
+            entry->expires_us = now + cache->ttl_ms * 1000LL;
+            entry->last_used_us = now;
+            entry->valid = 1;
+            pthread_mutex_unlock(&cache->lock);
+        }
     }
     
-    if (cJSON_IsString(osname_json) && osname_json->valuestring) {
-        strncpy(api_data->osname, osname_json->valuestring, sizeof(api_data->osname) - 1);
-        api_data->osname[sizeof(api_data->osname) - 1] = '';
-    } else {
-        fprintf(stderr, "Warning: Invalid or missing osname field
-");
-        strcpy(api_data->osname, "Unknown");
+    release_response_buffer(chunk);
+    request_arena_leave();
+    return result;
+}
+
+// Forget every entry (e.g. after credentials change)
+void invalidate_response_cache(struct response_cache *cache) {
+    if (!cache) return;
+    pthread_mutex_lock(&cache->lock);
+    for (int i = 0; i < API_CACHE_SLOTS; i++) {
+        cache->entries[i].valid = 0;
     }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void print_cache_stats(const struct response_cache *cache) {
+    if (!cache) return;
     
-cleanup:
-    if (json) cJSON_Delete(json);
-    curl_easy_cleanup(curl);
-    free(chunk.memory);
-    return result;
+    unsigned long lookups = cache->hits + cache->misses;
+    printf("=== RESPONSE CACHE ===\n");
+    printf("TTL: %ldms | hits=%lu misses=%lu (%.1f%% hit rate)\n", cache->ttl_ms,
+           cache->hits, cache->misses, lookups ? (100.0 * cache->hits) / lookups : 0.0);
+    printf("Revalidations: %lu sent, %lu not modified | Full refreshes: %lu\n",
+           cache->revalidations, cache->not_modified, cache->refreshes);
+    printf("======================\n");
 }
 
-// Print results with status
-void print_api_data(const struct os *api_data, int status) {
-    printf("=== API Data Collection Results ===
-");
-    printf("Status: ");
+// ---- Collection engine ----
+
+// One task, start to finish, on a worker. The recovery context lives on this
+// stack frame, so tasks never share retry state; connections come from the
+// worker's own pool.
+static void run_collect_task(struct collect_engine_worker *worker, struct collect_task *task) {
+    struct collect_engine *engine = worker->engine;
+    struct recovery_ctx ctx;
     
-    switch (status) {
-        case API_SUCCESS:
-            printf("SUCCESS
-");
-            break;
-        case API_MEM_ERROR:
-            printf("MEMORY ALLOCATION FAILED
-");
-            break;
-        case API_CURL_INIT_ERROR:
-            printf("CURL INITIALIZATION FAILED
-");
-            break;
-        case API_NETWORK_ERROR:
-            printf("NETWORK/CURL REQUEST FAILED
-");
-            break;
-        case API_JSON_PARSE_ERROR:
-            printf("JSON PARSING FAILED
-");
-            break;
-        case API_STRUCT_INIT_ERROR:
-            printf("STRUCT INITIALIZATION FAILED
-");
+    task->queued_us = api_now_us() - task->submitted_us;
+    init_recovery_ctx(&ctx, &engine->backup_data);
+    ctx.max_retries = engine->max_retries;
+    ctx.pool = &worker->pool;
+    ctx.endpoints = &engine->endpoints;
+    memcpy(&ctx.timeouts, &engine->timeouts, sizeof(struct timeout_policy));
+    
+    memcpy(&task->data, &engine->backup_data, sizeof(struct os));
+    task->status = collect_api_data_with_recovery(&task->data, task->url, &ctx, task->auth);
+    task->retries = ctx.retry_count;
+    task->latency_us = api_now_us() - task->submitted_us;
+}
+
+static void *engine_worker(void *arg) {
+    struct collect_engine_worker *worker = (struct collect_engine_worker *)arg;
+    struct collect_engine *engine = worker->engine;
+    
+    pthread_mutex_lock(&engine->lock);
+    for (;;) {
+        while (!engine->head && !engine->stopping) {
+            pthread_cond_wait(&engine->work_ready, &engine->lock);
+        }
+        if (!engine->head) break;  // Stopping and drained
+        
+        struct collect_task *task = engine->head;
+        engine->head = task->next;
+        if (!engine->head) engine->tail = NULL;
+        engine->queued--;
+        engine->running++;
+        pthread_mutex_unlock(&engine->lock);
+        
+        run_collect_task(worker, task);
+        int status = task->status;
+        if (task->on_done) task->on_done(task);  // Task may be gone after this
+        
+        pthread_mutex_lock(&engine->lock);
+        engine->running--;
+        engine->completed++;
+        if (status == API_SUCCESS) {
+            engine->succeeded++;
+        } else if (status == API_RECOVERY_SUCCESS) {
+            engine->recovered++;
+        } else {
+            engine->failed++;
+        }
+        if (!engine->head && engine->running == 0) {
+            pthread_cond_broadcast(&engine->all_done);
+        }
+    }
+    pthread_mutex_unlock(&engine->lock);
+    return NULL;
+}
+
+// workers <= 0 means one per online CPU (capped at API_ENGINE_MAX_WORKERS)
+int start_collect_engine(struct collect_engine *engine, int workers, const struct os *backup) {
+    if (!engine || !backup) return API_STRUCT_INIT_ERROR;
+    
+    if (workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (cpus > 0) ? (int)cpus : 1;
+    }
+    if (workers > API_ENGINE_MAX_WORKERS) workers = API_ENGINE_MAX_WORKERS;
+    
+    memset(engine, 0, sizeof(struct collect_engine));
+    memcpy(&engine->backup_data, backup, sizeof(struct os));
+    engine->max_retries = 3;
+    init_timeout_policy(&engine->timeouts);
+    
+    init_endpoint_registry(&engine->endpoints);
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->work_ready, NULL);
+    pthread_cond_init(&engine->all_done, NULL);
+    
+    for (int i = 0; i < workers; i++) {
+        struct collect_engine_worker *worker = &engine->workers[i];
+        worker->engine = engine;
+        if (init_handle_pool(&worker->pool) != API_SUCCESS ||
+            pthread_create(&worker->thread, NULL, engine_worker, worker) != 0) {
+            destroy_handle_pool(&worker->pool);
             break;
-        default:
-            printf("UNKNOWN ERROR (%d)
-", status);
+        }
+        engine->worker_count++;
+    }
+    if (engine->worker_count == 0) {
+        stop_collect_engine(engine);
+        return API_STRUCT_INIT_ERROR;
     }
     
-    printf("API Model: %d
-", api_data->apimodel);
-    printf("System ID: %d
-", api_data->system);
-    printf("OS Name: %s
-", api_data->osname);
-    printf("==============================
-");
+    return API_SUCCESS;
 }
 
-int main() {
-    struct os api_data;
-    int status;
-    const char *internal_api = "http://localhost:8080/api/system-info";
+// Queue count tasks in one go (a contiguous array, e.g. one per device)
+int collect_engine_submit_batch(struct collect_engine *engine, struct collect_task *tasks, int count) {
+    if (!engine || !tasks || count <= 0) return API_STRUCT_INIT_ERROR;
     
-    // Initialize curl globally
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    long long now = api_now_us();
+    for (int i = 0; i < count; i++) {
+        tasks[i].status = API_SUCCESS;
+        tasks[i].retries = 0;
+        tasks[i].submitted_us = now;
+        tasks[i].next = (i + 1 < count) ? &tasks[i + 1] : NULL;
+    }
     
-    // Initialize struct
-    status = init_api_struct(&api_data);
-    if (status != API_SUCCESS) {
-        fprintf(stderr, "Failed to initialize API struct
-");
-        curl_global_cleanup();
-        return 1;
+    pthread_mutex_lock(&engine->lock);
+    if (engine->stopping) {
+        pthread_mutex_unlock(&engine->lock);
+        return API_STRUCT_INIT_ERROR;
+    }
+    if (engine->tail) {
+        engine->tail->next = &tasks[0];
+    } else {
+        engine->head = &tasks[0];
     }
+    engine->tail = &tasks[count - 1];
+    engine->queued += count;
+    engine->submitted += (unsigned long)count;
+    if (count == 1) {
+        pthread_cond_signal(&engine->work_ready);
+    } else {
+        pthread_cond_broadcast(&engine->work_ready);
+    }
+    pthread_mutex_unlock(&engine->lock);
+    return API_SUCCESS;
+}
+
+int collect_engine_submit(struct collect_engine *engine, struct collect_task *task) {
+    return collect_engine_submit_batch(engine, task, 1);
+}
+
+// Block until every task submitted so far has finished
+void collect_engine_wait(struct collect_engine *engine) {
+    if (!engine) return;
     
-    // Try to collect data
-    printf("Attempting to collect data from: %s
-", internal_api);
-    status = collect_api_data(&api_data, internal_api);
+    pthread_mutex_lock(&engine->lock);
+    while (engine->head || engine->running > 0) {
+        pthread_cond_wait(&engine->all_done, &engine->lock);
+    }
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// Finishes the queued tasks, then joins the workers and frees their pools
+void stop_collect_engine(struct collect_engine *engine) {
+    if (!engine) return;
     
-    // Always print results (even on error)
-    print_api_data(&api_data, status);
+    pthread_mutex_lock(&engine->lock);
+    engine->stopping = 1;
+    pthread_cond_broadcast(&engine->work_ready);
+    pthread_mutex_unlock(&engine->lock);
     
-    // Apply fallback values only if critical fields are invalid
-    if (status != API_SUCCESS || api_data.apimodel == -1 || api_data.system == -1) {
-        printf("Applying fallback values...
-");
-        api_data.apimodel = 1;
-        api_data.system = 1;
-        strcpy(api_data.osname, "Lumen");
+    for (int i = 0; i < engine->worker_count; i++) {
+        pthread_join(engine->workers[i].thread, NULL);
+        destroy_handle_pool(&engine->workers[i].pool);
     }
+    engine->worker_count = 0;
     
-    curl_global_cleanup();
-    return (status == API_SUCCESS) ? 0 : 1;
+    pthread_cond_destroy(&engine->work_ready);
+    pthread_cond_destroy(&engine->all_done);
+    pthread_mutex_destroy(&engine->lock);
 }
 
-// ---- Recovery ----
+void print_engine_stats(struct collect_engine *engine) {
+    if (!engine) return;
+    
+    pthread_mutex_lock(&engine->lock);
+    printf("=== COLLECTION ENGINE ===\n");
+    printf("Workers: %d | Queued: %d | Running: %d\n", engine->worker_count, engine->queued, engine->running);
+    printf("Submitted: %lu | Completed: %lu (ok=%lu recovered=%lu failed=%lu)\n",
+           engine->submitted, engine->completed, engine->succeeded, engine->recovered, engine->failed);
+    printf("=========================\n");
+    pthread_mutex_unlock(&engine->lock);
+}
 
-// API Module struct
-struct os {
-    int apimodel;
-    int system;
-    char osname[100];
-};
+// ---- Mock server ----
+// Thread-per-connection HTTP/1.1 server with keep-alive. Workers share a
+// non-blocking listen socket and poll it, so stop needs no wakeup trick.
 
-// Enhanced error codes with recovery states
-enum API_ERROR {
-    API_SUCCESS = 0,
-    API_MEM_ERROR = -1,
-    API_CURL_INIT_ERROR = -2,
-    API_NETWORK_ERROR = -3,
-    API_JSON_PARSE_ERROR = -4,
-    API_STRUCT_INIT_ERROR = -5,
-    API_RECOVERY_SUCCESS = 10,  // Recovery completed
-    API_MAX_RETRIES = -99       // Max retries exceeded
-};
+#define MOCK_REQUEST_MAX 8192
+#define MOCK_POLL_MS 50
+#define MOCK_IDLE_MS 5000
 
-// Recovery context
-struct recovery_ctx {
-    jmp_buf env;
-    int retry_count;
-    int max_retries;
-    struct os backup_data;
-    int recovery_active;
+struct mock_server {
+    struct mock_server_config config;
+    struct mock_faults faults;      // Live copy, replaced by set_mock_faults
+    pthread_mutex_t lock;           // Guards faults
+    char body[MOCK_BODY_MAX];
+    size_t body_len;
+    char etag[24];
+    char basic_token[180];          // base64("user:pass")
+    char url[64];
+    unsigned short port;
+    int listen_fd;
+    atomic_int running;
+    pthread_t threads[MOCK_MAX_WORKERS];
+    int thread_count;
+    atomic_ulong connections;
+    atomic_ulong requests;
+    atomic_ulong ok;
+    atomic_ulong not_modified;
+    atomic_ulong unauthorized;
+    atomic_ulong server_errors;
+    atomic_ulong truncated;
+    atomic_ulong dropped;
+    atomic_ulong not_found;
 };
 
-// Callback for curl (unchanged)
-struct MemoryStruct {
-    char *memory;
-    size_t size;
-};
+void init_mock_server_config(struct mock_server_config *cfg) {
+    if (!cfg) return;
+    
+    memset(cfg, 0, sizeof(struct mock_server_config));
+    cfg->port = 8080;
+    cfg->workers = 4;
+    cfg->info.apimodel = 1;
+    cfg->info.system = 1;
+    strncpy(cfg->info.osname, "Lumen OS", sizeof(cfg->info.osname) - 1);
+}
 
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
+static void mock_base64(char *out, size_t out_size, const char *in) {
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t len = strlen(in);
+    size_t o = 0;
     
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        fprintf(stderr, "RECV: Memory reallocation failed
-");
-        return 0;
+    for (size_t i = 0; i < len && o + 4 < out_size; i += 3) {
+        unsigned int v = (unsigned char)in[i] << 16;
+        if (i + 1 < len) v |= (unsigned char)in[i + 1] << 8;
+        if (i + 2 < len) v |= (unsigned char)in[i + 2];
+        out[o++] = digits[(v >> 18) & 63];
+        out[o++] = digits[(v >> 12) & 63];
+        out[o++] = (i + 1 < len) ? digits[(v >> 6) & 63] : '=';
+        out[o++] = (i + 2 < len) ? digits[v & 63] : '=';
     }
-    
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
-    
-    return realsize;
+    out[o] = '\0';
 }
 
-// Initialize recovery context with backup data
-int init_recovery_ctx(struct recovery_ctx *ctx, struct os *backup) {
-    if (!ctx || !backup) return API_STRUCT_INIT_ERROR;
-    
-    ctx->retry_count = 0;
-    ctx->max_retries = 3;
-    ctx->recovery_active = 0;
+// Copy the value of a request header into out. Returns 0 if it is absent.
+static int mock_header(const char *head, const char *name, char *out, size_t out_size) {
+    size_t name_len = strlen(name);
+    const char *line = strstr(head, "\r\n");
     
-    // Store backup data
-    memcpy(&ctx->backup_data, backup, sizeof(struct os));
-    
-    if (setjmp(ctx->env) == 0) {
-        return API_SUCCESS;
+    while (line && line[2] != '\r') {
+        line += 2;
+        const char *eol = strstr(line, "\r\n");
+        if (!eol) return 0;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            const char *value = line + name_len + 1;
+            while (*value == ' ' || *value == '\t') value++;
+            const char *end = eol;
+            while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+            size_t len = (size_t)(end - value);
+            if (len >= out_size) len = out_size - 1;
+            memcpy(out, value, len);
+            out[len] = '\0';
+            return 1;
+        }
+        line = eol;
     }
-    return API_RECOVERY_SUCCESS;  // Returning from longjmp
+    return 0;
 }
 
-// Safe struct initialization with recovery backup
-int init_api_struct(struct os *api_data, struct os *backup) {
-    if (!api_data || !backup) {
-        fprintf(stderr, "RECOV: NULL pointer in init_api_struct
-");
-        return API_STRUCT_INIT_ERROR;
-    }
+static int mock_auth_ok(const struct mock_server *srv, const char *authorization) {
+    const struct auth_config *auth = &srv->config.auth;
     
-    // Initialize with backup values first
-    memcpy(api_data, backup, sizeof(struct os));
+    if (!auth->use_basic_auth && !auth->use_bearer_auth) return 1;
+    if (!authorization) return 0;
     
-    return API_SUCCESS;
+    if (auth->use_basic_auth && strncasecmp(authorization, "Basic ", 6) == 0) {
+        return strcmp(authorization + 6, srv->basic_token) == 0;
+    }
+    if (auth->use_bearer_auth && strncasecmp(authorization, "Bearer ", 7) == 0) {
+        return strcmp(authorization + 7, auth->bearer_token) == 0;
+    }
+    return 0;
 }
 
-// RETRY WITH BACKOFF: Core recovery mechanism
-int collect_api_data_with_recovery(struct os *api_data, const char *api_url, struct recovery_ctx *ctx) {
-    CURL *curl = NULL;
-    CURLcode res;
-    struct MemoryStruct chunk = {0};
-    const char *backup_urls[] = {
-        "http://localhost:8080/api/system-info",
-        "http://127.0.0.1:8080/api/system-info",
-        "http://localhost:3000/api/system",
-        NULL
-    };
-    
-    // Check if already in recovery mode
-    if (ctx->recovery_active) {
-        longjmp(ctx->env, API_RECOVERY_SUCCESS);
-    }
-    
-    for (int url_idx = 0; backup_urls[url_idx]; url_idx++) {
-        ctx->retry_count = 0;
-        
-        while (ctx->retry_count < ctx->max_retries) {
-            // Initialize for this attempt
-            chunk.memory = malloc(1);
-            if (!chunk.memory) {
-                fprintf(stderr, "RECOV: Alloc failed, using backup
-");
-                memcpy(api_data, &ctx->backup_data, sizeof(struct os));
-                return API_RECOVERY_SUCCESS;
-            }
-            chunk.size = 0;
-            
-            curl = curl_easy_init();
-            if (!curl) {
-                ctx->retry_count++;
-                free(chunk.memory);
-                if (ctx->retry_count >= ctx->max_retries) {
-                    fprintf(stderr, "RECOV: Curl init failed after %d retries
-", ctx->retry_count);
-                    goto use_backup;
-                }
-                sleep(1 << ctx->retry_count);  // Exponential backoff
-                continue;
-            }
-            
-            // Configure with increasing timeout
-            curl_easy_setopt(curl, CURLOPT_URL, backup_urls[url_idx]);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L + (2L * ctx->retry_count));
-            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 3L + ctx->retry_count);
-            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            
-            // Enter recovery mode for this request
-            ctx->recovery_active = 1;
-            res = curl_easy_perform(curl);
-            ctx->recovery_active = 0;
-            
-            curl_easy_cleanup(curl);
-            free(chunk.memory);
-            
-            if (res == CURLE_OK && chunk.size > 0) {
-                // Try JSON parse (simplified for brevity)
-                cJSON *json = cJSON_Parse(chunk.memory ? chunk.memory : "{}");
-                if (json) {
-                    // Extract data safely (same as before)
-                    cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
-                    cJSON *system_json = cJSON_GetObjectItem(json, "system");
-                    cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
-                    
-                    if (cJSON_IsNumber(apimodel_json)) api_data->apimodel = apimodel_json->valueint;
-                    if (cJSON_IsNumber(system_json)) api_data->system = system_json->valueint;
-                    if (cJSON_IsString(osname_json)) strncpy(api_data->osname, osname_json->valuestring, 99);
-                    
-                    cJSON_Delete(json);
-                    return API_SUCCESS;  // SUCCESS!
-                }
-            }
-            
-            ctx->retry_count++;
-            fprintf(stderr, "RECOV: Attempt %d/%d failed for %s, backoff %ds
-", 
-                   ctx->retry_count, ctx->max_retries, backup_urls[url_idx], 1 << ctx->retry_count);
-            
-            if (ctx->retry_count >= ctx->max_retries) {
-                fprintf(stderr, "RECOV: All retries failed for %s
-", backup_urls[url_idx]);
-            }
-            
-            sleep(1 << (ctx->retry_count - 1));  // Backoff before next URL
-        }
+static int mock_send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        len -= (size_t)n;
     }
-    
-use_backup:
-    // Final recovery: restore backup data
-    fprintf(stderr, "RECOV: All endpoints failed, restoring backup data
-");
-    memcpy(api_data, &ctx->backup_data, sizeof(struct os));
-    return API_RECOVERY_SUCCESS;
+    return 0;
 }
 
-void print_recovery_status(struct os *data, int status, struct recovery_ctx *ctx) {
-    printf("
-=== RECOVERY REPORT ===
-");
-    printf("Final Status: ");
-    
-    switch (status) {
-        case API_SUCCESS: printf("FULL SUCCESS
-"); break;
-        case API_RECOVERY_SUCCESS: printf("RECOVERY SUCCESS (using backup/fallback)
-"); break;
-        default: printf("HARD FAILURE (code: %d)
-", status);
-    }
-    
-    printf("Retries Used: %d/%d
-", ctx->retry_count, ctx->max_retries);
-    printf("API Model: %d | System: %d | OS: %s
-", 
-           data->apimodel, data->system, data->osname);
-    printf("==================
+// Status line, headers and (unless head_only) body in one write
+static int mock_respond(int fd, int status, const char *reason, const char *extra_headers,
+                        const char *body, size_t body_len, int head_only, int keep_alive) {
+    char head[512];
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 %d %s\r\n"
+                     "Content-Type: application/json\r\n"
+                     "Content-Length: %zu\r\n"
+                     "Connection: %s\r\n"
+                     "%s\r\n",
+                     status, reason, body_len, keep_alive ? "keep-alive" : "close",
+                     extra_headers ? extra_headers : "");
+    if (n < 0 || (size_t)n >= sizeof(head)) return -1;
+    if (mock_send_all(fd, head, (size_t)n) != 0) return -1;
+    if (head_only || body_len == 0) return 0;
+    return mock_send_all(fd, body, body_len);
+}
 
-");
+static int mock_roll(unsigned int *seed, int pct) {
+    return pct > 0 && (int)(rand_r(seed) % 100) < pct;
 }
 
-int main() {
-    struct os api_data, backup_data;
-    struct recovery_ctx ctx;
+// Answer one request. Returns 1 to keep the connection, 0 to close it.
+static int mock_handle_request(struct mock_server *srv, int fd, const char *head, unsigned int *seed) {
+    struct mock_faults faults;
+    char method[8] = "";
+    char path[256] = "";
+    char version[16] = "";
     
-    // Setup fallback data
-    backup_data.apimodel = 1;
-    backup_data.system = 1;
-    strcpy(backup_data.osname, "Lumen");
+    atomic_fetch_add(&srv->requests, 1);
+    pthread_mutex_lock(&srv->lock);
+    faults = srv->faults;
+    pthread_mutex_unlock(&srv->lock);
     
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    if (sscanf(head, "%7s %255s %15s", method, path, version) != 3) {
+        mock_respond(fd, 400, "Bad Request", NULL, "{\"error\":\"bad request\"}", 23, 0, 0);
+        return 0;
+    }
     
-    // Initialize recovery system FIRST
-    if (init_recovery_ctx(&ctx, &backup_data) != API_SUCCESS) {
-        fprintf(stderr, "CRITICAL: Recovery init failed
-");
-        curl_global_cleanup();
-        return 1;
+    char connection[32];
+    char authorization[320];
+    char if_none_match[128];
+    int has_auth = mock_header(head, "Authorization", authorization, sizeof(authorization));
+    int has_etag = mock_header(head, "If-None-Match", if_none_match, sizeof(if_none_match));
+    int keep_alive = strcmp(version, "HTTP/1.0") != 0;  // HTTP/1.1 defaults to keep-alive
+    if (mock_header(head, "Connection", connection, sizeof(connection))) {
+        if (strcasecmp(connection, "close") == 0) keep_alive = 0;
+        if (strcasecmp(connection, "keep-alive") == 0) keep_alive = 1;
     }
+    int head_only = strcmp(method, "HEAD") == 0;
     
-    // Initialize main data from backup
-    init_api_struct(&api_data, &backup_data);
+    long delay_ms = faults.latency_ms;
+    if (faults.jitter_ms > 0) delay_ms += (long)(rand_r(seed) % (unsigned int)(faults.jitter_ms + 1));
+    if (delay_ms > 0) usleep((useconds_t)delay_ms * 1000);
     
-    printf("🚀 Starting API collection with recovery...
-");
-    int status = collect_api_data_with_recovery(&api_data, "http://localhost:8080/api/system-info", &ctx);
+    if (mock_roll(seed, faults.drop_pct)) {
+        atomic_fetch_add(&srv->dropped, 1);
+        return 0;
+    }
     
-    print_recovery_status(&api_data, status, &ctx);
+    char *query = strchr(path, '?');
+    if (query) *query = '\0';
+    if (strcmp(path, "/api/system-info") != 0 && strcmp(path, "/api/system") != 0) {
+        atomic_fetch_add(&srv->not_found, 1);
+        return mock_respond(fd, 404, "Not Found", NULL, "{\"error\":\"not found\"}", 21,
+                            head_only, keep_alive) == 0 && keep_alive;
+    }
+    if (!head_only && strcmp(method, "GET") != 0) {
+        return mock_respond(fd, 405, "Method Not Allowed", "Allow: GET, HEAD\r\n",
+                            "{\"error\":\"method not allowed\"}", 30, 0, keep_alive) == 0 && keep_alive;
+    }
     
-    curl_global_cleanup();
-    return (status == API_SUCCESS) ? 0 : 1;
-}
-
-// Auth
-
-// API Module struct
-struct os {
-    int apimodel;
-    int system;
-    char osname[100];
-};
-
-// Enhanced error codes
-enum API_ERROR {
-    API_SUCCESS = 0,
-    API_MEM_ERROR = -1,
-    API_CURL_INIT_ERROR = -2,
-    API_NETWORK_ERROR = -3,
-    API_JSON_PARSE_ERROR = -4,
-    API_AUTH_ERROR = -6,      // NEW: Authentication failure
-    API_STRUCT_INIT_ERROR = -5,
-    API_RECOVERY_SUCCESS = 10,
-    API_MAX_RETRIES = -99
-};
-
-// Auth credentials structure
-struct auth_config {
-    char username[64];
-    char password[64];
-    char bearer_token[256];
-    int use_basic_auth;
-    int use_bearer_auth;
-};
-
-// Recovery context (unchanged)
-struct recovery_ctx {
-    jmp_buf env;
-    int retry_count;
-    int max_retries;
-    struct os backup_data;
-    int recovery_active;
-};
-
-// Memory callback (unchanged)
-struct MemoryStruct {
-    char *memory;
-    size_t size;
-};
-
-static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
+    if (mock_roll(seed, faults.unauthorized_pct) || !mock_auth_ok(srv, has_auth ? authorization : NULL)) {
+        const char *challenge = srv->config.auth.use_bearer_auth
+            ? "WWW-Authenticate: Bearer realm=\"Lumen\"\r\n"
+            : "WWW-Authenticate: Basic realm=\"Lumen\"\r\n";
+        atomic_fetch_add(&srv->unauthorized, 1);
+        return mock_respond(fd, 401, "Unauthorized", challenge, "{\"error\":\"unauthorized\"}", 24,
+                            head_only, keep_alive) == 0 && keep_alive;
+    }
     
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        fprintf(stderr, "AUTH: Memory reallocation failed
-");
-        return 0;
+    if (mock_roll(seed, faults.server_error_pct)) {
+        static const int codes[] = { 500, 502, 503 };
+        static const char *reasons[] = { "Internal Server Error", "Bad Gateway", "Service Unavailable" };
+        int pick = (int)(rand_r(seed) % 3);
+        atomic_fetch_add(&srv->server_errors, 1);
+        return mock_respond(fd, codes[pick], reasons[pick], NULL, "{\"error\":\"server error\"}", 24,
+                            head_only, keep_alive) == 0 && keep_alive;
     }
     
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
+    char extra[64];
+    snprintf(extra, sizeof(extra), "ETag: %s\r\n", srv->etag);
     
-    return realsize;
-}
-
-// NEW: Initialize authentication config
-int init_auth_config(struct auth_config *auth, const char *username, const char *password) {
-    if (!auth || !username) {
-        fprintf(stderr, "AUTH: Invalid auth config parameters
-");
-        return API_STRUCT_INIT_ERROR;
+    if (has_etag && strcmp(if_none_match, srv->etag) == 0) {
+        atomic_fetch_add(&srv->not_modified, 1);
+        return mock_respond(fd, 304, "Not Modified", extra, NULL, 0, 1, keep_alive) == 0 && keep_alive;
     }
     
-    memset(auth, 0, sizeof(struct auth_config));
-    strncpy(auth->username, username, sizeof(auth->username) - 1);
-    if (password) {
-        strncpy(auth->password, password, sizeof(auth->password) - 1);
+    if (mock_roll(seed, faults.truncate_pct)) {
+        char head_out[256];
+        int n = snprintf(head_out, sizeof(head_out),
+                         "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                         "Content-Length: %zu\r\nConnection: close\r\n%s\r\n",
+                         srv->body_len, extra);
+        atomic_fetch_add(&srv->truncated, 1);
+        if (mock_send_all(fd, head_out, (size_t)n) == 0 && !head_only) {
+            mock_send_all(fd, srv->body, srv->body_len / 2);
+        }
+        return 0;
     }
     
-    auth->use_basic_auth = 1;  // Default to Basic Auth
-    return API_SUCCESS;
+    atomic_fetch_add(&srv->ok, 1);
+    return mock_respond(fd, 200, "OK", extra, srv->body, srv->body_len, head_only, keep_alive) == 0 &&
+           keep_alive;
 }
 
-// NEW: Initialize Bearer token auth
-int set_bearer_token(struct auth_config *auth, const char *token) {
-    if (!auth || !token) return API_STRUCT_INIT_ERROR;
+// Serve requests on one connection until it closes, idles out or the server stops
+static void mock_serve_connection(struct mock_server *srv, int fd, unsigned int *seed) {
+    char req[MOCK_REQUEST_MAX + 1];
+    size_t len = 0;
+    int idle_ms = 0;
     
-    strncpy(auth->bearer_token, token, sizeof(auth->bearer_token) - 1);
-    auth->use_bearer_auth = 1;
-    auth->use_basic_auth = 0;  // Disable basic auth
-    return API_SUCCESS;
+    while (atomic_load(&srv->running)) {
+        char *end = NULL;
+        if (len >= 4) {
+            req[len] = '\0';
+            end = strstr(req, "\r\n\r\n");
+        }
+        
+        if (!end) {
+            if (len == MOCK_REQUEST_MAX) return;  // Oversized request head
+            
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, MOCK_POLL_MS);
+            if (ready < 0 && errno != EINTR) return;
+            if (ready <= 0) {
+                idle_ms += MOCK_POLL_MS;
+                if (idle_ms >= MOCK_IDLE_MS) return;
+                continue;
+            }
+            
+            ssize_t n = recv(fd, req + len, MOCK_REQUEST_MAX - len, 0);
+            if (n <= 0) return;
+            len += (size_t)n;
+            idle_ms = 0;
+            continue;
+        }
+        
+        // Request bodies are not expected (GET/HEAD), anything after the head is the next request
+        size_t head_len = (size_t)(end - req) + 4;
+        char next = req[head_len];
+        req[head_len] = '\0';
+        int keep = mock_handle_request(srv, fd, req, seed);
+        req[head_len] = next;
+        
+        memmove(req, req + head_len, len - head_len);
+        len -= head_len;
+        if (!keep) return;
+    }
 }
 
-// Recovery init (unchanged)
-int init_recovery_ctx(struct recovery_ctx *ctx, struct os *backup) {
-    if (!ctx || !backup) return API_STRUCT_INIT_ERROR;
-    
-    ctx->retry_count = 0;
-    ctx->max_retries = 3;
-    ctx->recovery_active = 0;
-    memcpy(&ctx->backup_data, backup, sizeof(struct os));
+static void *mock_worker(void *arg) {
+    struct mock_server *srv = (struct mock_server *)arg;
+    unsigned int seed = (unsigned int)api_now_us() ^ (unsigned int)(uintptr_t)&seed;
     
-    if (setjmp(ctx->env) == 0) {
-        return API_SUCCESS;
+    while (atomic_load(&srv->running)) {
+        struct pollfd pfd = { srv->listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, MOCK_POLL_MS) <= 0) continue;
+        
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) continue;  // Another worker won the race
+        
+        // Accepted sockets inherit O_NONBLOCK on some systems; the connection loop polls anyway
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags >= 0) fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        
+        atomic_fetch_add(&srv->connections, 1);
+        mock_serve_connection(srv, fd, &seed);
+        close(fd);
     }
-    return API_RECOVERY_SUCCESS;
-}
-
-int init_api_struct(struct os *api_data, struct os *backup) {
-    if (!api_data || !backup) return API_STRUCT_INIT_ERROR;
-    memcpy(api_data, backup, sizeof(struct os));
-    return API_SUCCESS;
+    return NULL;
 }
 
-// ENHANCED: API collection with FULL AUTH SUPPORT
-int collect_api_data_with_recovery(struct os *api_data, const char *api_url, 
-                                  struct recovery_ctx *ctx, struct auth_config *auth) {
-    CURL *curl = NULL;
-    CURLcode res;
-    struct MemoryStruct chunk = {0};
-    long http_status = 0;
+// Bind 127.0.0.1:cfg->port and start the workers. NULL if the port is taken.
+struct mock_server *start_mock_server(const struct mock_server_config *cfg) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
     
-    const char *backup_urls[] = {
-        "http://localhost:8080/api/system-info",
-        "http://127.0.0.1:8080/api/system-info",
-        "http://localhost:3000/api/system",
-        NULL
-    };
+    if (!cfg) return NULL;
     
-    if (ctx->recovery_active) {
-        longjmp(ctx->env, API_RECOVERY_SUCCESS);
+    struct mock_server *srv = (struct mock_server *)calloc(1, sizeof(struct mock_server));
+    if (!srv) return NULL;
+    
+    srv->config = *cfg;
+    srv->config.body = NULL;  // Copied below, the caller's string need not outlive us
+    if (srv->config.workers < 1) srv->config.workers = 1;
+    if (srv->config.workers > MOCK_MAX_WORKERS) srv->config.workers = MOCK_MAX_WORKERS;
+    srv->faults = cfg->faults;
+    
+    if (cfg->body) {
+        strncpy(srv->body, cfg->body, sizeof(srv->body) - 1);
+    } else {
+        snprintf(srv->body, sizeof(srv->body), "{\"apimodel\":%d,\"system\":%d,\"osname\":\"%s\"}",
+                 cfg->info.apimodel, cfg->info.system, cfg->info.osname);
     }
+    srv->body_len = strlen(srv->body);
     
-    for (int url_idx = 0; backup_urls[url_idx]; url_idx++) {
-        ctx->retry_count = 0;
-        
-        while (ctx->retry_count < ctx->max_retries) {
-            // Allocate memory
-            chunk.memory = malloc(1);
-            if (!chunk.memory) {
-                memcpy(api_data, &ctx->backup_data, sizeof(struct os));
-                return API_RECOVERY_SUCCESS;
-            }
-            chunk.size = 0;
-            
-            curl = curl_easy_init();
-            if (!curl) {
-                ctx->retry_count++;
-                free(chunk.memory);
-                if (ctx->retry_count >= ctx->max_retries) goto use_backup;
-                sleep(1 << ctx->retry_count);
-                continue;
-            }
-            
-            // CORE CURL SETUP
-            curl_easy_setopt(curl, CURLOPT_URL, backup_urls[url_idx]);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L + (2L * ctx->retry_count));
-            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
-            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
-            
-            // *** AUTHENTICATION SETUP ***
-            if (auth->use_basic_auth) {
-                char credentials[128];
-                snprintf(credentials, sizeof(credentials), "%s:%s", 
-                        auth->username, auth->password[0] ? auth->password : "");
-                curl_easy_setopt(curl, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
-                curl_easy_setopt(curl, CURLOPT_USERNAME, auth->username);
-                curl_easy_setopt(curl, CURLOPT_PASSWORD, auth->password);
-                printf("🔐 Using Basic Auth: %s:***
-", auth->username);
-            }
-            
-            if (auth->use_bearer_auth && strlen(auth->bearer_token) > 0) {
-                struct curl_slist *headers = NULL;
-                char auth_header[300];
-                snprintf(auth_header, sizeof(auth_header), 
-                        "Authorization: Bearer %s", auth->bearer_token);
-                headers = curl_slist_append(headers, auth_header);
-                headers = curl_slist_append(headers, "Accept: application/json");
-                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-                printf("🔐 Using Bearer Token
-");
-            }
-            
-            // Get HTTP status code
-            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, NULL);
-            
-            // EXECUTE WITH RECOVERY
-            ctx->recovery_active = 1;
-            res = curl_easy_perform(curl);
-            ctx->recovery_active = 0;
-            
-            // Check HTTP status
-            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_status);
-            
-            curl_slist_free_all(curl_easy_getinfo(curl, CURLINFO_HTTPHEADER, NULL));
-            curl_easy_cleanup(curl);
-            free(chunk.memory);
-            
-            // AUTHENTICATION SUCCESS CHECK
-            if (res == CURLE_OK && http_status == 200 && chunk.size > 0) {
-                cJSON *json = cJSON_Parse(chunk.memory);
-                if (json) {
-                    cJSON *apimodel_json = cJSON_GetObjectItem(json, "apimodel");
-                    cJSON *system_json = cJSON_GetObjectItem(json, "system");
-                    cJSON *osname_json = cJSON_GetObjectItem(json, "osname");
-                    
-                    if (cJSON_IsNumber(apimodel_json)) api_data->apimodel = apimodel_json->valueint;
-                    if (cJSON_IsNumber(system_json)) api_data->system = system_json->valueint;
-                    if (cJSON_IsString(osname_json)) {
-                        strncpy(api_data->osname, osname_json->valuestring, 99);
-                        api_data->osname[99] = '';
-                    }
-                    
-                    cJSON_Delete(json);
-                    printf("✅ AUTH SUCCESS: HTTP %ld
-", http_status);
-                    return API_SUCCESS;
-                }
-            }
-            
-            // SPECIFIC AUTH ERROR HANDLING
-            if (http_status == 401) {
-                fprintf(stderr, "❌ AUTH FAILED: 401 Unauthorized
-");
-                return API_AUTH_ERROR;
-            }
-            
-            ctx->retry_count++;
-            fprintf(stderr, "🔄 Retry %d/%d | HTTP %ld | %s
-", 
-                   ctx->retry_count, ctx->max_retries, http_status, 
-                   curl_easy_strerror(res));
-            
-            sleep(1 << (ctx->retry_count - 1));
-        }
+    unsigned long long hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < srv->body_len; i++) {
+        hash = (hash ^ (unsigned char)srv->body[i]) * 1099511628211ULL;
     }
+    snprintf(srv->etag, sizeof(srv->etag), "\"%016llx\"", hash);
     
-use_backup:
-    fprintf(stderr, "🔄 RECOVERY: Using backup data
-");
-    memcpy(api_data, &ctx->backup_data, sizeof(struct os));
-    return API_RECOVERY_SUCCESS;
+    if (cfg->auth.use_basic_auth) {
+        char credentials[130];
+        snprintf(credentials, sizeof(credentials), "%s:%s", cfg->auth.username, cfg->auth.password);
+        mock_base64(srv->basic_token, sizeof(srv->basic_token), credentials);
+    }
+    
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listen_fd < 0) {
+        free(srv);
+        return NULL;
+    }
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(cfg->port);
+    
+    if (bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(srv->listen_fd, 128) != 0 ||
+        getsockname(srv->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        fprintf(stderr, "MOCK: cannot listen on 127.0.0.1:%u: %s\n", cfg->port, strerror(errno));
+        close(srv->listen_fd);
+        free(srv);
+        return NULL;
+    }
+    fcntl(srv->listen_fd, F_SETFL, fcntl(srv->listen_fd, F_GETFL, 0) | O_NONBLOCK);
+    
+    srv->port = ntohs(addr.sin_port);
+    snprintf(srv->url, sizeof(srv->url), "http://127.0.0.1:%u/api/system-info", srv->port);
+    pthread_mutex_init(&srv->lock, NULL);
+    atomic_store(&srv->running, 1);
+    
+    for (int i = 0; i < srv->config.workers; i++) {
+        if (pthread_create(&srv->threads[i], NULL, mock_worker, srv) != 0) break;
+        srv->thread_count++;
+    }
+    if (srv->thread_count == 0) {
+        stop_mock_server(srv);
+        return NULL;
+    }
+    
+    return srv;
 }
 
-void print_status(struct os *data, int status, struct recovery_ctx *ctx) {
-    printf("
-=== FINAL STATUS ===
-");
-    switch (status) {
-        case API_SUCCESS: printf("✅ FULL SUCCESS
-"); break;
-        case API_AUTH_ERROR: printf("❌ AUTHENTICATION FAILED
-"); break;
-        case API_RECOVERY_SUCCESS: printf("🔄 RECOVERY SUCCESS
-"); break;
-        default: printf("💥 FAILURE: %d
-", status);
-    }
-    printf("Data: Model=%d, System=%d, OS=%s
-", 
-           data->apimodel, data->system, data->osname);
-    printf("==================
-");
+const char *mock_server_url(const struct mock_server *srv) {
+    return srv ? srv->url : NULL;
 }
 
-int main() {
-    struct os api_data, backup_data;
-    struct recovery_ctx ctx;
-    struct auth_config auth;
-    
-    // BACKUP DATA
-    backup_data.apimodel = 1;
-    backup_data.system = 1;
-    strcpy(backup_data.osname, "Lumen");
+unsigned short mock_server_port(const struct mock_server *srv) {
+    return srv ? srv->port : 0;
+}
+
+// Takes effect from the next request
+void set_mock_faults(struct mock_server *srv, const struct mock_faults *faults) {
+    if (!srv || !faults) return;
     
-    // AUTH SETUP - CHOOSE ONE:
-    init_auth_config(&auth, "apiuser", "apipass");           // Basic Auth
-    // set_bearer_token(&auth, "eyJ0eXAiOiJKV1QiLCJhbGciOiJIUzI1NiJ9...");  // Bearer Token
+    pthread_mutex_lock(&srv->lock);
+    srv->faults = *faults;
+    pthread_mutex_unlock(&srv->lock);
+}
+
+void get_mock_stats(struct mock_server *srv, struct mock_stats *out) {
+    if (!srv || !out) return;
     
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    out->connections = atomic_load(&srv->connections);
+    out->requests = atomic_load(&srv->requests);
+    out->ok = atomic_load(&srv->ok);
+    out->not_modified = atomic_load(&srv->not_modified);
+    out->unauthorized = atomic_load(&srv->unauthorized);
+    out->server_errors = atomic_load(&srv->server_errors);
+    out->truncated = atomic_load(&srv->truncated);
+    out->dropped = atomic_load(&srv->dropped);
+    out->not_found = atomic_load(&srv->not_found);
+}
+
+void print_mock_stats(struct mock_server *srv) {
+    struct mock_stats stats;
     
-    init_recovery_ctx(&ctx, &backup_data);
-    init_api_struct(&api_data, &backup_data);
+    if (!srv) return;
     
-    printf("🚀 Starting authenticated API collection...
-");
-    int status = collect_api_data_with_recovery(&api_data, "http://localhost:8080/api/system-info", 
-                                               &ctx, &auth);
+    get_mock_stats(srv, &stats);
+    printf("=== MOCK SERVER %s ===\n", srv->url);
+    printf("Connections: %lu | Requests: %lu\n", stats.connections, stats.requests);
+    printf("200: %lu | 304: %lu | 401: %lu | 5xx: %lu | 404: %lu\n",
+           stats.ok, stats.not_modified, stats.unauthorized, stats.server_errors, stats.not_found);
+    printf("Truncated: %lu | Dropped: %lu\n", stats.truncated, stats.dropped);
+    printf("======================\n");
+}
+
+// Joins the workers; open keep-alive connections are closed within MOCK_POLL_MS
+void stop_mock_server(struct mock_server *srv) {
+    if (!srv) return;
     
-    print_status(&api_data, status, &ctx);
-    curl_global_cleanup();
-    return (status == API_SUCCESS) ? 0 : 1;
+    atomic_store(&srv->running, 0);
+    for (int i = 0; i < srv->thread_count; i++) {
+        pthread_join(srv->threads[i], NULL);
+    }
+    close(srv->listen_fd);
+    pthread_mutex_destroy(&srv->lock);
+    free(srv);
 }
@@ -0,0 +1,39 @@
+/*
+check.h (System API Module tests).
+Assertion helpers shared by the test programs.
+*/
+
+#ifndef SYSTEMAPIMOD_CHECK_H
+#define SYSTEMAPIMOD_CHECK_H
+
+#include <stdio.h>
+
+static int check_count = 0;
+static int check_failures = 0;
+
+#define CHECK(cond) do { \
+    check_count++; \
+    if (!(cond)) { \
+        check_failures++; \
+        fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    long long check_a_ = (long long)(actual); \
+    long long check_e_ = (long long)(expected); \
+    check_count++; \
+    if (check_a_ != check_e_) { \
+        check_failures++; \
+        fprintf(stderr, "%s:%d: CHECK failed: %s == %s (%lld vs %lld)\n", \
+                __FILE__, __LINE__, #actual, #expected, check_a_, check_e_); \
+    } \
+} while (0)
+
+// Summary line for `make test`; returns the process exit code
+static inline int check_report(const char *name) {
+    printf("%s: %d checks, %d failed\n", name, check_count, check_failures);
+    return check_failures ? 1 : 0;
+}
+
+#endif  // SYSTEMAPIMOD_CHECK_H
@@ -0,0 +1,146 @@
+/*
+test_arena.c (System API Module tests).
+Request arena allocation and reuse, and response buffer recycling.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+
+#include "systemapimod.h"
+#include "check.h"
+
+static void test_alloc_and_reset(void) {
+    struct request_arena arena;
+    memset(&arena, 0, sizeof(arena));
+
+    void *a = arena_alloc(&arena, 3);
+    void *b = arena_alloc(&arena, 100);
+    CHECK(a && b);
+    CHECK_EQ((uintptr_t)a % API_ARENA_ALIGN, 0);
+    CHECK_EQ((uintptr_t)b % API_ARENA_ALIGN, 0);
+    CHECK((unsigned char *)b >= (unsigned char *)a + 3);
+    CHECK(arena_owns(&arena, a) && arena_owns(&arena, b));
+    CHECK_EQ(arena.chunk_allocs, 1);
+
+    int on_stack = 0;
+    CHECK(!arena_owns(&arena, &on_stack));
+
+    // Reset rewinds; the same sequence reuses the same memory without new chunks
+    arena_reset(&arena);
+    CHECK_EQ(arena.used, 0);
+    CHECK(arena_alloc(&arena, 3) == a);
+    CHECK(arena_alloc(&arena, 100) == b);
+    CHECK_EQ(arena.chunk_allocs, 1);
+    CHECK_EQ(arena.resets, 1);
+
+    arena_destroy(&arena);
+    CHECK(arena.chunks == NULL);
+}
+
+static void test_extend(void) {
+    struct request_arena arena;
+    memset(&arena, 0, sizeof(arena));
+
+    void *first = arena_alloc(&arena, 64);
+    void *last = arena_alloc(&arena, 64);
+    CHECK_EQ(arena_extend(&arena, last, 64, 512), 0);
+    CHECK_EQ(arena_extend(&arena, first, 64, 128), -1);    // Not the newest allocation
+
+    // The next allocation starts after the extended block
+    unsigned char *next = arena_alloc(&arena, 16);
+    CHECK(next >= (unsigned char *)last + 512);
+
+    arena_destroy(&arena);
+}
+
+static void test_large_allocations(void) {
+    struct request_arena arena;
+    memset(&arena, 0, sizeof(arena));
+
+    // Bigger than one chunk: gets a chunk of its own
+    size_t big = 200 * 1024;
+    unsigned char *p = arena_alloc(&arena, big);
+    CHECK(p != NULL);
+    memset(p, 0xab, big);
+    CHECK(arena_owns(&arena, p + big - 1));
+    unsigned long allocs = arena.chunk_allocs;
+
+    arena_reset(&arena);
+    CHECK(arena_alloc(&arena, big) != NULL);
+    CHECK_EQ(arena.chunk_allocs, allocs);
+
+    arena_destroy(&arena);
+}
+
+static void test_request_scope(void) {
+    struct request_arena *arena = request_arena_enter();
+    unsigned long resets = arena->resets;
+
+    // Nested enter/leave only rewinds at the outermost leave
+    request_arena_enter();
+    struct response_buffer *buf = acquire_response_buffer();
+    CHECK(buf != NULL);
+    CHECK(buf->arena_backed);
+    CHECK(arena_owns(arena, buf) && arena_owns(arena, buf->data));
+    CHECK_EQ(response_buffer_reserve(buf, 100000), 0);
+    CHECK(buf->capacity > 100000);
+    CHECK(arena_owns(arena, buf->data));
+    release_response_buffer(buf);
+    request_arena_leave();
+    CHECK_EQ(arena->resets, resets);
+
+    // Header lists and cJSON trees come from the arena while it is active
+    struct curl_slist *list = arena_slist_append(NULL, "Accept: application/json");
+    list = arena_slist_append(list, "X-Test: 1");
+    CHECK(arena_owns(arena, list) && arena_owns(arena, list->next));
+    CHECK(strcmp(list->next->data, "X-Test: 1") == 0);
+    arena_slist_free(list);
+
+    cJSON *json = cJSON_Parse("{\"osname\":\"Lumen\"}");
+    CHECK(json != NULL && arena_owns(arena, json));
+    cJSON_Delete(json);
+
+    request_arena_leave();
+    CHECK_EQ(arena->resets, resets + 1);
+    CHECK_EQ(arena->used, 0);
+
+    // Outside a request the heap is used again
+    list = arena_slist_append(NULL, "Accept: application/json");
+    CHECK(list != NULL && !arena_owns(arena, list));
+    arena_slist_free(list);
+}
+
+static void test_buffer_free_list(void) {
+    struct response_buffer *a = acquire_response_buffer();
+    CHECK(a != NULL && !a->arena_backed);
+    CHECK(a->capacity > 0 && a->size == 0 && a->data[0] == '\0');
+
+    // Geometric growth keeps room for the NUL
+    CHECK_EQ(response_buffer_reserve(a, 10000), 0);
+    CHECK(a->capacity > 10000);
+    size_t grown = a->capacity;
+    strcpy(a->data, "stale");
+    a->size = 5;
+    strcpy(a->etag, "\"v1\"");
+
+    // Released buffers come back cleared, with their capacity
+    release_response_buffer(a);
+    struct response_buffer *b = acquire_response_buffer();
+    CHECK(b == a);
+    CHECK_EQ(b->capacity, grown);
+    CHECK_EQ(b->size, 0);
+    CHECK(b->data[0] == '\0' && b->etag[0] == '\0');
+
+    release_response_buffer(b);
+    drain_response_buffers();
+}
+
+int main(void) {
+    test_alloc_and_reset();
+    test_extend();
+    test_large_allocations();
+    test_request_scope();
+    test_buffer_free_list();
+    return check_report("test_arena");
+}
@@ -0,0 +1,235 @@
+/*
+test_breaker.c (System API Module tests).
+Circuit breaker transitions and latency bookkeeping in the endpoint registry.
+*/
+
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "check.h"
+
+#define URL "http://127.0.0.1:1/api/system-info"
+#define OPEN_MS 50
+
+static int breaker_state(struct endpoint_registry *reg) {
+    struct endpoint_breaker br;
+    if (get_endpoint_breaker(reg, URL, &br) != API_SUCCESS) return -1;
+    return br.state;
+}
+
+static void test_no_registry(void) {
+    CHECK_EQ(endpoint_allow_request(NULL, URL), 1);
+}
+
+static void test_opens_at_threshold(void) {
+    struct endpoint_registry reg;
+    struct endpoint_breaker br;
+
+    init_endpoint_registry(&reg);
+    configure_endpoint_breaker(&reg, 3, OPEN_MS);
+
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+    record_endpoint_outcome(&reg, URL, 0);
+    record_endpoint_outcome(&reg, URL, 0);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_CLOSED);
+
+    // A success in between resets the run
+    record_endpoint_outcome(&reg, URL, 1);
+    record_endpoint_outcome(&reg, URL, 0);
+    record_endpoint_outcome(&reg, URL, 0);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_CLOSED);
+
+    record_endpoint_outcome(&reg, URL, 0);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_OPEN);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+
+    get_endpoint_breaker(&reg, URL, &br);
+    CHECK_EQ(br.opens, 1);
+    CHECK_EQ(br.rejected, 2);
+}
+
+static void test_half_open_probe(void) {
+    struct endpoint_registry reg;
+    struct endpoint_breaker br;
+
+    init_endpoint_registry(&reg);
+    configure_endpoint_breaker(&reg, 1, OPEN_MS);
+    record_endpoint_outcome(&reg, URL, 0);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_OPEN);
+
+    // After the cool-down exactly one trial goes out
+    usleep((OPEN_MS + 20) * 1000);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_HALF_OPEN);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+
+    // Failed trial: straight back to open
+    record_endpoint_outcome(&reg, URL, 0);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_OPEN);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+
+    // Successful trial closes it
+    usleep((OPEN_MS + 20) * 1000);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+    record_endpoint_outcome(&reg, URL, 1);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_CLOSED);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+
+    get_endpoint_breaker(&reg, URL, &br);
+    CHECK_EQ(br.opens, 2);
+    CHECK_EQ(br.half_opens, 2);
+    CHECK_EQ(br.closes, 1);
+}
+
+static void test_abandoned_probe_expires(void) {
+    struct endpoint_registry reg;
+
+    init_endpoint_registry(&reg);
+    configure_endpoint_breaker(&reg, 1, OPEN_MS);
+    record_endpoint_outcome(&reg, URL, 0);
+    usleep((OPEN_MS + 20) * 1000);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+
+    // The trial never reports back: the slot frees up after another cool-down
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+    usleep((OPEN_MS + 20) * 1000);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+}
+
+static void test_cancelled_probe_frees_slot(void) {
+    struct endpoint_registry reg;
+    struct endpoint_breaker br;
+
+    init_endpoint_registry(&reg);
+    configure_endpoint_breaker(&reg, 1, OPEN_MS);
+    record_endpoint_outcome(&reg, URL, 0);
+    usleep((OPEN_MS + 20) * 1000);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+    get_endpoint_breaker(&reg, URL, &br);
+    long long probe_us = br.probe_started_us;
+
+    // A request that went out before the trial was handed out does not hold it
+    endpoint_cancel_request(&reg, URL, probe_us - 1);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+
+    // The trial itself lost a race: the next request probes without waiting
+    endpoint_cancel_request(&reg, URL, probe_us);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_HALF_OPEN);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 0);
+    record_endpoint_outcome(&reg, URL, 1);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_CLOSED);
+
+    // Closed breakers ignore cancellations
+    endpoint_cancel_request(&reg, URL, probe_us);
+    CHECK_EQ(breaker_state(&reg), API_BREAKER_CLOSED);
+    CHECK_EQ(endpoint_allow_request(&reg, URL), 1);
+}
+
+static void test_cancelled_latency_is_a_lower_bound(void) {
+    struct endpoint_registry reg;
+    struct latency_snapshot before, after;
+
+    init_endpoint_registry(&reg);
+    record_endpoint_cancelled(&reg, URL, 500);
+    CHECK_EQ(get_endpoint_latency_stats(&reg, URL, &before), API_STRUCT_INIT_ERROR);
+    for (int i = 0; i < 16; i++) record_endpoint_latency(&reg, URL, 1000);
+    get_endpoint_latency_stats(&reg, URL, &before);
+
+    // Hedges cancelled right away never pull the estimates down
+    for (int i = 0; i < 50; i++) record_endpoint_cancelled(&reg, URL, 10);
+    get_endpoint_latency_stats(&reg, URL, &after);
+    CHECK_EQ(after.samples, before.samples);
+    CHECK_EQ(after.p95_us, before.p95_us);
+    CHECK_EQ(after.tail_us, before.tail_us);
+    CHECK(after.ewma_latency_us == before.ewma_latency_us);
+
+    // Slow losers raise the tail and the p95, but not the ranking EWMA
+    for (int i = 0; i < 3; i++) record_endpoint_cancelled(&reg, URL, 50000);
+    get_endpoint_latency_stats(&reg, URL, &after);
+    CHECK(after.tail_us > before.tail_us);
+    CHECK_EQ(after.p95_us, 50000);
+    CHECK_EQ(endpoint_p95_us(&reg, URL), 50000);
+    CHECK(after.ewma_latency_us == before.ewma_latency_us);
+}
+
+// A 401 is an answer from the endpoint: no collector holds bad credentials
+// against it, and a 401 to the half-open trial settles the breaker
+static void test_unauthorized_counts_as_answer(void) {
+    struct mock_server_config cfg;
+    struct endpoint_registry reg;
+    struct endpoint_breaker br;
+    struct recovery_ctx ctx;
+    struct auth_config wrong;
+    struct os backup, data;
+    struct retry_wheel wheel;
+    struct collect_job job;
+
+    init_mock_server_config(&cfg);
+    cfg.port = 0;
+    init_auth_config(&cfg.auth, "apiuser", "apipass");
+    struct mock_server *srv = start_mock_server(&cfg);
+    CHECK(srv != NULL);
+    if (!srv) return;
+    const char *url = mock_server_url(srv);
+
+    memset(&backup, 0, sizeof(backup));
+    init_auth_config(&wrong, "apiuser", "wrong");
+    init_endpoint_registry(&reg);
+    configure_endpoint_breaker(&reg, 1, OPEN_MS);
+    set_registry_endpoints(&reg, &url, 1);
+    init_recovery_ctx(&ctx, &backup);
+    ctx.endpoints = &reg;
+
+    record_endpoint_outcome(&reg, url, 0);
+    usleep((OPEN_MS + 20) * 1000);
+    CHECK_EQ(collect_api_data_with_recovery(&data, url, &ctx, &wrong), API_AUTH_ERROR);
+    get_endpoint_breaker(&reg, url, &br);
+    CHECK_EQ(br.state, API_BREAKER_CLOSED);
+
+    CHECK_EQ(collect_api_data_concurrent(&data, &ctx, &wrong), API_AUTH_ERROR);
+    CHECK_EQ(collect_api_data_hedged(&data, &ctx, &wrong), API_AUTH_ERROR);
+    init_retry_wheel(&wheel);
+    submit_collect_job(&wheel, &job, &data, &ctx, &wrong, NULL);
+    while (!job.done) retry_wheel_poll(&wheel, 50);
+    CHECK_EQ(job.status, API_AUTH_ERROR);
+    destroy_retry_wheel(&wheel);
+
+    get_endpoint_breaker(&reg, url, &br);
+    CHECK_EQ(br.state, API_BREAKER_CLOSED);
+    CHECK_EQ(br.opens, 1);
+    CHECK_EQ(br.consecutive_failures, 0);
+    stop_mock_server(srv);
+}
+
+static void test_open_breaker_sorts_last(void) {
+    struct endpoint_registry reg;
+    const char *urls[] = { URL, "http://127.0.0.1:2/api/system-info" };
+    struct endpoint_plan plan;
+
+    init_endpoint_registry(&reg);
+    configure_endpoint_breaker(&reg, 1, 60000);
+    set_registry_endpoints(&reg, urls, 2);
+    record_endpoint_latency(&reg, urls[1], 50000);
+    record_endpoint_outcome(&reg, urls[1], 1);
+    record_endpoint_latency(&reg, URL, 100);
+    record_endpoint_outcome(&reg, URL, 1);
+    record_endpoint_outcome(&reg, URL, 0);
+
+    CHECK_EQ(plan_endpoints(&reg, NULL, &plan), 2);
+    CHECK(strcmp(plan.urls[0], urls[1]) == 0);
+}
+
+int main(void) {
+    test_no_registry();
+    test_opens_at_threshold();
+    test_half_open_probe();
+    test_abandoned_probe_expires();
+    test_cancelled_probe_frees_slot();
+    test_cancelled_latency_is_a_lower_bound();
+    test_unauthorized_counts_as_answer();
+    test_open_breaker_sorts_last();
+    return check_report("test_breaker");
+}
@@ -0,0 +1,128 @@
+/*
+test_cache.c (System API Module tests).
+The response cache against the in-process mock server: TTL hits, ETag
+revalidation answered with 304, and one entry per set of credentials.
+*/
+
+#include <string.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "check.h"
+
+#define TTL_MS 100
+
+static void test_identity_hash(void) {
+    struct auth_config none, basic, other_pass, split, bearer, both;
+
+    memset(&none, 0, sizeof(none));
+    CHECK_EQ(auth_identity_hash(NULL), 0);
+    CHECK_EQ(auth_identity_hash(&none), 0);
+
+    init_auth_config(&basic, "apiuser", "apipass");
+    init_auth_config(&other_pass, "apiuser", "other");
+    init_auth_config(&split, "apiuse", "rapipass");     // Same bytes, other split
+    CHECK(auth_identity_hash(&basic) != 0);
+    CHECK_EQ(auth_identity_hash(&basic), auth_identity_hash(&basic));
+    CHECK(auth_identity_hash(&basic) != auth_identity_hash(&other_pass));
+    CHECK(auth_identity_hash(&basic) != auth_identity_hash(&split));
+
+    // A token only counts when it is sent, and both schemes go into the key
+    memset(&bearer, 0, sizeof(bearer));
+    set_bearer_token(&bearer, "token");
+    memcpy(&both, &basic, sizeof(both));
+    strcpy(both.bearer_token, "token");
+    both.use_bearer_auth = 1;
+    CHECK(auth_identity_hash(&bearer) != 0);
+    CHECK(auth_identity_hash(&both) != auth_identity_hash(&basic));
+    CHECK(auth_identity_hash(&both) != auth_identity_hash(&bearer));
+    bearer.use_bearer_auth = 0;
+    CHECK_EQ(auth_identity_hash(&bearer), 0);
+}
+
+static void test_ttl_and_revalidation(struct mock_server *srv) {
+    struct response_cache cache;
+    struct mock_stats before, after;
+    struct os data;
+    const char *url = mock_server_url(srv);
+
+    init_response_cache(&cache, TTL_MS);
+    get_mock_stats(srv, &before);
+
+    // Miss, then a hit inside the TTL that never reaches the server
+    memset(&data, 0, sizeof(data));
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK(strcmp(data.osname, "Lumen OS") == 0);
+    memset(&data, 0, sizeof(data));
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK(strcmp(data.osname, "Lumen OS") == 0);
+    get_mock_stats(srv, &after);
+    CHECK_EQ(after.requests - before.requests, 1);
+    CHECK_EQ(cache.hits, 1);
+    CHECK_EQ(cache.misses, 1);
+    CHECK_EQ(cache.refreshes, 1);
+
+    // Expired: a conditional request, answered 304, served without a parse
+    usleep((TTL_MS + 50) * 1000);
+    memset(&data, 0, sizeof(data));
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK(strcmp(data.osname, "Lumen OS") == 0);
+    CHECK_EQ(data.apimodel, 1);
+    get_mock_stats(srv, &after);
+    CHECK_EQ(after.not_modified - before.not_modified, 1);
+    CHECK_EQ(cache.revalidations, 1);
+    CHECK_EQ(cache.not_modified, 1);
+    CHECK_EQ(cache.refreshes, 1);
+
+    // The 304 renewed the TTL
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK_EQ(cache.hits, 2);
+
+    // Invalidation forgets the validators too: a full refresh follows
+    invalidate_response_cache(&cache);
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK_EQ(cache.refreshes, 2);
+    CHECK_EQ(cache.revalidations, 1);
+}
+
+static void test_entries_per_identity(struct mock_server *srv) {
+    struct response_cache cache;
+    struct auth_config alice, bob;
+    struct mock_stats before, after;
+    struct os data;
+    const char *url = mock_server_url(srv);
+
+    init_response_cache(&cache, 60000);
+    init_auth_config(&alice, "alice", "secret");
+    init_auth_config(&bob, "bob", "secret");
+    get_mock_stats(srv, &before);
+
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, &alice), API_SUCCESS);
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, &bob), API_SUCCESS);
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK_EQ(cache.misses, 3);
+
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, &alice), API_SUCCESS);
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, &bob), API_SUCCESS);
+    CHECK_EQ(collect_api_data_cached(&cache, &data, url, NULL), API_SUCCESS);
+    CHECK_EQ(cache.hits, 3);
+    get_mock_stats(srv, &after);
+    CHECK_EQ(after.requests - before.requests, 3);
+}
+
+int main(void) {
+    struct mock_server_config cfg;
+
+    test_identity_hash();
+
+    init_mock_server_config(&cfg);
+    cfg.port = 0;
+    struct mock_server *srv = start_mock_server(&cfg);
+    CHECK(srv != NULL);
+    if (srv) {
+        test_ttl_and_revalidation(srv);
+        test_entries_per_identity(srv);
+        stop_mock_server(srv);
+    }
+    return check_report("test_cache");
+}
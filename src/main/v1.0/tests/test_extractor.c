@@ -0,0 +1,176 @@
+/*
+test_extractor.c (System API Module tests).
+The streaming extractor and the SIMD scanner against cJSON: whenever a fast
+path accepts a body, cJSON must accept it too and yield the same fields.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+
+#include "systemapimod.h"
+#include "check.h"
+
+#define FAST_ANY (-1)     // Either answer is fine, cJSON decides on MALFORMED
+#define FAST_REJECT 0     // Must hand the body to cJSON
+#define FAST_ACCEPT 1     // Must be decided by the fast path
+
+struct parse_case {
+    const char *body;
+    int fast;
+    int valid;            // cJSON_Parse succeeds
+    unsigned int found;   // Fields cJSON_GetObjectItem yields with the right type
+    int apimodel;
+    int system;
+    const char *osname;
+};
+
+static const struct parse_case cases[] = {
+    { "{\"apimodel\":1,\"system\":2,\"osname\":\"Lumen\"}", FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 1, 2, "Lumen" },
+    { " {\n\t\"osname\" : \"Lumen OS\" ,\r\n \"system\" : -7 , \"apimodel\" : 3.9 }\n", FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 3, -7, "Lumen OS" },
+    { "{\"APIModel\":4,\"SYSTEM\":5,\"OsName\":\"caps\"}", FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 4, 5, "caps" },
+    { "{\"apimodel\":1e3,\"system\":1E-2,\"osname\":\"exp\"}", FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 1000, 0, "exp" },
+    { "{\"apimodel\":1,\"apimodel\":2,\"system\":3,\"osname\":\"first\",\"osname\":\"second\"}",
+      FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 1, 3, "first" },
+    { "{\"osname\":\"esc \\\"q\\\" \\\\ \\/ \\t\",\"apimodel\":1,\"system\":1}", FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 1, 1, "esc \"q\" \\ / \t" },
+    { "{\"meta\":{\"apimodel\":9,\"osname\":\"nested\"},\"list\":[1,true,null,\"x\",{}],\"apimodel\":2,\"system\":3,\"osname\":\"top\"}",
+      FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 2, 3, "top" },
+    { "{\"apimodel\":\"7\",\"system\":false,\"osname\":12}", FAST_ACCEPT, 1, 0, 0, 0, "" },
+    { "{\"system\":2}", FAST_ACCEPT, 1, SYSINFO_FIELD_SYSTEM, 0, 2, "" },
+    { "{}", FAST_ACCEPT, 1, 0, 0, 0, "" },
+    { "{\"apimodel\":1,\"system\":2,\"osname\":\"x\"}  trailing bytes after the document", FAST_ANY, 1, SYSINFO_FIELD_ALL, 1, 2, "x" },
+    { "{\"apimodel\":1,\"sys", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"apimodel\":1,\"system\":2]", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"apimodel\":1,,\"system\":2}", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"apimodel\":01x,\"system\":2,\"osname\":\"x\"}", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"meta\":[1,tru],\"apimodel\":1,\"system\":2,\"osname\":\"x\"}", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"meta\":\"bad \\q escape\",\"apimodel\":1,\"system\":2,\"osname\":\"x\"}", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"meta\":{\"a\" 1},\"apimodel\":1,\"system\":2,\"osname\":\"x\"}", FAST_REJECT, 0, 0, 0, 0, "" },
+    // Every field is in before the body goes wrong: still the cJSON verdict
+    { "{\"apimodel\":1,\"system\":2,\"osname\":\"x\",<garbage>", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"apimodel\":1,\"system\":2,\"osname\":\"x\",\"meta\":[1,2", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"apimodel\":1,\"system\":2,\"osname\":\"x\"", FAST_REJECT, 0, 0, 0, 0, "" },
+    { "{\"apimodel\":1,\"system\":2,\"osname\":\"x\",\"apimodel\":9,\"OSNAME\":\"late\"}",
+      FAST_ACCEPT, 1, SYSINFO_FIELD_ALL, 1, 2, "x" },
+    { "{\"list\":[1,],\"apimodel\":1,\"system\":2,\"osname\":\"x\"}", FAST_REJECT, 0, 0, 0, 0, "" },
+};
+#define CASE_COUNT ((int)(sizeof(cases) / sizeof(cases[0])))
+
+// What collect_api_data's slow path yields
+static int cjson_decode(const char *body, struct os *out, unsigned int *found) {
+    cJSON *json = cJSON_Parse(body);
+    *found = 0;
+    memset(out, 0, sizeof(struct os));
+    if (!json) return 0;
+
+    cJSON *apimodel = cJSON_GetObjectItem(json, "apimodel");
+    cJSON *system = cJSON_GetObjectItem(json, "system");
+    cJSON *osname = cJSON_GetObjectItem(json, "osname");
+    if (cJSON_IsNumber(apimodel)) {
+        out->apimodel = apimodel->valueint;
+        *found |= SYSINFO_FIELD_APIMODEL;
+    }
+    if (cJSON_IsNumber(system)) {
+        out->system = system->valueint;
+        *found |= SYSINFO_FIELD_SYSTEM;
+    }
+    if (cJSON_IsString(osname)) {
+        strncpy(out->osname, osname->valuestring, sizeof(out->osname) - 1);
+        *found |= SYSINFO_FIELD_OSNAME;
+    }
+    cJSON_Delete(json);
+    return 1;
+}
+
+static void check_fields(const struct parse_case *c, const struct os *got, unsigned int found) {
+    CHECK_EQ(found, c->found);
+    if (found & SYSINFO_FIELD_APIMODEL) CHECK_EQ(got->apimodel, c->apimodel);
+    if (found & SYSINFO_FIELD_SYSTEM) CHECK_EQ(got->system, c->system);
+    if (found & SYSINFO_FIELD_OSNAME) CHECK(strcmp(got->osname, c->osname) == 0);
+}
+
+static void check_fast_result(const struct parse_case *c, int result, const struct os *got, unsigned int found) {
+    if (c->fast == FAST_ACCEPT) CHECK_EQ(result, SYSINFO_SCAN_COMPLETE);
+    if (c->fast == FAST_REJECT) CHECK_EQ(result, SYSINFO_SCAN_MALFORMED);
+    if (result == SYSINFO_SCAN_COMPLETE) {
+        CHECK(c->valid);
+        check_fields(c, got, found);
+    }
+}
+
+static void test_cjson_expectations(void) {
+    for (int i = 0; i < CASE_COUNT; i++) {
+        struct os got;
+        unsigned int found;
+        CHECK_EQ(cjson_decode(cases[i].body, &got, &found), cases[i].valid);
+        if (cases[i].valid) check_fields(&cases[i], &got, found);
+    }
+}
+
+// Feed in slices of `step` bytes to cross every chunk boundary
+static void test_extractor(size_t step) {
+    for (int i = 0; i < CASE_COUNT; i++) {
+        struct sysinfo_extractor ex;
+        struct os got;
+        size_t len = strlen(cases[i].body);
+
+        memset(&got, 0, sizeof(got));
+        sysinfo_extractor_init(&ex, &got, SYSINFO_FIELD_ALL);
+        for (size_t off = 0; off < len; off += step) {
+            size_t n = (len - off < step) ? len - off : step;
+            if (sysinfo_extractor_feed(&ex, cases[i].body + off, n) != SYSINFO_SCAN_MORE) break;
+        }
+        int result = sysinfo_extractor_finish(&ex);
+        check_fast_result(&cases[i], result, &got, ex.found);
+    }
+}
+
+static void test_scanner(void) {
+    for (int i = 0; i < CASE_COUNT; i++) {
+        struct os got;
+        unsigned int found = 0;
+        memset(&got, 0, sizeof(got));
+        int result = sysinfo_scan_buffer(cases[i].body, strlen(cases[i].body), &got, &found);
+        check_fast_result(&cases[i], result, &got, found);
+    }
+}
+
+// Large payload as the bulk path sees it: fields spread over padding
+static void test_scanner_large(void) {
+    size_t pad = 100 * 1024;
+    char *body = malloc(pad + 256);
+    struct os got;
+    unsigned int found = 0;
+
+    CHECK(body != NULL);
+    if (!body) return;
+
+    size_t n = (size_t)sprintf(body, "{\"apimodel\":11,\"blob\":\"");
+    memset(body + n, 'a', pad);
+    n += pad;
+    n += (size_t)sprintf(body + n, "\",\"system\":12,\"osname\":\"big\"}");
+
+    memset(&got, 0, sizeof(got));
+    CHECK_EQ(sysinfo_scan_buffer(body, n, &got, &found), SYSINFO_SCAN_COMPLETE);
+    CHECK_EQ(found, SYSINFO_FIELD_ALL);
+    CHECK_EQ(got.apimodel, 11);
+    CHECK_EQ(got.system, 12);
+    CHECK(strcmp(got.osname, "big") == 0);
+
+    // Cut inside the padding: never accepted
+    found = 0;
+    body[n / 2] = '\0';
+    CHECK_EQ(sysinfo_scan_buffer(body, n / 2, &got, &found), SYSINFO_SCAN_MALFORMED);
+    free(body);
+}
+
+int main(void) {
+    test_cjson_expectations();
+    test_extractor(1);
+    test_extractor(7);
+    test_extractor(4096);
+    test_scanner();
+    test_scanner_large();
+    return check_report("test_extractor");
+}
@@ -0,0 +1,106 @@
+/*
+test_histogram.c (System API Module tests).
+Slot math, percentiles and merging of the HDR-style latency histogram.
+*/
+
+#include <string.h>
+
+#include "systemapimod.h"
+#include "check.h"
+
+// Top of the slot v lands in: record v plus one far larger value and ask for
+// the lower half, so the answer is not clamped to max_us
+static long long slot_top(long long v) {
+    static struct latency_histogram h;
+    init_latency_histogram(&h);
+    latency_histogram_record(&h, v);
+    latency_histogram_record(&h, API_HIST_MAX_US);
+    return latency_histogram_percentile(&h, 50.0);
+}
+
+static void test_slot_precision(void) {
+    // Exact below 2^SUB_BITS
+    for (long long v = 0; v < (1LL << API_HIST_SUB_BITS); v++) {
+        CHECK_EQ(slot_top(v), v);
+    }
+
+    // Above: the reported top is >= v and within 1/128 of it, and never decreases
+    long long prev_top = 0;
+    for (int bit = API_HIST_SUB_BITS; bit < 32; bit++) {
+        long long base = 1LL << bit;
+        long long probes[] = { base - 1, base, base + 1, base + base / 3, 2 * base - 1 };
+        for (int i = 0; i < 5; i++) {
+            long long v = probes[i];
+            long long top = slot_top(v);
+            CHECK(top >= v);
+            CHECK(top - v <= v / 128);
+            CHECK(top >= prev_top);
+            prev_top = top;
+        }
+    }
+
+    CHECK_EQ(slot_top(API_HIST_MAX_US), API_HIST_MAX_US);
+}
+
+static void test_clamping(void) {
+    struct latency_histogram h;
+
+    init_latency_histogram(&h);
+    latency_histogram_record(&h, -5);
+    latency_histogram_record(&h, API_HIST_MAX_US * 4);
+    CHECK_EQ(h.total, 2);
+    CHECK_EQ(h.min_us, 0);
+    CHECK_EQ(h.max_us, API_HIST_MAX_US);
+    CHECK_EQ(latency_histogram_percentile(&h, 100.0), API_HIST_MAX_US);
+}
+
+static void test_percentiles(void) {
+    struct latency_histogram h;
+
+    init_latency_histogram(&h);
+    CHECK_EQ(latency_histogram_percentile(&h, 50.0), 0);
+    CHECK(latency_histogram_mean(&h) == 0.0);
+
+    for (long long v = 1; v <= 1000; v++) latency_histogram_record(&h, v);
+
+    long long p50 = latency_histogram_percentile(&h, 50.0);
+    long long p99 = latency_histogram_percentile(&h, 99.0);
+    CHECK(p50 >= 500 && p50 <= 500 + 500 / 128);
+    CHECK(p99 >= 990 && p99 <= 990 + 990 / 128);
+    CHECK_EQ(latency_histogram_percentile(&h, 0.0), 1);
+    CHECK_EQ(latency_histogram_percentile(&h, 100.0), 1000);
+    CHECK(latency_histogram_mean(&h) == 500.5);
+}
+
+static void test_merge(void) {
+    struct latency_histogram a, b, whole;
+
+    init_latency_histogram(&a);
+    init_latency_histogram(&b);
+    init_latency_histogram(&whole);
+    for (long long v = 0; v < 5000; v += 7) {
+        latency_histogram_record((v % 2) ? &a : &b, v * 13);
+        latency_histogram_record(&whole, v * 13);
+    }
+
+    latency_histogram_merge(&a, &b);
+    CHECK_EQ(a.total, whole.total);
+    CHECK_EQ(a.min_us, whole.min_us);
+    CHECK_EQ(a.max_us, whole.max_us);
+    CHECK(memcmp(a.counts, whole.counts, sizeof(a.counts)) == 0);
+    CHECK_EQ(latency_histogram_percentile(&a, 90.0), latency_histogram_percentile(&whole, 90.0));
+
+    // Merging an empty histogram changes nothing
+    init_latency_histogram(&b);
+    latency_histogram_merge(&a, &b);
+    CHECK_EQ(a.total, whole.total);
+    CHECK_EQ(a.min_us, whole.min_us);
+}
+
+int main(void) {
+    test_slot_precision();
+    test_clamping();
+    test_percentiles();
+    test_merge();
+    return check_report("test_histogram");
+}
@@ -0,0 +1,219 @@
+/*
+test_retry.c (System API Module tests).
+The retry timer wheel, decorrelated jitter bounds and the retry budget.
+*/
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "systemapimod.h"
+#include "check.h"
+
+struct fired {
+    char order[8];
+    int count;
+};
+
+struct tagged {
+    struct fired *log;
+    char tag;
+    long long scheduled_us;
+    long delay_ms;
+    long early;                 // Fired before its delay (less one tick of rounding)
+};
+
+static long long now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static void record_fire(void *arg) {
+    struct tagged *t = arg;
+    long elapsed_ms = (long)((now_us() - t->scheduled_us) / 1000);
+
+    if (elapsed_ms < t->delay_ms - RETRY_WHEEL_TICK_MS) t->early = elapsed_ms;
+    if (t->log->count < (int)sizeof(t->log->order) - 1) {
+        t->log->order[t->log->count] = t->tag;
+    }
+    t->log->count++;
+}
+
+static int schedule_tagged(struct retry_wheel *wheel, struct retry_timer *timer,
+                           struct tagged *t, long delay_ms) {
+    t->scheduled_us = now_us();
+    t->delay_ms = delay_ms;
+    t->early = -1;
+    return retry_wheel_schedule(wheel, timer, delay_ms, record_fire, t);
+}
+
+static void test_wheel_order(void) {
+    struct retry_wheel wheel;
+    struct retry_timer ta, tb, tc;
+    struct fired log;
+    struct tagged a = { &log, 'a', 0, 0, -1 };
+    struct tagged b = { &log, 'b', 0, 0, -1 };
+    struct tagged c = { &log, 'c', 0, 0, -1 };
+
+    memset(&log, 0, sizeof(log));
+    memset(&ta, 0, sizeof(ta));
+    memset(&tb, 0, sizeof(tb));
+    memset(&tc, 0, sizeof(tc));
+    CHECK_EQ(init_retry_wheel(&wheel), API_SUCCESS);
+    CHECK_EQ(retry_wheel_next_delay_ms(&wheel), -1);
+
+    CHECK_EQ(schedule_tagged(&wheel, &ta, &a, 120), API_SUCCESS);
+    CHECK_EQ(schedule_tagged(&wheel, &tb, &b, 40), API_SUCCESS);
+    CHECK_EQ(schedule_tagged(&wheel, &tc, &c, 0), API_SUCCESS);     // Rounds up to one tick
+    CHECK_EQ(wheel.pending, 3);
+    CHECK(ta.armed && tb.armed && tc.armed);
+
+    // An armed timer cannot be scheduled twice
+    CHECK_EQ(retry_wheel_schedule(&wheel, &ta, 10, record_fire, &a), API_STRUCT_INIT_ERROR);
+    CHECK_EQ(wheel.pending, 3);
+
+    long next = retry_wheel_next_delay_ms(&wheel);
+    CHECK(next >= 0 && next <= RETRY_WHEEL_TICK_MS);
+
+    while (wheel.pending > 0 && log.count < 3) {
+        retry_wheel_poll(&wheel, 50);
+    }
+    CHECK_EQ(log.count, 3);
+    CHECK(strcmp(log.order, "cba") == 0);
+    CHECK_EQ(wheel.pending, 0);
+    CHECK(!ta.armed && !tb.armed && !tc.armed);
+    CHECK_EQ(a.early, -1);
+    CHECK_EQ(b.early, -1);
+    CHECK_EQ(retry_wheel_next_delay_ms(&wheel), -1);
+    CHECK_EQ(retry_wheel_advance(&wheel), 0);
+
+    destroy_retry_wheel(&wheel);
+}
+
+struct rearm {
+    struct retry_wheel *wheel;
+    struct retry_timer timer;
+    int fired;
+    int limit;
+};
+
+static void rearm_fire(void *arg) {
+    struct rearm *r = arg;
+
+    if (++r->fired < r->limit) {
+        retry_wheel_schedule(r->wheel, &r->timer, RETRY_WHEEL_TICK_MS, rearm_fire, r);
+    }
+}
+
+static void test_wheel_rearm_and_laps(void) {
+    struct retry_wheel wheel;
+    struct retry_timer far, near;
+    struct fired log;
+    struct tagged f = { &log, 'f', 0, 0, -1 };
+    struct tagged n = { &log, 'n', 0, 0, -1 };
+    struct rearm r;
+
+    CHECK_EQ(init_retry_wheel(&wheel), API_SUCCESS);
+
+    // A callback may re-arm its own timer
+    memset(&r, 0, sizeof(r));
+    r.wheel = &wheel;
+    r.limit = 3;
+    CHECK_EQ(retry_wheel_schedule(&wheel, &r.timer, 0, rearm_fire, &r), API_SUCCESS);
+    while (wheel.pending > 0) {
+        retry_wheel_poll(&wheel, 50);
+    }
+    CHECK_EQ(r.fired, 3);
+    CHECK(!r.timer.armed);
+
+    // A timer more than one revolution out waits for its lap; a near one fires first
+    memset(&log, 0, sizeof(log));
+    memset(&far, 0, sizeof(far));
+    memset(&near, 0, sizeof(near));
+    CHECK_EQ(schedule_tagged(&wheel, &far, &f, RETRY_WHEEL_SLOTS * RETRY_WHEEL_TICK_MS + 20), API_SUCCESS);
+    CHECK_EQ(schedule_tagged(&wheel, &near, &n, 20), API_SUCCESS);
+    while (near.armed) {
+        retry_wheel_poll(&wheel, 50);
+    }
+    CHECK_EQ(log.count, 1);
+    CHECK_EQ(log.order[0], 'n');
+    CHECK(far.armed);
+    CHECK_EQ(wheel.pending, 1);
+    CHECK(retry_wheel_next_delay_ms(&wheel) > (RETRY_WHEEL_SLOTS - 2) * RETRY_WHEEL_TICK_MS);
+
+    destroy_retry_wheel(&wheel);
+}
+
+static void test_backoff_bounds(void) {
+    struct retry_backoff backoff;
+    int out_of_range = 0, hit_cap = 0, distinct = 0;
+    long first = -1;
+
+    init_retry_backoff(&backoff, API_RETRY_BASE_MS, API_RETRY_CAP_MS);
+    backoff.seed = 1;       // Deterministic sequence
+    CHECK_EQ(backoff.prev_ms, API_RETRY_BASE_MS);
+
+    for (int i = 0; i < 1000; i++) {
+        long prev = backoff.prev_ms;
+        long upper = (prev * 3 > API_RETRY_BASE_MS) ? prev * 3 : API_RETRY_BASE_MS + 1;
+        long d = retry_backoff_next(&backoff);
+
+        if (d < API_RETRY_BASE_MS || d > API_RETRY_CAP_MS || d >= upper) out_of_range++;
+        if (backoff.prev_ms != d) out_of_range++;
+        if (d == API_RETRY_CAP_MS) hit_cap = 1;
+        if (first < 0) first = d;
+        else if (d != first) distinct = 1;
+    }
+    CHECK_EQ(out_of_range, 0);
+    CHECK(hit_cap);
+    CHECK(distinct);
+
+    // The first delay grows at most threefold from base
+    init_retry_backoff(&backoff, 50, 10000);
+    long d = retry_backoff_next(&backoff);
+    CHECK(d >= 50 && d < 150);
+
+    // base == cap degenerates to a fixed delay
+    init_retry_backoff(&backoff, 200, 200);
+    for (int i = 0; i < 10; i++) {
+        CHECK_EQ(retry_backoff_next(&backoff), 200);
+    }
+}
+
+static void test_budget(void) {
+    // No time-based floor, so only deposits refill the bucket
+    configure_retry_budget(0.5, 0.0, 2.0);
+
+    CHECK_EQ(retry_budget_try_spend(), 1);
+    CHECK_EQ(retry_budget_try_spend(), 1);
+    CHECK_EQ(retry_budget_try_spend(), 0);
+
+    // Two first attempts at ratio 0.5 buy one retry
+    retry_budget_on_request();
+    CHECK_EQ(retry_budget_try_spend(), 0);
+    retry_budget_on_request();
+    CHECK_EQ(retry_budget_try_spend(), 1);
+    CHECK_EQ(retry_budget_try_spend(), 0);
+
+    // Deposits stop at max_tokens
+    for (int i = 0; i < 20; i++) {
+        retry_budget_on_request();
+    }
+    CHECK_EQ(retry_budget_try_spend(), 1);
+    CHECK_EQ(retry_budget_try_spend(), 1);
+    CHECK_EQ(retry_budget_try_spend(), 0);
+
+    // The per-second floor refills a quiet process
+    configure_retry_budget(0.0, 100.0, 2.0);
+    usleep(30 * 1000);
+    CHECK_EQ(retry_budget_try_spend(), 1);
+}
+
+int main(void) {
+    test_wheel_order();
+    test_wheel_rearm_and_laps();
+    test_backoff_bounds();
+    test_budget();
+    return check_report("test_retry");
+}